@@ -0,0 +1,335 @@
+using System.Diagnostics.CodeAnalysis;
+using System.Net.Sockets;
+using System.Runtime.InteropServices;
+using System.Text;
+using Moth.AST;
+using Spectre.Console;
+
+namespace Moth.Compiler;
+
+// A resident mothc that builds on behalf of other processes over a Unix socket, so that the
+// runtime, the LLVM targets, the attribute registry and the caches of loaded libraries and parsed
+// files stay warm between builds. Requests are handled one at a time, since a build changes the
+// working directory and console of the whole process.
+//
+// A request starts with the identity of the client's compiler, which the server answers with
+// whether it is the same build, as a server left running from older code would build differently.
+// It is followed by the client's working directory and the mothc arguments. The reply is the
+// build's console output in chunks, each prefixed with true, then false and the exit code.
+//
+// The default socket is kept in a directory only the user can access, and on Linux both ends also
+// check that the other runs as the same user, so no one else can receive or send builds.
+public static class CompileServer
+{
+    private const int SolSocket = 1;
+    private const int SoPeerCred = 17;
+
+    private const UnixFileMode PrivateMode =
+        UnixFileMode.UserRead | UnixFileMode.UserWrite | UnixFileMode.UserExecute;
+
+    public static string DefaultSocketPath
+    {
+        get { return Path.Combine(SocketDirectory, $"mothc-{Meta.Version}.sock"); }
+    }
+
+    // Identifies this exact build of the compiler, as its version is not bumped for every change.
+    public static string Identity
+    {
+        get
+        {
+            return $"{typeof(Meta).Assembly.ManifestModule.ModuleVersionId}/"
+                + $"{typeof(CompileServer).Assembly.ManifestModule.ModuleVersionId}";
+        }
+    }
+
+    private static string SocketDirectory
+    {
+        get
+        {
+            if (OperatingSystem.IsWindows())
+            {
+                return Path.Combine(
+                    Environment.GetFolderPath(Environment.SpecialFolder.LocalApplicationData),
+                    "mothc"
+                );
+            }
+
+            // the runtime directory belongs to the user alone, unlike the temporary directory
+            string? runtimeDir = Environment.GetEnvironmentVariable("XDG_RUNTIME_DIR");
+
+            return String.IsNullOrEmpty(runtimeDir)
+                ? Path.Combine(Path.GetTempPath(), $"mothc-{GetEffectiveUserId()}")
+                : runtimeDir;
+        }
+    }
+
+    public static int Serve(string socketPath, Logger logger)
+    {
+        if (socketPath == DefaultSocketPath && !Directory.Exists(SocketDirectory))
+        {
+            if (OperatingSystem.IsWindows())
+                Directory.CreateDirectory(SocketDirectory);
+            else
+                Directory.CreateDirectory(SocketDirectory, PrivateMode);
+        }
+
+        if (socketPath == DefaultSocketPath && !IsPrivate(SocketDirectory))
+        {
+            throw new Exception(
+                $"\"{SocketDirectory}\" can be accessed by other users, refusing to listen in it."
+            );
+        }
+
+        if (File.Exists(socketPath))
+        {
+            if (TryConnect(socketPath, out Socket? other))
+            {
+                other.Dispose();
+                throw new Exception(
+                    $"A compile server is already listening on \"{socketPath}\"."
+                );
+            }
+
+            // left behind by a server that did not shut down cleanly
+            File.Delete(socketPath);
+        }
+
+        ParseCache.KeepInMemory = true;
+
+        using (
+            var listener = new Socket(
+                AddressFamily.Unix,
+                SocketType.Stream,
+                ProtocolType.Unspecified
+            )
+        )
+        {
+            listener.Bind(new UnixDomainSocketEndPoint(socketPath));
+            listener.Listen();
+            logger.Log($"Listening on \"{socketPath}\"...");
+
+            try
+            {
+                while (true)
+                {
+                    using (var client = listener.Accept())
+                    using (var stream = new NetworkStream(client))
+                    {
+                        if (!IsSameUser(client))
+                        {
+                            logger.Warn("Refused a request from another user.");
+                            continue;
+                        }
+
+                        try
+                        {
+                            Handle(stream, logger);
+                        }
+                        catch (EndOfStreamException)
+                        {
+                            // a client that only checked whether the server is up
+                        }
+                        catch (Exception e)
+                        {
+                            logger.Error($"Failed to handle a request due to: {e.Message}");
+                        }
+                    }
+                }
+            }
+            finally
+            {
+                File.Delete(socketPath);
+            }
+        }
+    }
+
+    // Runs mothc in the compile server if one is listening, and relays its output to the console.
+    // Returns false without doing anything when there is no server to forward to, or when it is
+    // not one this build of the compiler can trust to build the same way.
+    public static bool TryForward(IReadOnlyList<string> args, out int exitCode)
+    {
+        exitCode = 0;
+
+        if (
+            !File.Exists(DefaultSocketPath)
+            || !IsPrivate(SocketDirectory)
+            || !TryConnect(DefaultSocketPath, out Socket? socket)
+        )
+        {
+            return false;
+        }
+
+        using (socket)
+        using (var stream = new NetworkStream(socket))
+        using (var writer = new BinaryWriter(stream, Encoding.UTF8, true))
+        using (var reader = new BinaryReader(stream, Encoding.UTF8, true))
+        {
+            if (!IsSameUser(socket))
+                return false;
+
+            writer.Write(Identity);
+            writer.Flush();
+
+            if (!reader.ReadBoolean())
+                return false;
+
+            writer.Write(Environment.CurrentDirectory);
+            writer.Write(args.Count);
+
+            foreach (string arg in args)
+            {
+                writer.Write(arg);
+            }
+
+            writer.Flush();
+
+            while (reader.ReadBoolean())
+            {
+                Console.Write(reader.ReadString());
+            }
+
+            exitCode = reader.ReadInt32();
+            return true;
+        }
+    }
+
+    private static void Handle(Stream stream, Logger logger)
+    {
+        using (var reader = new BinaryReader(stream, Encoding.UTF8, true))
+        using (var writer = new BinaryWriter(stream, Encoding.UTF8, true))
+        {
+            bool sameBuild = reader.ReadString() == Identity;
+            writer.Write(sameBuild);
+            writer.Flush();
+
+            if (!sameBuild)
+            {
+                logger.Warn("Refused a request from a different build of the compiler.");
+                return;
+            }
+
+            string workingDir = reader.ReadString();
+            var args = new string[reader.ReadInt32()];
+
+            for (int i = 0; i < args.Length; i++)
+            {
+                args[i] = reader.ReadString();
+            }
+
+            logger.Call("mothc", String.Join(' ', args));
+
+            TextWriter output = TextWriter.Synchronized(new ReplyWriter(writer));
+            TextWriter stdout = Console.Out;
+            TextWriter stderr = Console.Error;
+            IAnsiConsole console = AnsiConsole.Console;
+            int exitCode;
+
+            try
+            {
+                Console.SetOut(output);
+                Console.SetError(output);
+                AnsiConsole.Console = AnsiConsole.Create(
+                    new AnsiConsoleSettings { Out = new AnsiConsoleOutput(output) }
+                );
+                Environment.CurrentDirectory = workingDir;
+
+                exitCode =
+                    args.FirstOrDefault() == "serve"
+                        ? throw new Exception("Cannot start a compile server from a request.")
+                        : Program.Main(args);
+            }
+            catch (Exception e)
+            {
+                // mothc has already reported why the build failed
+                logger.Error($"Request failed due to: {e.Message}");
+                exitCode = 1;
+            }
+            finally
+            {
+                Console.SetOut(stdout);
+                Console.SetError(stderr);
+                AnsiConsole.Console = console;
+            }
+
+            writer.Write(false);
+            writer.Write(exitCode);
+            writer.Flush();
+            logger.ExitCode(exitCode);
+        }
+    }
+
+    private static bool TryConnect(string socketPath, [NotNullWhen(true)] out Socket? socket)
+    {
+        socket = new Socket(AddressFamily.Unix, SocketType.Stream, ProtocolType.Unspecified);
+
+        try
+        {
+            socket.Connect(new UnixDomainSocketEndPoint(socketPath));
+            return true;
+        }
+        catch (SocketException)
+        {
+            socket.Dispose();
+            socket = null;
+            return false;
+        }
+    }
+
+    // Whether the directory is a real one that only the user can access.
+    private static bool IsPrivate(string dir)
+    {
+        if (OperatingSystem.IsWindows())
+            return true;
+
+        var info = new DirectoryInfo(dir);
+        return info.Exists && info.LinkTarget == null && info.UnixFileMode == PrivateMode;
+    }
+
+    // Only Linux reports who is on the other end of a Unix socket this way, elsewhere the
+    // directory the socket is in is relied on.
+    private static bool IsSameUser(Socket socket)
+    {
+        if (!OperatingSystem.IsLinux())
+            return true;
+
+        // struct ucred { pid_t pid; uid_t uid; gid_t gid; }
+        Span<byte> credentials = stackalloc byte[12];
+
+        if (socket.GetRawSocketOption(SolSocket, SoPeerCred, credentials) != credentials.Length)
+            return false;
+
+        return BitConverter.ToUInt32(credentials.Slice(4, 4)) == GetEffectiveUserId();
+    }
+
+    [DllImport("libc", EntryPoint = "geteuid")]
+    private static extern uint GetEffectiveUserId();
+
+    // Sends everything written to it to the client as part of the reply.
+    private sealed class ReplyWriter : TextWriter
+    {
+        private readonly BinaryWriter _writer;
+
+        public override Encoding Encoding
+        {
+            get => Encoding.UTF8;
+        }
+
+        public ReplyWriter(BinaryWriter writer)
+        {
+            _writer = writer;
+        }
+
+        public override void Write(char value) => Write(value.ToString());
+
+        public override void Write(string? value)
+        {
+            if (String.IsNullOrEmpty(value))
+                return;
+
+            _writer.Write(true);
+            _writer.Write(value);
+        }
+
+        public override void Flush() => _writer.Flush();
+    }
+}
@@ -0,0 +1,96 @@
+using System.Diagnostics;
+using Moth.Tokens;
+
+namespace Moth.Compiler;
+
+// Measures how fast sources are scanned, comparing the vectorized scans of the tokenizer against
+// the character by character loops they replaced, and against tokenizing the sources in full.
+public static class LexerBenchmark
+{
+    public static void Run(IEnumerable<string> paths, int repeat, Logger logger)
+    {
+        string source = String.Concat(
+            Enumerable.Repeat(String.Concat(paths.Select(File.ReadAllText)), Math.Max(repeat, 1))
+        );
+        double megabytes = source.Length * sizeof(char) / (1024.0 * 1024.0);
+
+        logger.Log($"Scanning {megabytes:F1} MB of source...");
+
+        double scalar = Measure(() => ScanScalar(source));
+        double vectorized = Measure(() => ScanVectorized(source));
+        double tokenize = Measure(() => Tokenizer.Tokenize(source));
+
+        logger.WriteUnsignedLine($"{"scalar scanning",-21}{megabytes / scalar,8:F1} MB/s");
+        logger.WriteUnsignedLine($"{"vectorized scanning",-21}{megabytes / vectorized,8:F1} MB/s");
+        logger.WriteUnsignedLine($"{"full tokenization",-21}{megabytes / tokenize,8:F1} MB/s");
+    }
+
+    // The first run only warms up the JIT.
+    private static double Measure(Action action)
+    {
+        action();
+
+        var stopwatch = Stopwatch.StartNew();
+        action();
+        return stopwatch.Elapsed.TotalSeconds;
+    }
+
+    // The loops the tokenizer used before the scans were vectorized.
+    private static int ScanScalar(string source)
+    {
+        var stream = new PeekStream(source);
+        int count = 0;
+
+        while (stream.Current is { } ch)
+        {
+            if (ch == '/' && stream.Next == '/')
+            {
+                stream.Position++;
+
+                while (stream.MoveNext(out ch) && ch != '\n') { }
+            }
+            else if (ch == '/' && stream.Next == '>')
+            {
+                stream.Position++;
+
+                while (stream.MoveNext(out ch) && !(ch == '<' && stream.Next == '/')) { }
+            }
+            else if (char.IsLetter(ch) || ch == '_')
+            {
+                stream.Position += stream.Peek(c => char.IsLetterOrDigit(c) || c == '_').Length - 1;
+            }
+
+            count++;
+            stream.MoveNext();
+        }
+
+        return count;
+    }
+
+    private static int ScanVectorized(string source)
+    {
+        var stream = new PeekStream(source);
+        int count = 0;
+
+        while (stream.Current is { } ch)
+        {
+            if (ch == '/' && stream.Next == '/')
+            {
+                stream.Position = stream.IndexOf(stream.Position + 2, '\n');
+            }
+            else if (ch == '/' && stream.Next == '>')
+            {
+                stream.Position = stream.IndexOf(stream.Position + 2, "</");
+            }
+            else if (char.IsLetter(ch) || ch == '_')
+            {
+                stream.Position += stream.PeekIdentifier().Length - 1;
+            }
+
+            count++;
+            stream.MoveNext();
+        }
+
+        return count;
+    }
+}
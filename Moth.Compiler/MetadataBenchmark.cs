@@ -0,0 +1,102 @@
+using System.Diagnostics;
+using System.IO.Compression;
+using Moth.LLVM;
+using Codec = Moth.LLVM.Metadata.Codec;
+
+namespace Moth.Compiler;
+
+// Measures the metadata of a library under every codec, to help pick the codecs for a build:
+// quick to load for day to day builds, or small for release artifacts. Load time includes reading
+// the compressed metadata from disk, while mapping the uncompressed .meta file is listed as is.
+public static class MetadataBenchmark
+{
+    private static readonly (Codec, CompressionLevel?)[] Settings =
+    {
+        (Codec.None, null),
+        (Codec.Lz4, null),
+        (Codec.Deflate, CompressionLevel.Fastest),
+        (Codec.Deflate, CompressionLevel.Optimal),
+        (Codec.Deflate, CompressionLevel.SmallestSize),
+        (Codec.Brotli, CompressionLevel.Fastest),
+        (Codec.Brotli, CompressionLevel.Optimal),
+        (Codec.Brotli, CompressionLevel.SmallestSize)
+    };
+
+    public static void Run(string path, int iterations, Logger logger)
+    {
+        string libName = Path.GetFileName(path).Replace(".mothlib.bc", "");
+        string sidecar = Path.Combine(Path.GetDirectoryName(path) ?? "", $"{libName}.meta");
+
+        if (!File.Exists(sidecar))
+        {
+            throw new Exception(
+                $"Cannot measure \"{path}\", there is no \"{sidecar}\". Rebuild it with metadata."
+            );
+        }
+
+        byte[] image = File.ReadAllBytes(sidecar);
+        string temp = Path.GetTempFileName();
+
+        logger.Log($"Measuring the metadata of \"{libName}\" ({image.Length} bytes)...");
+        logger.WriteUnsignedLine(
+            $"{"codec",-8}{"level",-14}{"tables",10}{"names",10}{"total",10}{"ratio",8}"
+                + $"{"pack ms",10}{"unpack ms",11}{"load ms",10}"
+        );
+
+        try
+        {
+            foreach ((Codec codec, CompressionLevel? level) in Settings)
+            {
+                var stopwatch = Stopwatch.StartNew();
+                byte[] blob = MetadataCodec.Pack(
+                    image,
+                    codec,
+                    codec,
+                    level ?? CompressionLevel.NoCompression
+                );
+                double pack = stopwatch.Elapsed.TotalMilliseconds;
+                var header = MetadataCodec.ReadHeader(blob);
+
+                File.WriteAllBytes(temp, blob);
+
+                double unpack = Average(
+                    iterations,
+                    () => MetadataCodec.Unpack(blob, libName).Dispose()
+                );
+                double load = Average(
+                    iterations,
+                    () => MetadataCodec.Unpack(File.ReadAllBytes(temp), libName).Dispose()
+                );
+
+                logger.WriteUnsignedLine(
+                    $"{codec.ToString().ToLower(),-8}{level?.ToString() ?? "-",-14}"
+                        + $"{header.table_compressed_size,10}{header.name_compressed_size,10}"
+                        + $"{blob.Length,10}{(double)blob.Length / image.Length,8:P1}"
+                        + $"{pack,10:F3}{unpack,11:F3}{load,10:F3}"
+                );
+            }
+
+            double map = Average(iterations, () => MetadataImage.Map(sidecar).Dispose());
+            logger.WriteUnsignedLine(
+                $"{"mapped",-8}{"-",-14}{"",10}{"",10}{image.Length,10}{"",8}"
+                    + $"{"",10}{"",11}{map,10:F3}"
+            );
+        }
+        finally
+        {
+            File.Delete(temp);
+        }
+    }
+
+    private static double Average(int iterations, Action action)
+    {
+        var stopwatch = Stopwatch.StartNew();
+
+        for (int i = 0; i < iterations; i++)
+        {
+            action();
+        }
+
+        return stopwatch.Elapsed.TotalMilliseconds / Math.Max(iterations, 1);
+    }
+}
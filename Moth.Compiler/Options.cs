@@ -3,6 +3,7 @@ using CommandLine;
 
 namespace Moth.Compiler;
 
+[Verb("build", isDefault: true, HelpText = "Compile the input files.")]
 internal class Options
 {
     [Option('v', "verbose", Required = false, HelpText = "Whether to include extensive logging.")]
@@ -19,10 +20,46 @@ internal class Options
     [Option(
         "no-advanced-ir-opt",
         Required = false,
-        HelpText = "Whether to forego advanced optimizations to the IR."
+        HelpText = "Whether to forego advanced optimizations to the IR. Same as -O0."
     )]
     public bool DoNotOptimizeIR { get; set; }
 
+    [Option(
+        'O',
+        "opt-level",
+        Required = false,
+        HelpText = "The level to optimize the IR at. Options are: \"0\", \"1\", \"2\", \"3\", \"s\" and \"z\"."
+    )]
+    public string OptimizationLevel { get; set; } = "1";
+
+    [Option(
+        "lto",
+        Required = false,
+        HelpText = "Whether to merge the Moth libraries into an executable before optimizing it, so that calls into them can be inlined and unused code removed."
+    )]
+    public bool LinkTimeOptimization { get; set; }
+
+    [Option(
+        "target-cpu",
+        Required = false,
+        HelpText = "The CPU to generate code for. Pass \"native\" to tune for the host CPU and its features."
+    )]
+    public string TargetCPU { get; set; } = "generic";
+
+    [Option(
+        "target-features",
+        Required = false,
+        HelpText = "The CPU features to enable or disable when generating code, such as \"+avx2,-sse4a\"."
+    )]
+    public string TargetFeatures { get; set; } = "";
+
+    [Option(
+        "passes",
+        Required = false,
+        HelpText = "A custom LLVM pass pipeline to run instead of the one for the optimization level."
+    )]
+    public string? PassPipeline { get; set; }
+
     [Option(
         'o',
         "output-file",
@@ -31,6 +68,56 @@ internal class Options
     )]
     public string? OutputFile { get; set; }
 
+    [Option(
+        'j',
+        "jobs",
+        Required = false,
+        HelpText = "The maximum number of input files to tokenize and parse in parallel. Defaults to the number of cores."
+    )]
+    public int Jobs { get; set; } = 0;
+
+    [Option(
+        "codegen-jobs",
+        Required = false,
+        HelpText = "The number of shards to compile function bodies in, each on its own thread and LLVM context. Pass 0 to use the number of cores."
+    )]
+    public int CodegenJobs { get; set; } = 1;
+
+    [Option(
+        "reachable-only",
+        Required = false,
+        HelpText = "Whether to only compile the bodies of functions reachable from main, @Export functions and, in a library, public functions."
+    )]
+    public bool ReachableOnly { get; set; }
+
+    [Option(
+        "jit",
+        Required = false,
+        HelpText = "Whether to run the executable's main through the JIT instead of linking it. The Moth libraries are merged into it, and the C libraries have to be shared ones."
+    )]
+    public bool JIT { get; set; }
+
+    [Option(
+        "run-args",
+        Required = false,
+        HelpText = "When running through the JIT, the arguments to pass to main, quoted the same way as for a native run."
+    )]
+    public string RunArgs { get; set; } = "";
+
+    [Option(
+        "run-dir",
+        Required = false,
+        HelpText = "When running through the JIT, the working directory to use."
+    )]
+    public string? RunDir { get; set; }
+
+    [Option(
+        "parse-cache",
+        Required = false,
+        HelpText = "A directory to cache parsed input files in, so that unchanged files are not parsed again."
+    )]
+    public string? ParseCacheDir { get; set; }
+
     [Option('i', "input", Required = true, HelpText = "The files to compile.")]
     public IEnumerable<string>? InputFiles { get; set; }
 
@@ -59,6 +146,21 @@ internal class Options
     )]
     public string CompressionLevel { get; set; } = "mid";
 
+    [Option(
+        "metadata-codec",
+        Required = false,
+        HelpText = "The codec to compress the tables of mothlib embedded metadata with. "
+            + "Options are: \"none\", \"deflate\", \"brotli\", and \"lz4\"."
+    )]
+    public string MetadataCodec { get; set; } = "deflate";
+
+    [Option(
+        "metadata-name-codec",
+        Required = false,
+        HelpText = "The codec to compress the names in mothlib embedded metadata with. Defaults to the codec of the tables."
+    )]
+    public string? MetadataNameCodec { get; set; }
+
     [Option(
         'm',
         "moth-libs",
@@ -84,6 +186,95 @@ internal class Options
     public IEnumerable<string>? ExportLanguages { get; set; }
 }
 
+[Verb("fmt", HelpText = "Format the input files in place.")]
+internal class FormatOptions
+{
+    [Option('v', "verbose", Required = false, HelpText = "Whether to include extensive logging.")]
+    public bool Verbose { get; set; }
+
+    [Option(
+        "check",
+        Required = false,
+        HelpText = "Whether to only report unformatted files instead of overwriting them."
+    )]
+    public bool Check { get; set; }
+
+    [Option(
+        'j',
+        "jobs",
+        Required = false,
+        HelpText = "The maximum number of input files to format in parallel. Defaults to the number of cores."
+    )]
+    public int Jobs { get; set; } = 0;
+
+    [Option('i', "input", Required = true, HelpText = "The files to format.")]
+    public IEnumerable<string>? InputFiles { get; set; }
+}
+
+[Verb(
+    "bench-meta",
+    HelpText = "Compare the size and load time of mothlib metadata under every codec."
+)]
+internal class BenchMetadataOptions
+{
+    [Option(
+        "iterations",
+        Required = false,
+        HelpText = "How many times to decompress the metadata of each library per codec."
+    )]
+    public int Iterations { get; set; } = 20;
+
+    [Option(
+        'i',
+        "input",
+        Required = true,
+        HelpText = "The mothlibs to measure. Each needs the .meta file written next to it."
+    )]
+    public IEnumerable<string>? InputFiles { get; set; }
+}
+
+[Verb("bench-lex", HelpText = "Measure how fast the input files are scanned and tokenized.")]
+internal class BenchLexerOptions
+{
+    [Option(
+        "repeat",
+        Required = false,
+        HelpText = "How many times to repeat the input files, so that the measurement is not too short."
+    )]
+    public int Repeat { get; set; } = 1000;
+
+    [Option('i', "input", Required = true, HelpText = "The files to scan.")]
+    public IEnumerable<string>? InputFiles { get; set; }
+}
+
+[Verb(
+    "bench-parse",
+    HelpText = "Measure how much memory the parsed input files hold on to, with and without pooled function bodies."
+)]
+internal class BenchParseOptions
+{
+    [Option(
+        "repeat",
+        Required = false,
+        HelpText = "How many times to parse the input files, as if the program had that many copies of them."
+    )]
+    public int Repeat { get; set; } = 200;
+
+    [Option('i', "input", Required = true, HelpText = "The files to parse.")]
+    public IEnumerable<string>? InputFiles { get; set; }
+}
+
+[Verb("serve", HelpText = "Keep a compiler running that builds on behalf of luna.")]
+internal class ServeOptions
+{
+    [Option(
+        "socket",
+        Required = false,
+        HelpText = "The Unix socket to listen on. luna only looks for the default one."
+    )]
+    public string? SocketPath { get; set; }
+}
+
 public enum OutputType
 {
     Executable,
@@ -0,0 +1,101 @@
+using System.Diagnostics;
+using Moth.AST;
+using Moth.AST.Node;
+using Moth.Tokens;
+
+namespace Moth.Compiler;
+
+// Measures how much of the heap the parsed scripts of a program hold on to, with their function
+// bodies as node objects and moved into body pools, and how long it takes to read every body back.
+public static class ParseBenchmark
+{
+    public static void Run(IEnumerable<string> paths, int repeat, Logger logger)
+    {
+        SourceFile[] sources = paths
+            .Select(path => new SourceFile(File.ReadAllText(path), path))
+            .ToArray();
+
+        logger.Log($"Parsing {sources.Length * Math.Max(repeat, 1)} scripts...");
+
+        long baseline = GC.GetTotalMemory(true);
+        ScriptAST[] scripts = Enumerable
+            .Range(0, Math.Max(repeat, 1))
+            .SelectMany(_ => sources.Select(Parse))
+            .ToArray();
+        long objects = GC.GetTotalMemory(true) - baseline;
+
+        double readObjects = Measure(() => ReadBodies(scripts));
+        double pooling = Measure(() => PoolBodies(scripts));
+        long pooled = GC.GetTotalMemory(true) - baseline;
+        double readPooled = Measure(() => ReadBodies(scripts));
+
+        logger.WriteUnsignedLine(
+            $"{"node objects",-14}{objects / (1024.0 * 1024.0),8:F1} MB"
+                + $"{readObjects * 1000,10:F1} ms to read every body"
+        );
+        logger.WriteUnsignedLine(
+            $"{"body pools",-14}{pooled / (1024.0 * 1024.0),8:F1} MB"
+                + $"{readPooled * 1000,10:F1} ms to read every body"
+        );
+        logger.WriteUnsignedLine($"Pooled {ReadBodies(scripts)} bodies in {pooling * 1000:F1} ms.");
+        GC.KeepAlive(scripts);
+    }
+
+    private static double Measure(Action action)
+    {
+        var stopwatch = Stopwatch.StartNew();
+        action();
+        return stopwatch.Elapsed.TotalSeconds;
+    }
+
+    private static ScriptAST Parse(SourceFile source)
+    {
+        var symbols = new SymbolTable();
+        List<Token> tokens = Tokenizer.Tokenize(source, symbols);
+        return ASTGenerator.ProcessScript(new ParseContext(tokens, symbols, source));
+    }
+
+    private static void PoolBodies(ScriptAST[] scripts)
+    {
+        foreach (ScriptAST script in scripts)
+        {
+            script.PoolBodies();
+        }
+    }
+
+    private static int ReadBodies(ScriptAST[] scripts)
+    {
+        int count = 0;
+
+        foreach (ScriptAST script in scripts)
+        {
+            foreach (FuncDefNode func in GetFunctions(script))
+            {
+                if (func.ExecutionBlock != null)
+                    count++;
+            }
+        }
+
+        return count;
+    }
+
+    private static IEnumerable<FuncDefNode> GetFunctions(ScriptAST script)
+    {
+        foreach (IStatementNode statement in script.Contents)
+        {
+            IEnumerable<IStatementNode> members = statement switch
+            {
+                FuncDefNode func => new[] { func },
+                TypeNode type => type.Functions,
+                TraitNode trait => trait.Scope.Statements,
+                ImplementNode implement => implement.Implementations.Statements,
+                _ => Enumerable.Empty<IStatementNode>(),
+            };
+
+            foreach (FuncDefNode func in members.OfType<FuncDefNode>())
+            {
+                yield return func;
+            }
+        }
+    }
+}
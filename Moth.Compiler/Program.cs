@@ -13,20 +13,73 @@ namespace Moth.Compiler;
 
 public class Program
 {
+    private static bool _isLLVMInitialized = false;
+
     public static int Main(string[] args)
     {
         string dir = Environment.CurrentDirectory;
         var logger = new Logger("mothc");
+        int exitCode = 0;
 
         Parser
-            .Default.ParseArguments<Options>(args)
-            .WithParsed(options =>
+            .Default.ParseArguments<
+                Options,
+                FormatOptions,
+                ServeOptions,
+                BenchMetadataOptions,
+                BenchLexerOptions,
+                BenchParseOptions
+            >(args)
+            .WithParsed<ServeOptions>(options =>
+            {
+                exitCode = CompileServer.Serve(
+                    options.SocketPath ?? CompileServer.DefaultSocketPath,
+                    logger
+                );
+            })
+            .WithParsed<BenchMetadataOptions>(options =>
+            {
+                _ = options.InputFiles ?? throw new Exception("No input files provided.");
+
+                foreach (string path in options.InputFiles)
+                {
+                    MetadataBenchmark.Run(path, options.Iterations, logger);
+                }
+            })
+            .WithParsed<BenchLexerOptions>(options =>
+            {
+                _ = options.InputFiles ?? throw new Exception("No input files provided.");
+                LexerBenchmark.Run(options.InputFiles, options.Repeat, logger);
+            })
+            .WithParsed<BenchParseOptions>(options =>
+            {
+                _ = options.InputFiles ?? throw new Exception("No input files provided.");
+                ParseBenchmark.Run(options.InputFiles, options.Repeat, logger);
+            })
+            .WithParsed<FormatOptions>(options =>
+            {
+                _ = options.InputFiles ?? throw new Exception("No input files provided.");
+
+                int unformatted = FrontEnd.FormatFiles(
+                    options.InputFiles.ToArray(),
+                    options.Jobs,
+                    logger,
+                    options.Check,
+                    options.Verbose
+                );
+
+                if (options.Check && unformatted > 0)
+                {
+                    logger.Error($"{unformatted} file(s) are not formatted.");
+                    exitCode = 1;
+                }
+            })
+            .WithParsed<Options>(options =>
             {
                 _ = options.OutputType ?? throw new Exception("No output file type provided.");
                 _ = options.InputFiles ?? throw new Exception("No input files provided.");
                 _ = options.OutputFile ?? throw new Exception("No output file name provided.");
 
-                var scripts = new List<ScriptAST>();
                 var outputType = options.OutputType switch
                 {
                     "exe" => OutputType.Executable,
@@ -35,89 +88,36 @@ public class Program
 
                 logger.Log($"Building {options.OutputFile}...");
 
-                foreach (string filePath in options.InputFiles)
-                {
-                    try
-                    {
-                        if (options.Verbose)
-                        {
-                            logger.Log($"Reading \"{filePath}\"");
-                        }
-
-                        string fileContents = File.ReadAllText(filePath);
-
-                        // tokenize the contents of the file
-                        try
-                        {
-                            if (options.Verbose)
-                            {
-                                logger.Log($"Tokenizing \"{filePath}\"");
-                            }
-
-                            List<Token> tokens = Tokenizer.Tokenize(fileContents);
-
-                            // convert to AST
-                            try
-                            {
-                                if (options.Verbose)
-                                {
-                                    logger.Log($"Generating AST of \"{filePath}\"");
-                                }
-
-                                ScriptAST scriptAST = ASTGenerator.ProcessScript(
-                                    new ParseContext(tokens)
-                                );
-                                string formattedSource = scriptAST.GetSource();
-                                scripts.Add(scriptAST);
-
-                                if (
-                                    Utils.CompareTokens(Tokenizer.Tokenize(formattedSource), tokens)
-                                )
-                                {
-                                    logger.Log(
-                                        $"File \"{filePath}\" formatted successfully, overwriting..."
-                                    );
-
-                                    using (var fs = File.Create(filePath))
-                                        fs.Write(Encoding.UTF8.GetBytes(formattedSource));
-                                }
+                ScriptAST[] scripts = FrontEnd.ProcessFiles(
+                    options.InputFiles.ToArray(),
+                    options.Jobs,
+                    logger,
+                    options.Verbose,
+                    options.ParseCacheDir != null ? new ParseCache(options.ParseCacheDir) : null
+                );
 
-                                if (options.Verbose)
-                                {
-                                    logger.WriteSeparator();
-                                    logger.WriteUnsigned(formattedSource);
-                                    logger.WriteSeparator();
-                                }
-                            }
-                            catch (Exception e)
-                            {
-                                logger.Error(
-                                    $"Failed to parse tokens of \"{filePath}\" due to: {e}"
-                                );
-                                throw e;
-                            }
-                        }
-                        catch (Exception e)
-                        {
-                            logger.Error($"Failed to tokenize \"{filePath}\" due to: {e}");
-                            throw e;
-                        }
-                    }
-                    catch (Exception e)
+                if (options.Verbose)
+                {
+                    foreach (ScriptAST scriptAST in scripts)
                     {
-                        logger.Error($"Failed to get contents of \"{filePath}\" due to: {e}");
-                        throw e;
+                        logger.WriteSeparator();
+                        logger.WriteUnsigned(scriptAST.GetSource());
+                        logger.WriteSeparator();
                     }
                 }
 
-                // init LLVM stuff
+                // init LLVM stuff, once per process so that a compile server does it only once
                 // idk what half of these are
-                LLVMSharp.Interop.LLVM.LinkInMCJIT();
-                LLVMSharp.Interop.LLVM.InitializeAllTargetInfos();
-                LLVMSharp.Interop.LLVM.InitializeAllTargets();
-                LLVMSharp.Interop.LLVM.InitializeAllTargetMCs();
-                LLVMSharp.Interop.LLVM.InitializeAllAsmParsers();
-                LLVMSharp.Interop.LLVM.InitializeAllAsmPrinters();
+                if (!_isLLVMInitialized)
+                {
+                    LLVMSharp.Interop.LLVM.LinkInMCJIT();
+                    LLVMSharp.Interop.LLVM.InitializeAllTargetInfos();
+                    LLVMSharp.Interop.LLVM.InitializeAllTargets();
+                    LLVMSharp.Interop.LLVM.InitializeAllTargetMCs();
+                    LLVMSharp.Interop.LLVM.InitializeAllAsmParsers();
+                    LLVMSharp.Interop.LLVM.InitializeAllAsmPrinters();
+                    _isLLVMInitialized = true;
+                }
 
                 // compile
                 try
@@ -128,14 +128,31 @@ public class Program
                             logger,
                             new BuildOptions
                             {
-                                DoOptimize = !options.DoNotOptimizeIR,
+                                OptimizationLevel = options.DoNotOptimizeIR
+                                    ? OptimizationLevel.O0
+                                    : Utils.StringToOptLevel(options.OptimizationLevel),
+                                PassPipeline = options.PassPipeline,
+                                TargetCPU = options.TargetCPU,
+                                // the JIT runs one module, so the libraries are merged into it
+                                LinkTimeOptimization = options.LinkTimeOptimization || options.JIT,
+                                TargetFeatures = options.TargetFeatures,
                                 Version = Version.Parse(options.ModuleVersion ?? "0.0.0"),
                                 CompressionLevel = Utils.StringToCompLevel(
                                     options.CompressionLevel
                                 ),
+                                MetadataCodec = MetadataCodec.Parse(options.MetadataCodec),
+                                MetadataNameCodec = MetadataCodec.Parse(
+                                    options.MetadataNameCodec ?? options.MetadataCodec
+                                ),
                                 ExportLanguages = options
                                     .ExportLanguages.ToArray()
-                                    .ExecuteOverAll(s => Utils.StringToLanguage(s))
+                                    .ExecuteOverAll(s => Utils.StringToLanguage(s)),
+                                CodegenJobs =
+                                    options.CodegenJobs > 0
+                                        ? options.CodegenJobs
+                                        : Environment.ProcessorCount,
+                                CompileReachableOnly = options.ReachableOnly,
+                                IsLibrary = outputType == OutputType.StaticLib
                             }
                         )
                     )
@@ -143,29 +160,25 @@ public class Program
                         if (options.MothLibraryFiles.Count() > 0)
                         {
                             logger.Log("Loading external Moth libraries...");
-
-                            foreach (var path in options.MothLibraryFiles)
-                            {
-                                compiler.LoadLibrary(path);
-                            }
+                            compiler.LoadLibraries(options.MothLibraryFiles.ToArray());
                         }
 
                         logger.Log("Compiling to LLVM IR...");
+                        byte[]? metadata = null;
 
                         try
                         {
                             compiler.Compile(scripts);
 
-                            if (options.NoMetadata)
+                            // a JIT run writes nothing to disk, and nothing can link against it
+                            if (options.NoMetadata || options.JIT)
                             {
                                 logger.Info("Skipping generation of assembly metadata...");
                             }
                             else
                             {
                                 logger.Log("(unsafe) Generating assembly metadata...");
-
-                                using (var fs = File.Create($"{options.OutputFile}.meta"))
-                                    fs.Write(compiler.GenerateMetadata(options.OutputFile));
+                                metadata = compiler.GenerateMetadata(options.OutputFile);
                             }
                         }
                         catch (Exception e)
@@ -189,24 +202,66 @@ public class Program
                             logger.WriteSeparator();
                         }
 
-                        compiler.Module.PrintToFile($"{options.OutputFile}.ll");
+                        if (!options.JIT)
+                            compiler.Module.PrintToFile($"{options.OutputFile}.ll");
+
                         logger.Log("Verifying IR validity...");
                         compiler.Module.Verify(LLVMVerifierFailureAction.LLVMPrintMessageAction);
                         string? linkerName = null;
 
-                        if (outputType == OutputType.Executable)
+                        if (options.JIT)
                         {
+                            if (outputType != OutputType.Executable)
+                                throw new Exception(
+                                    "Only executables can be run through the JIT."
+                                );
+
+                            foreach (var lib in options.CLibraryFiles)
+                            {
+                                if (Path.GetExtension(lib) is ".a" or ".lib")
+                                    logger.Warn(
+                                        $"Skipping static library \"{lib}\" in the JIT."
+                                    );
+                                else
+                                    compiler.LoadNativeLibrary(lib);
+                            }
+
+                            if (options.RunDir != null)
+                            {
+                                Directory.CreateDirectory(options.RunDir);
+                                Environment.CurrentDirectory = options.RunDir;
+                            }
+
+                            try
+                            {
+                                exitCode = compiler.RunMain(SplitArguments(options.RunArgs));
+                            }
+                            finally
+                            {
+                                Environment.CurrentDirectory = dir;
+                            }
+                        }
+                        else if (outputType == OutputType.Executable)
+                        {
+                            int linkExitCode = 0;
+
                             // send to linker
                             try
                             {
-                                string bcFile = $"{options.OutputFile}.bc";
+                                string objFile = OperatingSystem.IsWindows()
+                                    ? $"{options.OutputFile}.obj"
+                                    : $"{options.OutputFile}.o";
                                 string binOut = Path.Combine(dir, "bin");
-                                string path = Path.Combine(dir, bcFile);
+                                string path = Path.Combine(dir, objFile);
                                 var arguments = new StringBuilder($"{path}");
 
-                                foreach (var lib in options.MothLibraryFiles)
+                                // with LTO, the libraries are already part of the object file
+                                if (!compiler.Options.DoLinkTimeOptimization)
                                 {
-                                    arguments.Append($" {lib}");
+                                    foreach (var lib in options.MothLibraryFiles)
+                                    {
+                                        arguments.Append($" {lib}");
+                                    }
                                 }
 
                                 foreach (var lib in options.CLibraryFiles)
@@ -214,9 +269,8 @@ public class Program
                                     arguments.Append($" {lib}");
                                 }
 
-                                logger.Log($"Outputting IR to \"{path}\"");
-                                compiler.Module.WriteBitcodeToFile(path);
-                                logger.Log("Compiling final product...");
+                                compiler.EmitObjectFile(path);
+                                logger.Log("Linking final product...");
                                 Directory.CreateDirectory(binOut);
 
                                 linkerName = "clang";
@@ -263,18 +317,18 @@ public class Program
                                         $"Linker \"{linkerName}\" failed to start."
                                     );
 
-                                while (!linker.HasExited)
-                                {
-                                    linkerLogger.WriteUnsignedLine(
-                                        linker.StandardOutput.ReadToEnd()
-                                    );
-                                    linkerLogger.WriteUnsignedLine(
-                                        linker.StandardError.ReadToEnd()
-                                    );
-                                }
+                                // both streams are drained at once, so neither can fill up and
+                                // stall the linker while the other is being read
+                                var stdout = linker.StandardOutput.ReadToEndAsync();
+                                var stderr = linker.StandardError.ReadToEndAsync();
+
+                                linker.WaitForExit();
+                                linkerLogger.WriteUnsignedLine(stdout.Result);
+                                linkerLogger.WriteUnsignedLine(stderr.Result);
 
                                 linkerLogger.WriteSeparator();
                                 linkerLogger.ExitCode(linker.ExitCode);
+                                linkExitCode = linker.ExitCode;
                             }
                             catch (Exception e)
                             {
@@ -284,6 +338,14 @@ public class Program
                                 logger.Error($"Failed to interact with {linkerName} due to: {e}");
                                 throw e;
                             }
+
+                            // callers such as luna rely on the exit code to know the build failed
+                            if (linkExitCode != 0)
+                            {
+                                throw new Exception(
+                                    $"{linkerName} finished with exit code {linkExitCode}"
+                                );
+                            }
                         }
                         else if (outputType == OutputType.StaticLib)
                         {
@@ -296,6 +358,18 @@ public class Program
                             throw new NotImplementedException("Output type not supported.");
                         }
 
+                        // written last, so that it is never older than the library it describes,
+                        // and swapped in whole, since loaders map the previous file
+                        if (metadata != null)
+                        {
+                            string sidecar = $"{options.OutputFile}.meta";
+
+                            using (var fs = File.Create($"{sidecar}.tmp"))
+                                fs.Write(metadata);
+
+                            File.Move($"{sidecar}.tmp", sidecar, true);
+                        }
+
                         logger.Log("Generating headers for supported export languages...");
 
                         foreach (var lang in compiler.Options.ExportLanguages)
@@ -313,6 +387,85 @@ public class Program
                 }
             });
 
-        return 0;
+        return exitCode;
+    }
+
+    // Splits a command line the way Process does for a native run, so that main gets the same
+    // arguments either way: quotes group spaces, and backslashes only escape quotes.
+    private static string[] SplitArguments(string commandLine)
+    {
+        var arguments = new List<string>();
+        var argument = new StringBuilder();
+        int i = 0;
+
+        while (true)
+        {
+            while (i < commandLine.Length && (commandLine[i] == ' ' || commandLine[i] == '\t'))
+                i++;
+
+            if (i == commandLine.Length)
+                return arguments.ToArray();
+
+            bool inQuotes = false;
+
+            while (i < commandLine.Length)
+            {
+                int backslashes = 0;
+
+                while (i < commandLine.Length && commandLine[i] == '\\')
+                {
+                    backslashes++;
+                    i++;
+                }
+
+                if (backslashes > 0)
+                {
+                    if (i == commandLine.Length || commandLine[i] != '"')
+                    {
+                        argument.Append('\\', backslashes);
+                    }
+                    else
+                    {
+                        argument.Append('\\', backslashes / 2);
+
+                        if (backslashes % 2 != 0)
+                        {
+                            argument.Append('"');
+                            i++;
+                        }
+                    }
+
+                    continue;
+                }
+
+                char ch = commandLine[i];
+
+                if (ch == '"')
+                {
+                    // two quotes inside quotes are a literal one
+                    if (inQuotes && i + 1 < commandLine.Length && commandLine[i + 1] == '"')
+                    {
+                        argument.Append('"');
+                        i++;
+                    }
+                    else
+                    {
+                        inQuotes = !inQuotes;
+                    }
+
+                    i++;
+                    continue;
+                }
+
+                if ((ch == ' ' || ch == '\t') && !inQuotes)
+                    break;
+
+                argument.Append(ch);
+                i++;
+            }
+
+            arguments.Add(argument.ToString());
+            argument.Clear();
+        }
     }
 }
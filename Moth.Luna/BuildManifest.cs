@@ -0,0 +1,193 @@
+using System.Security.Cryptography;
+using System.Text.Json;
+
+namespace Moth.Luna;
+
+// Records what the last successful build of a project was made from: the compiler, the options
+// it was called with, and the content of every source file and dependency. A build with the same
+// record as the last one would produce the same output, so mothc does not need to be called.
+public class BuildManifest
+{
+    public const string FileName = "luna-manifest.json";
+
+    public string Compiler { get; set; } = "";
+    public string[] Flags { get; set; } = new string[0];
+    public Dictionary<string, FileStamp> Inputs { get; set; } =
+        new Dictionary<string, FileStamp>();
+    public Dictionary<string, FileStamp> Dependencies { get; set; } =
+        new Dictionary<string, FileStamp>();
+
+    // Identifies this exact build of the compiler, as its version is not bumped for every change.
+    public static string CompilerIdentity
+    {
+        get
+        {
+            return $"{Meta.Version} "
+                + $"({typeof(Meta).Assembly.ManifestModule.ModuleVersionId}, "
+                + $"{typeof(Moth.Compiler.Program).Assembly.ManifestModule.ModuleVersionId})";
+        }
+    }
+
+    // Files that kept their size and modification time are not hashed again, so checking a build
+    // where nothing changed only has to look at the file system.
+    public static BuildManifest Create(
+        BuildManifest? previous,
+        IEnumerable<string> argv,
+        IEnumerable<string> inputs,
+        IEnumerable<string> dependencies
+    )
+    {
+        var manifest = new BuildManifest() { Compiler = CompilerIdentity };
+
+        foreach (var path in inputs)
+        {
+            manifest.Inputs[path] = FileStamp.Of(path, previous?.Inputs.GetValueOrDefault(path));
+        }
+
+        foreach (var path in dependencies)
+        {
+            manifest.Dependencies[path] = FileStamp.Of(
+                path,
+                previous?.Dependencies.GetValueOrDefault(path)
+            );
+        }
+
+        var flags = new List<string>();
+        bool skipValue = false;
+
+        // the files are tracked by content, and logging or parallelism do not affect the output
+        foreach (var arg in argv)
+        {
+            if (skipValue)
+            {
+                skipValue = false;
+                continue;
+            }
+
+            if (arg == "--jobs")
+                skipValue = true;
+            else if (
+                arg != ""
+                && arg != "--verbose"
+                && !manifest.Inputs.ContainsKey(arg)
+                && !manifest.Dependencies.ContainsKey(arg)
+            )
+            {
+                flags.Add(arg);
+            }
+        }
+
+        manifest.Flags = flags.ToArray();
+        return manifest;
+    }
+
+    public static BuildManifest? Load(string path)
+    {
+        if (!File.Exists(path))
+            return null;
+
+        try
+        {
+            return JsonSerializer.Deserialize<BuildManifest>(File.ReadAllText(path));
+        }
+        catch (JsonException)
+        {
+            // an unreadable manifest only means the project gets rebuilt
+            return null;
+        }
+    }
+
+    public void Save(string path)
+    {
+        string temp = $"{path}.tmp";
+        File.WriteAllText(temp, JsonSerializer.Serialize(this));
+        File.Move(temp, path, true);
+    }
+
+    // Returns why the project has to be rebuilt, or null when the previous build is up to date.
+    public string? FindChange(BuildManifest? previous, string outputPath)
+    {
+        if (previous == null)
+            return "there is no record of a previous build";
+
+        if (!File.Exists(outputPath))
+            return $"its output \"{outputPath}\" is missing";
+
+        if (previous.Compiler != Compiler)
+            return "the compiler changed";
+
+        if (!previous.Flags.SequenceEqual(Flags))
+            return $"its options changed from \"{String.Join(' ', previous.Flags)}\"";
+
+        return FindChange("source file", previous.Inputs, Inputs)
+            ?? FindChange("dependency", previous.Dependencies, Dependencies);
+    }
+
+    private static string? FindChange(
+        string kind,
+        Dictionary<string, FileStamp> previous,
+        Dictionary<string, FileStamp> current
+    )
+    {
+        foreach ((string path, FileStamp stamp) in current)
+        {
+            if (stamp.Hash == null)
+                return $"{kind} \"{path}\" does not exist";
+
+            if (!previous.TryGetValue(path, out FileStamp? old))
+                return $"{kind} \"{path}\" was added";
+
+            if (old.Hash != stamp.Hash)
+                return $"{kind} \"{path}\" changed";
+        }
+
+        foreach (var path in previous.Keys)
+        {
+            if (!current.ContainsKey(path))
+                return $"{kind} \"{path}\" was removed";
+        }
+
+        return null;
+    }
+}
+
+public class FileStamp
+{
+    public long Length { get; set; }
+    public long LastWriteTime { get; set; }
+
+    // The SHA-256 of the content, which is null when the file does not exist.
+    public string? Hash { get; set; }
+
+    public static FileStamp Of(string path, FileStamp? previous)
+    {
+        var info = new FileInfo(path);
+
+        if (!info.Exists)
+            return new FileStamp();
+
+        var stamp = new FileStamp()
+        {
+            Length = info.Length,
+            LastWriteTime = info.LastWriteTimeUtc.Ticks
+        };
+
+        if (
+            previous?.Hash != null
+            && previous.Length == stamp.Length
+            && previous.LastWriteTime == stamp.LastWriteTime
+        )
+        {
+            stamp.Hash = previous.Hash;
+        }
+        else
+        {
+            using (var file = File.OpenRead(path))
+            {
+                stamp.Hash = Convert.ToHexString(SHA256.HashData(file));
+            }
+        }
+
+        return stamp;
+    }
+}
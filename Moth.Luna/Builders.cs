@@ -51,7 +51,7 @@ public static class Builders
         if (build.ExitCode != 0)
             throw new Exception($"{source.Build.Command} finished with exit code {build.ExitCode}");
 
-        return Path.Combine(source.Dir, project.Out, project.FullOutputName);
+        return Path.Combine(source.Dir, project.CompiledOutputPath);
     }
 
     public static string BuildFromGit(GitSource source)
@@ -20,10 +20,18 @@ internal class Options
         'c',
         "clear-cache",
         Required = false,
-        HelpText = "Whether to clear dependency cache prior to build."
+        HelpText = "Whether to clear the dependency and parse caches prior to build."
     )]
     public bool ClearCache { get; set; }
 
+    [Option(
+        'f',
+        "force",
+        Required = false,
+        HelpText = "Whether to rebuild the project even if nothing changed since the last build."
+    )]
+    public bool Force { get; set; }
+
     [Option(
         'n',
         "no-meta",
@@ -39,6 +47,43 @@ internal class Options
     )]
     public bool DoNotOptimizeIR { get; set; }
 
+    [Option(
+        'O',
+        "opt-level",
+        Required = false,
+        HelpText = "Tell mothc which level to optimize the IR at."
+    )]
+    public string? OptimizationLevel { get; set; }
+
+    [Option(
+        "lto",
+        Required = false,
+        HelpText = "Tell mothc to merge the project's dependencies into it before optimizing."
+    )]
+    public bool LinkTimeOptimization { get; set; }
+
+    [Option(
+        "passes",
+        Required = false,
+        HelpText = "Tell mothc to run a custom LLVM pass pipeline instead."
+    )]
+    public string? PassPipeline { get; set; }
+
+    [Option(
+        'j',
+        "jobs",
+        Required = false,
+        HelpText = "Tell mothc how many input files to tokenize and parse in parallel."
+    )]
+    public int Jobs { get; set; } = 0;
+
+    [Option(
+        "check",
+        Required = false,
+        HelpText = "When formatting, pass this option to only report unformatted files."
+    )]
+    public bool Check { get; set; }
+
     [Option('p', "project", Required = false, HelpText = "The project file to use.")]
     public string ProjFile { get; set; }
 
@@ -56,10 +101,17 @@ internal class Options
     )]
     public bool InitLib { get; set; }
 
+    [Option(
+        "jit",
+        Required = false,
+        HelpText = "When running a project, pass this option to run it through the JIT instead of linking it."
+    )]
+    public bool JIT { get; set; }
+
     [Option(
         "run-args",
         Required = false,
-        HelpText = "When running a project, pass this option with the arguments to use."
+        HelpText = "When running a project, pass this option with the arguments to use, quoting any that contain spaces."
     )]
     public string RunArgs { get; set; } = "";
 
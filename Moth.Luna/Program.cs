@@ -62,6 +62,12 @@ internal class Program
                         ExecuteBuild(options);
                         break;
                     case "run":
+                        if (options.JIT)
+                        {
+                            ExecuteJIT(options);
+                            break;
+                        }
+
                         var proj = ExecuteBuild(options);
                         Logger.Log("Running project...");
                         Logger.WriteSeparator();
@@ -71,6 +77,9 @@ internal class Program
                         Logger.WriteSeparator();
                         new Logger(proj.Name).ExitCode(exitCode);
 
+                        break;
+                    case "fmt":
+                        ExecuteFormat(options);
                         break;
                     case "init":
                         ExecuteInit(options);
@@ -86,19 +95,77 @@ internal class Program
     private static Project ExecuteBuild(Options options)
     {
         var logger = Logger.MakeSubLogger("build");
+        Project project = PrepareBuild(options);
+        CallMothc(options, project, logger);
+        return project;
+    }
+
+    // Builds the project in memory and runs it through the JIT inside mothc, so nothing is linked.
+    private static void ExecuteJIT(Options options)
+    {
+        var logger = Logger.MakeSubLogger("build");
+        Project project = PrepareBuild(options);
+
+        if (project.Type == "lib")
+            throw new Exception($"Cannot run project \"{project.Name}\" as it is a library.");
+
+        Logger.Log("Running project through the JIT...");
+        var exitCode = CallMothc(options, project, logger, true);
+        Logger.WriteEmptyLine();
+        Logger.WriteSeparator();
+        new Logger(project.Name).ExitCode(exitCode);
+    }
+
+    // Reads the project file, and clears the caches first if asked to.
+    private static Project PrepareBuild(Options options)
+    {
         string projfile = options.ProjFile;
 
         if (projfile == null)
             projfile = "Luna.toml";
 
+        Project project = TomletMain.To<Project>(File.ReadAllText(projfile));
+
         if (options.ClearCache)
+        {
             Directory.Delete(CacheDir, true);
 
-        Project project = TomletMain.To<Project>(File.ReadAllText(projfile));
-        CallMothc(options, project, logger);
+            if (Directory.Exists(GetParseCacheDir(project)))
+                Directory.Delete(GetParseCacheDir(project), true);
+        }
+
         return project;
     }
 
+    private static void ExecuteFormat(Options options)
+    {
+        var logger = Logger.MakeSubLogger("fmt");
+        string projfile = options.ProjFile;
+
+        if (projfile == null)
+            projfile = "Luna.toml";
+
+        Project project = TomletMain.To<Project>(File.ReadAllText(projfile));
+        var args = new List<string> { "fmt" };
+
+        if (options.Verbose)
+            args.Add("--verbose");
+        if (options.Check)
+            args.Add("--check");
+        if (options.Jobs > 0)
+            args.Add($"--jobs={options.Jobs}");
+
+        args.Add("--input");
+        args.AddRange(Directory.GetFiles(project.Root, "*.moth", SearchOption.AllDirectories));
+        logger.Call("mothc", String.Join(' ', args));
+
+        var mothc = Moth.Compiler.Program.Main(args.ToArray());
+        logger.MakeSubLogger("mothc").ExitCode(mothc);
+
+        if (mothc != 0)
+            throw new Exception($"mothc finished with exit code {mothc}");
+    }
+
     private static int ExecuteRun(Options options, Project project)
     {
         string defaultRunDir = "run";
@@ -232,7 +299,13 @@ internal class Program
         }
     }
 
-    private static void CallMothc(Options options, Project project, Logger logger)
+    // Returns the exit code of main instead when running through the JIT.
+    private static int CallMothc(
+        Options options,
+        Project project,
+        Logger logger,
+        bool jit = false
+    )
     {
         var args = new StringBuilder();
 
@@ -245,12 +318,15 @@ internal class Program
 
         string buildDir = Path.Combine(Environment.CurrentDirectory, project.Out);
         var files = new StringBuilder();
+        var inputs = new List<string>();
+        var dependencies = new List<string>();
 
         foreach (
             var file in Directory.GetFiles(project.Root, "*.moth", SearchOption.AllDirectories)
         )
         {
-            files.Append($"{Path.Combine(Environment.CurrentDirectory, file)} ");
+            inputs.Add(Path.Combine(Environment.CurrentDirectory, file));
+            files.Append($"{inputs.Last()} ");
         }
 
         if (files.Length > 0)
@@ -259,14 +335,51 @@ internal class Program
             args.Append("--verbose ");
         if (options.NoMetadata)
             args.Append("--no-meta ");
+        if (options.Jobs > 0)
+            args.Append($"--jobs {options.Jobs} ");
+        if (options.DoNotOptimizeIR)
+            args.Append("--no-advanced-ir-opt ");
+        if (options.OptimizationLevel != null)
+            args.Append($"--opt-level {options.OptimizationLevel} ");
+        if (options.PassPipeline != null)
+            args.Append($"--passes {options.PassPipeline} ");
+        if (options.LinkTimeOptimization)
+            args.Append("--lto ");
+        if (project.TargetCPU != null)
+            args.Append($"--target-cpu {project.TargetCPU} ");
+        if (project.TargetFeatures != null)
+            args.Append($"--target-features {project.TargetFeatures} ");
+
+        if (jit)
+        {
+            string runDir = Path.GetFullPath(options.RunDir == null ? "run" : options.RunDir);
+            args.Append($"--jit --run-dir {runDir} ");
+        }
+
+        args.Append($"--parse-cache {GetParseCacheDir(project)} ");
+
+        // optimized builds are the ones that get shipped, so their metadata is made small, while
+        // the metadata of everyday builds is made quick to load
+        if (options.NoCompress)
+            args.Append("--metadata-codec none ");
+        else if (options.OptimizationLevel is not (null or "0"))
+            args.Append("--metadata-codec brotli --compression-level high ");
+        else
+            args.Append("--metadata-codec lz4 ");
 
-        string compLevel = options.NoCompress ? "none" : "high";
-        args.Append($"--compression-level {compLevel} ");
         args.Append($"--output-file {project.OutputName} ");
         args.Append($"--output-type {project.Type} ");
 
+        string mothLibs = DependencyBuildScheduler.Build(project.Dependencies);
+
         if (project.Dependencies != null)
-            args.Append($"--moth-libs {DependencyBuildScheduler.Build(project.Dependencies)}");
+            args.Append($"--moth-libs {mothLibs}");
+
+        // mothc resolves library paths from the build directory
+        foreach (var lib in mothLibs.Split(' ', StringSplitOptions.RemoveEmptyEntries))
+        {
+            dependencies.Add(Path.Combine(buildDir, lib));
+        }
 
         if (project.CLibraryFiles != null)
         {
@@ -275,6 +388,7 @@ internal class Program
             foreach (var lib in project.CLibraryFiles)
             {
                 clibs.Append($"{lib} ");
+                dependencies.Add(Path.Combine(buildDir, lib));
             }
 
             args.Append($"--c-libs {clibs}");
@@ -296,19 +410,74 @@ internal class Program
         args.Append($"--input {files}");
 
         Directory.CreateDirectory(buildDir);
+
+        var argv = args.ToString().Split(' ');
+        string manifestPath = Path.Combine(buildDir, BuildManifest.FileName);
+        BuildManifest? manifest = null;
+
+        // a build is skipped when it would be made from the same things as the last one, which
+        // does not apply to the JIT since it runs the project instead of writing it out
+        if (!jit)
+        {
+            bool force = options.Force || options.ClearCache;
+            var previous = force ? null : BuildManifest.Load(manifestPath);
+            manifest = BuildManifest.Create(previous, argv, inputs, dependencies);
+            string? change = force
+                ? "a rebuild was requested"
+                : manifest.FindChange(previous, project.CompiledOutputPath);
+
+            if (change == null)
+            {
+                logger.Log($"Project \"{project.Name}\" is up to date, skipping mothc.");
+                return 0;
+            }
+
+            logger.Log($"Building project \"{project.Name}\" as {change}.");
+
+            // a build that fails must not leave the record of an older one behind
+            File.Delete(manifestPath);
+        }
+
         Logger.Call("mothc", args);
 
         var oldDir = Environment.CurrentDirectory;
         Environment.CurrentDirectory = buildDir;
 
-        var mothc = Moth.Compiler.Program.Main(args.ToString().Split(' '));
-        Environment.CurrentDirectory = oldDir;
+        // the arguments for main are passed as one command line, which mothc splits the same way
+        // the native run does, as they may contain spaces, quotes and dashes
+        if (jit && options.RunArgs != "")
+            argv = argv.Append($"--run-args={options.RunArgs}").ToArray();
+
+        // builds go to the compile server when one is running, but main has to run in this process
+        int mothc;
+
+        try
+        {
+            if (jit || !Moth.Compiler.CompileServer.TryForward(argv, out mothc))
+                mothc = Moth.Compiler.Program.Main(argv);
+        }
+        finally
+        {
+            Environment.CurrentDirectory = oldDir;
+        }
+
+        if (jit)
+            return mothc;
+
         Logger.MakeSubLogger("mothc").ExitCode(mothc);
 
         if (mothc != 0)
             throw new Exception($"mothc finished with exit code {mothc}");
+
+        // only recorded once the build succeeded, so that a failed build is retried
+        manifest?.Save(manifestPath);
+        return mothc;
     }
 
+    // Parsed files are cached per project, next to its build output.
+    private static string GetParseCacheDir(Project project) =>
+        Path.Combine(Environment.CurrentDirectory, project.Out, "parse-cache");
+
     private static string QueryProjName()
     {
         Console.Write("Enter a name for the new project: ");
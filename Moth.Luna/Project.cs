@@ -32,6 +32,12 @@ public class Project
     [TomlProperty("target-languages")]
     public string[] LanguageTargets { get; set; }
 
+    [TomlProperty("target-cpu")]
+    public string TargetCPU { get; set; }
+
+    [TomlProperty("target-features")]
+    public string TargetFeatures { get; set; }
+
     [TomlProperty("dependencies")]
     public Dependencies Dependencies { get; set; }
 
@@ -59,4 +65,11 @@ public class Project
     {
         get => Path.Combine(Out, "bin", FullOutputName);
     }
+
+    // Where mothc writes the output, as libraries are not linked and so do not go to bin.
+    [TomlNonSerialized]
+    public string CompiledOutputPath
+    {
+        get => Type == "lib" ? Path.Combine(Out, FullOutputName) : FullOutputPath;
+    }
 }
@@ -0,0 +1,50 @@
+using Moth.AST;
+using Moth.AST.Node;
+using Moth.Tokens;
+
+namespace Moth.Test;
+
+[TestClass]
+public class BodyPooling
+{
+    [TestMethod]
+    public void PooledBodiesMatchParse()
+    {
+        var source = new SourceFile(ParseCaching.Code, "pooled.moth");
+        ScriptAST script = ParseCaching.Parse(source);
+        string expected = script.GetSource();
+
+        script.PoolBodies();
+        Assert.AreEqual(expected, script.GetSource());
+    }
+
+    [TestMethod]
+    public void PooledBodiesKeepEveryNode()
+    {
+        var source = new SourceFile(
+            $"{ParseCaching.Code}\n{ParseCaching.UnprintableCode}",
+            "pooled.moth"
+        );
+        ScriptAST script = ParseCaching.Parse(source);
+        byte[] expected = ParseCaching.Serialize(script);
+
+        script.PoolBodies();
+        CollectionAssert.AreEqual(expected, ParseCaching.Serialize(script));
+    }
+
+    [TestMethod]
+    public void PooledBodiesAreBuiltAnew()
+    {
+        var source = new SourceFile(ParseCaching.Code, "pooled.moth");
+        ScriptAST script = ParseCaching.Parse(source);
+        script.PoolBodies();
+
+        FuncDefNode work = script.Contents.OfType<FuncDefNode>().First(f => f.Name == "Work");
+        Assert.IsTrue(work.HasExecutionBlock);
+        Assert.AreNotSame(work.ExecutionBlock, work.ExecutionBlock);
+        Assert.AreEqual(work.ExecutionBlock!.Span, work.ExecutionBlock!.Span);
+
+        FuncDefNode puts = script.Contents.OfType<FuncDefNode>().First(f => f.Name == "puts");
+        Assert.IsFalse(puts.HasExecutionBlock);
+    }
+}
@@ -0,0 +1,80 @@
+using Moth.LLVM;
+
+namespace Moth.Test;
+
+[TestClass]
+public class Compression
+{
+    [TestMethod]
+    public void Lz4RoundTripsEmptyInput()
+    {
+        AssertRoundTrip(new byte[0]);
+    }
+
+    [TestMethod]
+    public void Lz4RoundTripsShortInput()
+    {
+        // shorter than the distance a match has to end from the end, so it is all literals
+        AssertRoundTrip("moth moth"u8.ToArray());
+        AssertRoundTrip(new byte[11]);
+    }
+
+    [TestMethod]
+    public void Lz4RoundTripsIncompressibleInput()
+    {
+        var data = new byte[70_000];
+        new Random(7).NextBytes(data);
+
+        AssertRoundTrip(data);
+    }
+
+    [TestMethod]
+    public void Lz4RoundTripsRepetitiveInput()
+    {
+        // matches one byte back overlap what they copy
+        var zeros = new byte[5_000];
+        byte[] compressed = AssertRoundTrip(zeros);
+        Assert.IsTrue(compressed.Length < zeros.Length / 50);
+
+        AssertRoundTrip(Enumerable.Range(0, 4_000).Select(i => (byte)(i % 3)).ToArray());
+    }
+
+    [TestMethod]
+    public void Lz4RoundTripsInputLargerThanWindow()
+    {
+        // repeats of a block further back than the largest offset cannot be matched against it
+        var block = new byte[40_000];
+        new Random(11).NextBytes(block);
+        byte[] data = block.Concat(new byte[30_000]).Concat(block).Concat(block).ToArray();
+
+        AssertRoundTrip(data);
+    }
+
+    [TestMethod]
+    public void Lz4RejectsCorruptInput()
+    {
+        byte[] data = Enumerable.Range(0, 1_000).Select(i => (byte)(i % 7)).ToArray();
+        byte[] compressed = Lz4.Compress(data);
+
+        Assert.ThrowsException<Exception>(
+            () => Lz4.Decompress(compressed.AsSpan(0, compressed.Length / 2), new byte[1_000])
+        );
+        Assert.ThrowsException<Exception>(() => Lz4.Decompress(compressed, new byte[999]));
+        Assert.ThrowsException<Exception>(() => Lz4.Decompress(compressed, new byte[1_001]));
+
+        // an offset that points before the start of the output
+        Assert.ThrowsException<Exception>(
+            () => Lz4.Decompress(new byte[] { 0x10, (byte)'a', 0x05, 0x00 }, new byte[16])
+        );
+    }
+
+    private static byte[] AssertRoundTrip(byte[] data)
+    {
+        byte[] compressed = Lz4.Compress(data);
+        var decompressed = new byte[data.Length];
+
+        Lz4.Decompress(compressed, decompressed);
+        CollectionAssert.AreEqual(data, decompressed);
+        return compressed;
+    }
+}
@@ -0,0 +1,29 @@
+using Moth.AST;
+using Moth.Tokens;
+
+namespace Moth.Test;
+
+[TestClass]
+public class Formatting
+{
+    [TestMethod]
+    public void DigitSeparatorsSurviveFormatting()
+    {
+        const string code =
+            "namespace unit::test;\n\n"
+            + "fn Work() #void {\n    var a = 1_000;\n    var b = 2_500.25;\n    ret\n}\n";
+        var source = new SourceFile(code, "digits.moth");
+        var symbols = new SymbolTable();
+        List<Token> tokens = Tokenizer.Tokenize(source, symbols);
+        string formatted = ASTGenerator
+            .ProcessScript(new ParseContext(tokens, symbols, source))
+            .GetSource();
+
+        StringAssert.Contains(formatted, "1000");
+        Assert.IsTrue(Moth.Utils.CompareTokens(Tokenizer.Tokenize(formatted), tokens));
+
+        // the separators are ignored, the digits are not
+        List<Token> changed = Tokenizer.Tokenize(formatted.Replace("1000", "100"));
+        Assert.IsFalse(Moth.Utils.CompareTokens(changed, tokens));
+    }
+}
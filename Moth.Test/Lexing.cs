@@ -0,0 +1,48 @@
+using Moth.Tokens;
+
+namespace Moth.Test;
+
+[TestClass]
+public class Lexing
+{
+    private const string Sample =
+        "// a line comment that runs on for a while, like generated bindings tend to\n"
+        + "/> a block comment\n   spanning a couple of lines </\n"
+        + "public foreign func some_long_generated_identifier_name(arg0 #u8*, arg1 #i32) #i32;\n"
+        + "global message #u8* = \"a string literal with an \\\"escape\\\" or two\\n\";\n";
+
+    [TestMethod]
+    public void ScansMatchScalarScans()
+    {
+        var stream = new PeekStream("identifier_1 ünïcode_2 rest");
+        Assert.AreEqual("identifier_1", stream.PeekIdentifier().ToString());
+        Assert.AreEqual(
+            stream.Peek(c => char.IsLetterOrDigit(c) || c == '_').ToString(),
+            stream.PeekIdentifier().ToString()
+        );
+
+        stream.Position = 13;
+        Assert.AreEqual("ünïcode_2", stream.PeekIdentifier().ToString());
+
+        stream.Position = 22;
+        Assert.AreEqual(1, stream.LengthOfWhitespace());
+
+        List<Token> tokens = Tokenizer.Tokenize(Sample);
+        Assert.AreEqual(TokenType.Comment, tokens[0].Type);
+        Assert.AreEqual(
+            " a line comment that runs on for a while, like generated bindings tend to",
+            tokens[0].Text.ToString()
+        );
+        Assert.AreEqual(TokenType.BlockComment, tokens[1].Type);
+        Assert.AreEqual(
+            " a block comment\n   spanning a couple of lines ",
+            tokens[1].Text.ToString()
+        );
+
+        Token literal = tokens.First(t => t.Type == TokenType.LiteralString);
+        Assert.AreEqual(
+            "a string literal with an \\\"escape\\\" or two\\n",
+            literal.Text.ToString()
+        );
+    }
+}
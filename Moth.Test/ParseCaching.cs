@@ -0,0 +1,93 @@
+using Moth.AST;
+using Moth.Tokens;
+
+namespace Moth.Test;
+
+[TestClass]
+public class ParseCaching
+{
+    internal const string Code =
+        "namespace unit::test;\n\nwith core;\nwith root::other::thing;\n\n"
+        + "@Attr(1, \"x\")\npub type Box<T, N #u64> {\n    pub value #T*;\n    count #u64;\n\n"
+        + "    pub fn Get(i #u64) #T {\n        ret self.value[i]\n    }\n}\n\n"
+        + "union type Either {\n    a #i32;\n    b #f32;\n}\n\n"
+        + "enum Color {\n    Red,\n    Green = 5,\n    Blue,\n}\n\n"
+        + "global counter #i32;\nforeign fn puts(s #u8*, ...) #i32;\n\n"
+        + "fn Work(xs #[#i32], f #(#i32, #i32) #i32, arr #Box<#i32, (4)>) {\n"
+        + "    // a comment\n    var a = 1 + 2 * 3 - -4;\n    var p = &a;\n    ++a;\n"
+        + "    while a < 10 or !true {\n        a = a + 1;\n    }\n"
+        + "    if a == 1 {\n        a = 2;\n    } else {\n        a = null;\n    }\n"
+        + "    Work(xs, f, arr).thing;\n    ret\n}\n";
+
+    // nodes that cannot be written back as source yet, so only their encoding is compared
+    internal const string UnprintableCode =
+        "trait Shape {\n    fn Area() #f32;\n}\n\n"
+        + "impl #Shape for #Circle {\n    fn Area() #f32 {\n        ret 3.14\n    }\n}\n\n"
+        + "fn Other(a #i32) {\n    var c = if a > 2 then 'a' else 'b';\n"
+        + "    var lst = #i32[1, 2, 3];\n    var fp = fn (x #i32) #i32 { ret x };\n"
+        + "    var cast = #u8(*fp);\n}\n";
+
+    [TestMethod]
+    public void RoundTripMatchesParse()
+    {
+        var source = new SourceFile(Code, "roundtrip.moth");
+        ScriptAST parsed = Parse(source);
+        byte[] bytes = Serialize(parsed);
+        ScriptAST loaded = new ASTDeserializer(new MemoryStream(bytes, false)).Process(source);
+
+        Assert.AreEqual(parsed.GetSource(), loaded.GetSource());
+        Assert.AreEqual(parsed.Span, loaded.Span);
+        CollectionAssert.AreEqual(bytes, Serialize(loaded));
+    }
+
+    [TestMethod]
+    public void RoundTripKeepsEveryNode()
+    {
+        var source = new SourceFile($"{Code}\n{UnprintableCode}", "roundtrip.moth");
+        ScriptAST parsed = Parse(source);
+        byte[] bytes = Serialize(parsed);
+        ScriptAST loaded = new ASTDeserializer(new MemoryStream(bytes, false)).Process(source);
+
+        Assert.AreEqual(parsed.Contents.Count, loaded.Contents.Count);
+        CollectionAssert.AreEqual(bytes, Serialize(loaded));
+    }
+
+    [TestMethod]
+    public void CacheOnlyLoadsMatchingContents()
+    {
+        string dir = Path.Combine(Path.GetTempPath(), $"moth-parse-cache-{Guid.NewGuid():N}");
+
+        try
+        {
+            var cache = new ParseCache(dir);
+            var source = new SourceFile(Code, "cached.moth");
+
+            Assert.IsFalse(cache.TryLoad(source, out _));
+
+            cache.Store(source, Parse(source));
+            Assert.IsTrue(cache.TryLoad(source, out ScriptAST loaded));
+            Assert.AreEqual(Parse(source).GetSource(), loaded.GetSource());
+
+            var changed = new SourceFile($"{Code}\nglobal other #i32;\n", "cached.moth");
+            Assert.IsFalse(cache.TryLoad(changed, out _));
+        }
+        finally
+        {
+            Directory.Delete(dir, true);
+        }
+    }
+
+    internal static ScriptAST Parse(SourceFile source)
+    {
+        var symbols = new SymbolTable();
+        List<Token> tokens = Tokenizer.Tokenize(source, symbols);
+        return ASTGenerator.ProcessScript(new ParseContext(tokens, symbols, source));
+    }
+
+    internal static byte[] Serialize(ScriptAST script)
+    {
+        var stream = new MemoryStream();
+        new ASTSerializer().Process(stream, script);
+        return stream.ToArray();
+    }
+}
@@ -36,8 +36,9 @@ internal class Utils
 
     public static (LLVMCompiler, LLVMExecutionEngineRef) FullCompile(string code)
     {
-        List<Token> tokens = Tokenizer.Tokenize(code);
-        var context = new ParseContext(tokens);
+        var symbols = new SymbolTable();
+        List<Token> tokens = Tokenizer.Tokenize(code, symbols);
+        var context = new ParseContext(tokens, symbols);
         ScriptAST ast = ASTGenerator.ProcessScript(context);
         var compiler = new LLVMCompiler(
             "fullcomp",
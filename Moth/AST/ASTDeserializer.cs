@@ -0,0 +1,387 @@
+using Moth.AST.Node;
+using Moth.Tokens;
+
+namespace Moth.AST;
+
+// Reads back a ScriptAST written by ASTSerializer.
+public class ASTDeserializer
+{
+    private readonly BinaryReader _reader;
+    private readonly string[] _strings;
+
+    public ASTDeserializer(Stream input)
+    {
+        _reader = new BinaryReader(input, Encoding.UTF8, true);
+        _strings = new string[_reader.Read7BitEncodedInt()];
+
+        for (int i = 0; i < _strings.Length; i++)
+        {
+            _strings[i] = _reader.ReadString();
+        }
+    }
+
+    public ScriptAST Process(SourceFile? source)
+    {
+        SourceSpan span = ReadSpan();
+        var @namespace = ReadNode<NamespaceNode>();
+        var contents = ReadList<IStatementNode>();
+        return new ScriptAST(@namespace, contents) { Span = span, Source = source };
+    }
+
+    private T ReadNode<T>()
+        where T : IASTNode? => (T)ReadNode();
+
+    private IASTNode? ReadNode()
+    {
+        IASTNode node;
+        var kind = (ASTNodeKind)_reader.ReadByte();
+
+        switch (kind)
+        {
+            case ASTNodeKind.Null:
+                return null;
+            case ASTNodeKind.Namespace:
+                node = new NamespaceNode(ReadString()) { Child = ReadNode<NamespaceNode?>() };
+                break;
+            case ASTNodeKind.NamespaceFromRoot:
+                node = new NamespaceFromRootNode() { Child = ReadNode<NamespaceNode?>() };
+                break;
+            case ASTNodeKind.Import:
+                node = new ImportNode(ReadNode<NamespaceNode>());
+                break;
+            case ASTNodeKind.Comment:
+                node = new CommentNode(ReadString(), _reader.ReadBoolean());
+                break;
+            case ASTNodeKind.Attribute:
+                node = new AttributeNode(ReadString(), ReadList<IExpressionNode>());
+                break;
+            case ASTNodeKind.Type:
+            {
+                (string name, PrivacyType privacy, List<AttributeNode> attributes) =
+                    ReadDefinition();
+                node = new TypeNode(
+                    name,
+                    privacy,
+                    ReadNode<ScopeNode?>(),
+                    _reader.ReadBoolean(),
+                    attributes
+                );
+                break;
+            }
+            case ASTNodeKind.TypeTemplate:
+            {
+                (string name, PrivacyType privacy, List<AttributeNode> attributes) =
+                    ReadDefinition();
+                var scope = ReadNode<ScopeNode>();
+                bool isUnion = _reader.ReadBoolean();
+                node = new TypeTemplateNode(
+                    name,
+                    privacy,
+                    ReadList<TemplateParameterNode>(),
+                    scope,
+                    isUnion,
+                    attributes
+                );
+                break;
+            }
+            case ASTNodeKind.Enum:
+            {
+                (string name, PrivacyType privacy, List<AttributeNode> attributes) =
+                    ReadDefinition();
+                node = new EnumNode(
+                    name,
+                    privacy,
+                    ReadList<EnumFlagNode>(),
+                    ReadNode<ScopeNode?>(),
+                    attributes
+                );
+                break;
+            }
+            case ASTNodeKind.EnumFlag:
+                node = new EnumFlagNode(ReadString(), _reader.ReadUInt64());
+                break;
+            case ASTNodeKind.Trait:
+            {
+                (string name, PrivacyType privacy, List<AttributeNode> attributes) =
+                    ReadDefinition();
+                node = new TraitNode(name, privacy, ReadNode<ScopeNode>(), attributes);
+                break;
+            }
+            case ASTNodeKind.Implement:
+                node = new ImplementNode(
+                    ReadNode<TypeRefNode>(),
+                    ReadNode<TypeRefNode>(),
+                    ReadNode<ScopeNode>()
+                );
+                break;
+            case ASTNodeKind.FuncDef:
+            {
+                (string name, PrivacyType privacy, List<AttributeNode> attributes) =
+                    ReadDefinition();
+                node = new FuncDefNode(
+                    name,
+                    privacy,
+                    ReadNode<TypeRefNode>(),
+                    ReadList<ParameterNode>(),
+                    ReadNode<ScopeNode?>(),
+                    _reader.ReadBoolean(),
+                    _reader.ReadBoolean(),
+                    _reader.ReadBoolean(),
+                    attributes
+                );
+                break;
+            }
+            case ASTNodeKind.FieldDef:
+            {
+                (string name, PrivacyType privacy, List<AttributeNode> attributes) =
+                    ReadDefinition();
+                node = new FieldDefNode(name, privacy, ReadNode<TypeRefNode>(), attributes);
+                break;
+            }
+            case ASTNodeKind.GlobalVar:
+            {
+                (string name, PrivacyType privacy, List<AttributeNode> attributes) =
+                    ReadDefinition();
+                node = new GlobalVarNode(
+                    name,
+                    ReadNode<TypeRefNode>(),
+                    privacy,
+                    _reader.ReadBoolean(),
+                    _reader.ReadBoolean(),
+                    attributes
+                );
+                break;
+            }
+            case ASTNodeKind.Parameter:
+                node = new ParameterNode(ReadString(), ReadNode<TypeRefNode>());
+                break;
+            case ASTNodeKind.TemplateParameter:
+                node = new TemplateParameterNode(ReadString());
+                break;
+            case ASTNodeKind.ConstTemplateParameter:
+                node = new ConstTemplateParameterNode(ReadString(), ReadNode<TypeRefNode>());
+                break;
+            case ASTNodeKind.Scope:
+                node = new ScopeNode(ReadList<IStatementNode>());
+                break;
+            case ASTNodeKind.If:
+                node = new IfNode(
+                    ReadNode<IExpressionNode>(),
+                    ReadNode<ScopeNode>(),
+                    ReadNode<ScopeNode?>()
+                );
+                break;
+            case ASTNodeKind.While:
+                node = new WhileNode(ReadNode<IExpressionNode>(), ReadNode<ScopeNode>());
+                break;
+            case ASTNodeKind.TypeRef:
+            {
+                (string name, uint pointerDepth, bool isRef, NamespaceNode? nmspace) =
+                    ReadTypeRef();
+                node = new TypeRefNode(name, pointerDepth, isRef) { Namespace = nmspace };
+                break;
+            }
+            case ASTNodeKind.LocalTypeRef:
+            {
+                (string name, uint pointerDepth, bool isRef, NamespaceNode? nmspace) =
+                    ReadTypeRef();
+                node = new LocalTypeRefNode(name, pointerDepth, isRef) { Namespace = nmspace };
+                break;
+            }
+            case ASTNodeKind.TemplateTypeRef:
+            {
+                (string name, uint pointerDepth, bool isRef, NamespaceNode? nmspace) =
+                    ReadTypeRef();
+                node = new TemplateTypeRefNode(
+                    name,
+                    ReadList<IExpressionNode>(),
+                    pointerDepth,
+                    isRef
+                )
+                {
+                    Namespace = nmspace
+                };
+                break;
+            }
+            case ASTNodeKind.FuncTypeRef:
+            {
+                (_, uint pointerDepth, bool isRef, NamespaceNode? nmspace) = ReadTypeRef();
+                node = new FuncTypeRefNode(
+                    ReadNode<TypeRefNode>(),
+                    ReadList<TypeRefNode>(),
+                    pointerDepth,
+                    isRef
+                )
+                {
+                    Namespace = nmspace
+                };
+                break;
+            }
+            case ASTNodeKind.ArrayTypeRef:
+            {
+                (_, uint pointerDepth, bool isRef, NamespaceNode? nmspace) = ReadTypeRef();
+                node = new ArrayTypeRefNode(ReadNode<TypeRefNode>(), pointerDepth, isRef)
+                {
+                    Namespace = nmspace
+                };
+                break;
+            }
+            case ASTNodeKind.ConstSizeArrayTypeRef:
+            {
+                (_, uint pointerDepth, bool isRef, NamespaceNode? nmspace) = ReadTypeRef();
+                node = new ConstSizeArrayTypeRefNode(
+                    ReadNode<TypeRefNode>(),
+                    pointerDepth,
+                    isRef,
+                    _reader.ReadInt64()
+                )
+                {
+                    Namespace = nmspace
+                };
+                break;
+            }
+            case ASTNodeKind.BinaryOperation:
+            {
+                var type = (OperationType)_reader.ReadByte();
+                node = new BinaryOperationNode(ReadNode<IExpressionNode>(), type)
+                {
+                    Right = ReadNode<IExpressionNode>()
+                };
+                break;
+            }
+            case ASTNodeKind.Cast:
+                node = new CastNode(ReadNode<TypeRefNode>(), ReadNode<SubExprNode>());
+                break;
+            case ASTNodeKind.DeRef:
+                node = new DeRefNode(ReadNode<IExpressionNode>());
+                break;
+            case ASTNodeKind.FuncCall:
+                node = new FuncCallNode(
+                    ReadString(),
+                    ReadList<IExpressionNode>(),
+                    ReadNode<IExpressionNode?>()
+                );
+                break;
+            case ASTNodeKind.IndexAccess:
+                node = new IndexAccessNode(
+                    ReadNode<IExpressionNode>(),
+                    ReadList<IExpressionNode>()
+                );
+                break;
+            case ASTNodeKind.LocalDef:
+                node = new LocalDefNode(ReadString(), ReadNode<TypeRefNode>());
+                break;
+            case ASTNodeKind.InferredLocalDef:
+                node = new InferredLocalDefNode(ReadString(), ReadNode<IExpressionNode>());
+                break;
+            case ASTNodeKind.LocalFuncDef:
+                node = new LocalFuncDefNode(
+                    ReadNode<TypeRefNode>(),
+                    ReadList<ParameterNode>(),
+                    ReadNode<ScopeNode>()
+                );
+                break;
+            case ASTNodeKind.InlineIf:
+                node = new InlineIfNode(
+                    ReadNode<IExpressionNode>(),
+                    ReadNode<IExpressionNode>(),
+                    ReadNode<IExpressionNode>()
+                );
+                break;
+            case ASTNodeKind.LiteralArray:
+                node = new LiteralArrayNode(
+                    ReadNode<TypeRefNode>(),
+                    ReadList<IExpressionNode>().ToArray()
+                );
+                break;
+            case ASTNodeKind.Literal:
+                node = ReadLiteral();
+                break;
+            case ASTNodeKind.Ref:
+                node = new RefNode(ReadString(), ReadNode<IExpressionNode?>());
+                break;
+            case ASTNodeKind.Self:
+                node = new SelfNode();
+                break;
+            case ASTNodeKind.Return:
+                node = new ReturnNode(ReadNode<IExpressionNode?>());
+                break;
+            case ASTNodeKind.SubExpr:
+                node = new SubExprNode(ReadNode<IExpressionNode>());
+                break;
+            case ASTNodeKind.RefOf:
+                node = new RefOfNode(ReadNode<IExpressionNode>());
+                break;
+            case ASTNodeKind.Inverse:
+                node = new InverseNode(ReadNode<IExpressionNode>());
+                break;
+            case ASTNodeKind.IncrementVar:
+                node = new IncrementVarNode(ReadNode<IExpressionNode>());
+                break;
+            case ASTNodeKind.DecrementVar:
+                node = new DecrementVarNode(ReadNode<IExpressionNode>());
+                break;
+            default:
+                throw new Exception($"Invalid AST node kind {kind}.");
+        }
+
+        node.Span = ReadSpan();
+        return node;
+    }
+
+    private (string, PrivacyType, List<AttributeNode>) ReadDefinition()
+    {
+        return (ReadString(), (PrivacyType)_reader.ReadByte(), ReadList<AttributeNode>());
+    }
+
+    private (string, uint, bool, NamespaceNode?) ReadTypeRef()
+    {
+        return (
+            ReadString(),
+            (uint)_reader.Read7BitEncodedInt(),
+            _reader.ReadBoolean(),
+            ReadNode<NamespaceNode?>()
+        );
+    }
+
+    private LiteralNode ReadLiteral()
+    {
+        var kind = (LiteralKind)_reader.ReadByte();
+
+        return kind switch
+        {
+            LiteralKind.Null => new LiteralNode(null),
+            LiteralKind.Bool => new LiteralNode(_reader.ReadBoolean()),
+            LiteralKind.Int => new LiteralNode(_reader.ReadInt32()),
+            LiteralKind.Float => new LiteralNode(_reader.ReadSingle()),
+            LiteralKind.String => new LiteralNode(ReadString()),
+            LiteralKind.Char => new LiteralNode((char)_reader.ReadUInt16()),
+            LiteralKind.EscapedString => new LiteralNode(ReadString().AsMemory(), false),
+            LiteralKind.EscapedChar => new LiteralNode(ReadString().AsMemory(), true),
+            _ => throw new Exception($"Invalid literal kind {kind}.")
+        };
+    }
+
+    private List<T> ReadList<T>()
+        where T : IASTNode
+    {
+        int count = _reader.Read7BitEncodedInt();
+        var nodes = new List<T>(count);
+
+        for (int i = 0; i < count; i++)
+        {
+            nodes.Add(ReadNode<T>());
+        }
+
+        return nodes;
+    }
+
+    private SourceSpan ReadSpan() =>
+        new SourceSpan(_reader.Read7BitEncodedInt(), _reader.Read7BitEncodedInt());
+
+    private string? ReadString()
+    {
+        int index = _reader.Read7BitEncodedInt();
+        return index == 0 ? null : _strings[index - 1];
+    }
+}
@@ -21,13 +21,21 @@ public static class ASTGenerator
             @namespace = ProcessNamespace(context);
 
             if (context.Current?.Type != TokenType.Semicolon)
-                throw new UnexpectedTokenException(context.Current.Value, TokenType.Semicolon);
+                throw new UnexpectedTokenException(
+                    context.Current.Value,
+                    context.Source,
+                    TokenType.Semicolon
+                );
 
             context.MoveNext();
         }
         else
         {
-            throw new UnexpectedTokenException(context.Current.Value, TokenType.Namespace);
+            throw new UnexpectedTokenException(
+                context.Current.Value,
+                context.Source,
+                TokenType.Namespace
+            );
         }
 
         var attributes = new List<AttributeNode>();
@@ -36,11 +44,16 @@ public static class ASTGenerator
         {
             if (context.Current?.Type == TokenType.Import)
             {
+                int start = context.Position;
                 context.MoveNext();
-                contents.Add(new ImportNode(ProcessNamespace(context)));
+                contents.Add(Spanned(context, start, new ImportNode(ProcessNamespace(context))));
 
                 if (context.Current?.Type != TokenType.Semicolon)
-                    throw new UnexpectedTokenException(context.Current.Value, TokenType.Semicolon);
+                    throw new UnexpectedTokenException(
+                        context.Current.Value,
+                        context.Source,
+                        TokenType.Semicolon
+                    );
 
                 context.MoveNext();
             }
@@ -50,6 +63,8 @@ public static class ASTGenerator
 
         while (context.Current != null)
         {
+            int start = context.Position;
+
             switch (context.Current?.Type)
             {
                 case TokenType.BlockComment:
@@ -59,6 +74,9 @@ public static class ASTGenerator
                             context.Current.Value.Text.ToString(),
                             context.Current?.Type == TokenType.BlockComment
                         )
+                        {
+                            Span = context.Current.Value.Span
+                        }
                     );
                     context.MoveNext();
                     break;
@@ -75,7 +93,11 @@ public static class ASTGenerator
                         );
 
                     if (context.Current?.Type != TokenType.For)
-                        throw new UnexpectedTokenException(context.Current.Value, TokenType.For);
+                        throw new UnexpectedTokenException(
+                            context.Current.Value,
+                            context.Source,
+                            TokenType.For
+                        );
 
                     context.MoveNext();
                     var type = ProcessTypeRef(context);
@@ -110,7 +132,7 @@ public static class ASTGenerator
                             throw new Exception($"{error} cannot be unimplemented.");
                     }
 
-                    contents.Add(new ImplementNode(type, trait, scope));
+                    contents.Add(Spanned(context, start, new ImplementNode(type, trait, scope)));
                     break;
                 default:
                     var result = ProcessDefinition(context, attributes);
@@ -120,7 +142,11 @@ public static class ASTGenerator
             }
         }
 
-        return new ScriptAST(@namespace, contents);
+        return new ScriptAST(@namespace, contents)
+        {
+            Span = context.SpanFrom(0),
+            Source = context.Source
+        };
     }
 
     public static NamespaceNode ProcessNamespace(ParseContext context)
@@ -130,7 +156,7 @@ public static class ASTGenerator
 
         if (context.Current?.Type == TokenType.Root)
         {
-            nmspace = new NamespaceFromRootNode();
+            nmspace = new NamespaceFromRootNode() { Span = context.Current.Value.Span };
             lastNmspace = nmspace;
             context.MoveNext();
         }
@@ -145,14 +171,18 @@ public static class ASTGenerator
                 case TokenType.Name:
                     if (nmspace == null)
                     {
-                        nmspace = new NamespaceNode(context.Current.Value.Text.ToString());
+                        nmspace = new NamespaceNode(context.CurrentName)
+                        {
+                            Span = context.Current.Value.Span
+                        };
                         lastNmspace = nmspace;
                     }
                     else
                     {
-                        lastNmspace.Child = new NamespaceNode(
-                            context.Current.Value.Text.ToString()
-                        );
+                        lastNmspace.Child = new NamespaceNode(context.CurrentName)
+                        {
+                            Span = context.Current.Value.Span
+                        };
                         lastNmspace = lastNmspace.Child;
                     }
 
@@ -163,7 +193,7 @@ public static class ASTGenerator
             }
         }
 
-        throw new UnexpectedTokenException(context.Current.Value);
+        throw new UnexpectedTokenException(context.Current.Value, context.Source);
     }
 
     public static TraitNode ProcessTraitDef(
@@ -174,7 +204,7 @@ public static class ASTGenerator
     {
         if (context.MoveNext()?.Type == TokenType.Name)
         {
-            string name = context.Current.Value.Text.ToString();
+            string name = context.CurrentName;
             context.MoveNext();
 
             if (context.Current?.Type == TokenType.LesserThan)
@@ -232,7 +262,11 @@ public static class ASTGenerator
         }
         else
         {
-            throw new UnexpectedTokenException(context.Current.Value, TokenType.Name);
+            throw new UnexpectedTokenException(
+                context.Current.Value,
+                context.Source,
+                TokenType.Name
+            );
         }
     }
 
@@ -245,7 +279,7 @@ public static class ASTGenerator
     {
         if (context.MoveNext()?.Type == TokenType.Name)
         {
-            string name = context.Current.Value.Text.ToString();
+            string name = context.CurrentName;
             context.MoveNext();
 
             if (context.Current?.Type == TokenType.LesserThan)
@@ -276,13 +310,21 @@ public static class ASTGenerator
                                     )
                                 : throw new UnexpectedTokenException(
                                     context.Current.Value,
+                                    context.Source,
                                     TokenType.OpeningCurlyBraces
                                 )
-                            : throw new UnexpectedTokenException(context.Current.Value);
+                            : throw new UnexpectedTokenException(
+                                context.Current.Value,
+                                context.Source
+                            );
                     }
                 }
 
-                throw new UnexpectedTokenException(context.Current.Value, TokenType.GreaterThan);
+                throw new UnexpectedTokenException(
+                    context.Current.Value,
+                    context.Source,
+                    TokenType.GreaterThan
+                );
             }
             else if (context.Current?.Type == TokenType.Semicolon)
             {
@@ -302,7 +344,11 @@ public static class ASTGenerator
         }
         else
         {
-            throw new UnexpectedTokenException(context.Current.Value, TokenType.Name);
+            throw new UnexpectedTokenException(
+                context.Current.Value,
+                context.Source,
+                TokenType.Name
+            );
         }
     }
 
@@ -310,27 +356,37 @@ public static class ASTGenerator
     {
         if (context.Current?.Type != TokenType.Name)
         {
-            throw new UnexpectedTokenException(context.Current.Value, TokenType.Name);
+            throw new UnexpectedTokenException(
+                context.Current.Value,
+                context.Source,
+                TokenType.Name
+            );
         }
 
-        string name = context.Current.Value.Text.ToString();
+        int start = context.Position;
+        string name = context.CurrentName;
 
         if (context.MoveNext()?.Type != TokenType.TypeRef)
         {
-            return new TemplateParameterNode(name);
+            return Spanned(context, start, new TemplateParameterNode(name));
         }
 
         TypeRefNode typeRef = ProcessTypeRef(context);
-        return new ConstTemplateParameterNode(name, typeRef);
+        return Spanned(context, start, new ConstTemplateParameterNode(name, typeRef));
     }
 
     public static ScopeNode ProcessScope(ParseContext context, bool isClassRoot = false)
     {
+        int start = context.Position;
         var statements = new List<IStatementNode>();
 
         if (context.Current?.Type != TokenType.OpeningCurlyBraces)
         {
-            throw new UnexpectedTokenException(context.Current.Value, TokenType.OpeningCurlyBraces);
+            throw new UnexpectedTokenException(
+                context.Current.Value,
+                context.Source,
+                TokenType.OpeningCurlyBraces
+            );
         }
 
         context.MoveNext();
@@ -345,7 +401,7 @@ public static class ASTGenerator
                 {
                     case TokenType.ClosingCurlyBraces:
                         context.MoveNext();
-                        return new ScopeNode(statements);
+                        return Spanned(context, start, new ScopeNode(statements));
                     case TokenType.BlockComment:
                     case TokenType.Comment:
                         statements.Add(
@@ -353,6 +409,9 @@ public static class ASTGenerator
                                 context.Current.Value.Text.ToString(),
                                 context.Current?.Type == TokenType.BlockComment
                             )
+                            {
+                                Span = context.Current.Value.Span
+                            }
                         );
                         context.MoveNext();
                         break;
@@ -371,6 +430,8 @@ public static class ASTGenerator
         {
             while (context.Current != null)
             {
+                int statementStart = context.Position;
+
                 switch (context.Current?.Type)
                 {
                     case TokenType.BlockComment:
@@ -380,17 +441,27 @@ public static class ASTGenerator
                                 context.Current.Value.Text.ToString(),
                                 context.Current?.Type == TokenType.BlockComment
                             )
+                            {
+                                Span = context.Current.Value.Span
+                            }
                         );
                         context.MoveNext();
                         break;
                     case TokenType.Return:
                         context.MoveNext();
-                        statements.Add(new ReturnNode(ProcessExpression(context, true)));
+                        statements.Add(
+                            Spanned(
+                                context,
+                                statementStart,
+                                new ReturnNode(ProcessExpression(context, true))
+                            )
+                        );
 
                         if (context.Current?.Type != TokenType.ClosingCurlyBraces)
                         {
                             throw new UnexpectedTokenException(
                                 context.Current.Value,
+                                context.Source,
                                 TokenType.ClosingCurlyBraces
                             );
                         }
@@ -398,17 +469,17 @@ public static class ASTGenerator
                         goto case TokenType.ClosingCurlyBraces;
                     case TokenType.ClosingCurlyBraces:
                         context.MoveNext();
-                        return new ScopeNode(statements);
+                        return Spanned(context, start, new ScopeNode(statements));
                     case TokenType.OpeningCurlyBraces:
                         statements.Add(ProcessScope(context));
                         break;
                     case TokenType.If:
                         context.MoveNext();
-                        statements.Add(ProcessIf(context));
+                        statements.Add(Spanned(context, statementStart, ProcessIf(context)));
                         break;
                     case TokenType.While:
                         context.MoveNext();
-                        statements.Add(ProcessWhile(context));
+                        statements.Add(Spanned(context, statementStart, ProcessWhile(context)));
                         break;
                     default:
                         statements.Add(ProcessExpression(context));
@@ -422,6 +493,7 @@ public static class ASTGenerator
                         {
                             throw new UnexpectedTokenException(
                                 context.Current.Value,
+                                context.Source,
                                 TokenType.Semicolon
                             );
                         }
@@ -429,20 +501,25 @@ public static class ASTGenerator
             }
         }
 
-        throw new UnexpectedTokenException(context.Current.Value);
+        throw new UnexpectedTokenException(context.Current.Value, context.Source);
     }
 
     private static IExpressionNode ProcessIncrementDecrement(ParseContext context)
     {
+        int start = context.Position;
         var type = (TokenType)(context.Current?.Type);
 
         context.MoveNext();
 
         var value = ProcessExpression(context);
 
-        return type == TokenType.Increment
-            ? new IncrementVarNode(value)
-            : new DecrementVarNode(value);
+        return Spanned(
+            context,
+            start,
+            type == TokenType.Increment
+                ? (IExpressionNode)new IncrementVarNode(value)
+                : new DecrementVarNode(value)
+        );
     }
 
     public static IStatementNode ProcessWhile(ParseContext context)
@@ -451,7 +528,11 @@ public static class ASTGenerator
 
         if (context.Current?.Type != TokenType.OpeningCurlyBraces)
         {
-            throw new UnexpectedTokenException(context.Current.Value, TokenType.OpeningCurlyBraces);
+            throw new UnexpectedTokenException(
+                context.Current.Value,
+                context.Source,
+                TokenType.OpeningCurlyBraces
+            );
         }
 
         ScopeNode then = ProcessScope(context);
@@ -460,33 +541,48 @@ public static class ASTGenerator
 
     public static AttributeNode ProcessAttribute(ParseContext context)
     {
+        int start = context.Position;
+
         if (context.Current?.Type == TokenType.AttributeMarker)
         {
             if (context.MoveNext()?.Type == TokenType.Name)
             {
-                string name = context.Current.Value.Text.ToString();
+                string name = context.CurrentName;
 
                 if (context.MoveNext()?.Type == TokenType.OpeningParentheses)
                 {
                     context.MoveNext();
-                    return new AttributeNode(
-                        name,
-                        ProcessArgs(context, TokenType.ClosingParentheses)
+                    return Spanned(
+                        context,
+                        start,
+                        new AttributeNode(name, ProcessArgs(context, TokenType.ClosingParentheses))
                     );
                 }
                 else
                 {
-                    return new AttributeNode(name, new List<IExpressionNode>());
+                    return Spanned(
+                        context,
+                        start,
+                        new AttributeNode(name, new List<IExpressionNode>())
+                    );
                 }
             }
             else
             {
-                throw new UnexpectedTokenException(context.Current.Value, TokenType.Name);
+                throw new UnexpectedTokenException(
+                    context.Current.Value,
+                    context.Source,
+                    TokenType.Name
+                );
             }
         }
         else
         {
-            throw new UnexpectedTokenException(context.Current.Value, TokenType.AttributeMarker);
+            throw new UnexpectedTokenException(
+                context.Current.Value,
+                context.Source,
+                TokenType.AttributeMarker
+            );
         }
 
         throw new NotImplementedException();
@@ -497,6 +593,7 @@ public static class ASTGenerator
         List<AttributeNode>? attributes
     )
     {
+        int start = context.Position;
         PrivacyType privacy = PrivacyType.Priv;
         bool isForeign = false;
         bool isStatic = false;
@@ -513,22 +610,22 @@ public static class ASTGenerator
             {
                 case TokenType.Public:
                     if (privacy != PrivacyType.Priv)
-                        throw new UnexpectedTokenException(context.Current.Value);
+                        throw new UnexpectedTokenException(context.Current.Value, context.Source);
                     privacy = PrivacyType.Pub;
                     break;
                 case TokenType.Foreign:
                     if (isForeign)
-                        throw new UnexpectedTokenException(context.Current.Value);
+                        throw new UnexpectedTokenException(context.Current.Value, context.Source);
                     isForeign = true;
                     break;
                 case TokenType.Static:
                     if (isStatic)
-                        throw new UnexpectedTokenException(context.Current.Value);
+                        throw new UnexpectedTokenException(context.Current.Value, context.Source);
                     isStatic = true;
                     break;
                 case TokenType.Union:
                     if (isUnion)
-                        throw new UnexpectedTokenException(context.Current.Value);
+                        throw new UnexpectedTokenException(context.Current.Value, context.Source);
                     isUnion = true;
                     break;
                 default:
@@ -540,24 +637,24 @@ public static class ASTGenerator
 
         if (context.Current?.Type == TokenType.Type)
         {
-            return ProcessTypeDef(context, privacy, isUnion, attributes);
+            return Spanned(context, start, ProcessTypeDef(context, privacy, isUnion, attributes));
         }
         else if (context.Current?.Type == TokenType.Enum)
         {
-            return ProcessEnumDef(context, privacy, attributes);
+            return Spanned(context, start, ProcessEnumDef(context, privacy, attributes));
         }
         else if (context.Current?.Type == TokenType.Trait)
         {
             if (isForeign)
-                throw new UnexpectedTokenException(context.Current.Value);
+                throw new UnexpectedTokenException(context.Current.Value, context.Source);
 
-            return ProcessTraitDef(context, privacy, attributes);
+            return Spanned(context, start, ProcessTraitDef(context, privacy, attributes));
         }
         else if (context.Current?.Type == TokenType.Function)
         {
             if (context.MoveNext()?.Type == TokenType.Name)
             {
-                string name = context.Current.Value.Text.ToString();
+                string name = context.CurrentName;
 
                 if (context.MoveNext()?.Type == TokenType.OpeningParentheses)
                 {
@@ -583,81 +680,110 @@ public static class ASTGenerator
                         scope = ProcessScope(context);
                     }
 
-                    return new FuncDefNode(
-                        name,
-                        privacy,
-                        retTypeRef,
-                        @params,
-                        scope,
-                        isVariadic,
-                        isStatic,
-                        isForeign,
-                        attributes
+                    return Spanned(
+                        context,
+                        start,
+                        new FuncDefNode(
+                            name,
+                            privacy,
+                            retTypeRef,
+                            @params,
+                            scope,
+                            isVariadic,
+                            isStatic,
+                            isForeign,
+                            attributes
+                        )
                     );
                 }
                 else
                 {
                     throw new UnexpectedTokenException(
                         context.Current.Value,
+                        context.Source,
                         TokenType.OpeningParentheses
                     );
                 }
             }
             else
             {
-                throw new UnexpectedTokenException(context.Current.Value, TokenType.Name);
+                throw new UnexpectedTokenException(
+                    context.Current.Value,
+                    context.Source,
+                    TokenType.Name
+                );
             }
         }
         else if (context.Current?.Type == TokenType.Global)
         {
             if (context.MoveNext()?.Type == TokenType.Name)
             {
-                string name = context.Current.Value.Text.ToString();
+                string name = context.CurrentName;
                 context.MoveNext();
                 TypeRefNode typeRef = ProcessTypeRef(context);
 
                 if (context.Current?.Type == TokenType.Semicolon)
                 {
                     context.MoveNext();
-                    return new GlobalVarNode(
-                        name,
-                        typeRef,
-                        privacy,
-                        false /*TODO*/
-                        ,
-                        isForeign,
-                        attributes
+                    return Spanned(
+                        context,
+                        start,
+                        new GlobalVarNode(
+                            name,
+                            typeRef,
+                            privacy,
+                            false /*TODO*/
+                            ,
+                            isForeign,
+                            attributes
+                        )
                     );
                 }
                 else
                 {
-                    throw new UnexpectedTokenException(context.Current.Value, TokenType.Semicolon);
+                    throw new UnexpectedTokenException(
+                        context.Current.Value,
+                        context.Source,
+                        TokenType.Semicolon
+                    );
                 }
             }
             else
             {
-                throw new UnexpectedTokenException(context.Current.Value, TokenType.Name);
+                throw new UnexpectedTokenException(
+                    context.Current.Value,
+                    context.Source,
+                    TokenType.Name
+                );
             }
         }
         else if (context.Current?.Type == TokenType.Name)
         {
-            string name = context.Current.Value.Text.ToString();
+            string name = context.CurrentName;
             context.MoveNext();
             TypeRefNode typeRef = ProcessTypeRef(context);
 
             if (context.Current?.Type == TokenType.Semicolon)
             {
                 context.MoveNext();
-                return new FieldDefNode(name, privacy, typeRef, attributes);
+                return Spanned(
+                    context,
+                    start,
+                    new FieldDefNode(name, privacy, typeRef, attributes)
+                );
             }
             else
             {
-                throw new UnexpectedTokenException(context.Current.Value, TokenType.Semicolon);
+                throw new UnexpectedTokenException(
+                    context.Current.Value,
+                    context.Source,
+                    TokenType.Semicolon
+                );
             }
         }
         else
         {
-            throw new UnexpectedTokenException(context.Current.Value);
+            throw new UnexpectedTokenException(context.Current.Value, context.Source);
         }
     }
 
@@ -668,15 +794,27 @@ public static class ASTGenerator
     )
     {
         if (context.Current?.Type != TokenType.Enum)
-            throw new UnexpectedTokenException(context.Current.Value, TokenType.Enum);
+            throw new UnexpectedTokenException(
+                context.Current.Value,
+                context.Source,
+                TokenType.Enum
+            );
 
         if (context.MoveNext()?.Type != TokenType.Name)
-            throw new UnexpectedTokenException(context.Current.Value, TokenType.Name);
+            throw new UnexpectedTokenException(
+                context.Current.Value,
+                context.Source,
+                TokenType.Name
+            );
 
-        string name = context.Current.Value.Text.ToString();
+        string name = context.CurrentName;
 
         if (context.MoveNext()?.Type != TokenType.OpeningCurlyBraces)
-            throw new UnexpectedTokenException(context.Current.Value, TokenType.OpeningCurlyBraces);
+            throw new UnexpectedTokenException(
+                context.Current.Value,
+                context.Source,
+                TokenType.OpeningCurlyBraces
+            );
 
         var enumFlags = new List<EnumFlagNode>();
         ulong index = 0;
@@ -686,18 +824,23 @@ public static class ASTGenerator
             if (context.MoveNext()?.Type != TokenType.Name)
                 break;
 
-            string entryName = context.Current.Value.Text.ToString();
+            int entryStart = context.Position;
+            string entryName = context.CurrentName;
 
             if (context.MoveNext()?.Type == TokenType.Assign)
                 if (context.MoveNext()?.Type == TokenType.LiteralInt)
                 {
-                    index = UInt64.Parse(context.Current.Value.Text.ToString());
+                    index = UInt64.Parse(ParseNumber(context.Current.Value));
                     context.MoveNext();
                 }
                 else
-                    throw new UnexpectedTokenException(context.Current.Value, TokenType.LiteralInt);
+                    throw new UnexpectedTokenException(
+                        context.Current.Value,
+                        context.Source,
+                        TokenType.LiteralInt
+                    );
 
-            enumFlags.Add(new EnumFlagNode(entryName, index));
+            enumFlags.Add(Spanned(context, entryStart, new EnumFlagNode(entryName, index)));
             index++;
 
             if (context.Current?.Type != TokenType.Comma)
@@ -705,7 +848,11 @@ public static class ASTGenerator
         }
 
         if (context.Current?.Type != TokenType.ClosingCurlyBraces)
-            throw new UnexpectedTokenException(context.Current.Value, TokenType.ClosingCurlyBraces);
+            throw new UnexpectedTokenException(
+                context.Current.Value,
+                context.Source,
+                TokenType.ClosingCurlyBraces
+            );
 
         if (context.MoveNext()?.Type != TokenType.Extend)
             return new EnumNode(name, privacy, enumFlags, null, attributes);
@@ -743,6 +890,7 @@ public static class ASTGenerator
                         {
                             throw new UnexpectedTokenException(
                                 context.Current.Value,
+                                context.Source,
                                 TokenType.ClosingParentheses
                             );
                         }
@@ -756,17 +904,18 @@ public static class ASTGenerator
             }
         }
 
-        throw new UnexpectedTokenException(context.Current.Value);
+        throw new UnexpectedTokenException(context.Current.Value, context.Source);
     }
 
     public static ParameterNode? ProcessParameter(ParseContext context, out bool isVariadic)
     {
+        int start = context.Position;
         string name;
         isVariadic = false;
 
         if (context.Current?.Type == TokenType.Name)
         {
-            name = context.Current.Value.Text.ToString();
+            name = context.CurrentName;
             context.MoveNext();
         }
         else if (context.Current?.Type == TokenType.Variadic)
@@ -777,10 +926,14 @@ public static class ASTGenerator
         }
         else
         {
-            throw new UnexpectedTokenException(context.Current.Value, TokenType.Name);
+            throw new UnexpectedTokenException(
+                context.Current.Value,
+                context.Source,
+                TokenType.Name
+            );
         }
 
-        return new ParameterNode(name, ProcessTypeRef(context));
+        return Spanned(context, start, new ParameterNode(name, ProcessTypeRef(context)));
     }
 
     public static IfNode ProcessIf(ParseContext context)
@@ -789,7 +942,11 @@ public static class ASTGenerator
 
         if (context.Current?.Type != TokenType.OpeningCurlyBraces)
         {
-            throw new UnexpectedTokenException(context.Current.Value, TokenType.OpeningCurlyBraces);
+            throw new UnexpectedTokenException(
+                context.Current.Value,
+                context.Source,
+                TokenType.OpeningCurlyBraces
+            );
         }
 
         ScopeNode then = ProcessScope(context);
@@ -803,12 +960,18 @@ public static class ASTGenerator
         {
             if (context.MoveNext()?.Type == TokenType.If)
             {
+                int start = context.Position;
                 context.MoveNext();
-                return new ScopeNode(
-                    new List<IStatementNode>
-                    {
-                        ProcessIf(context) //TODO: this does not work in compilation
-                    }
+                IfNode @if = Spanned(context, start, ProcessIf(context));
+                return Spanned(
+                    context,
+                    start,
+                    new ScopeNode(
+                        new List<IStatementNode>
+                        {
+                            @if //TODO: this does not work in compilation
+                        }
+                    )
                 );
             }
             else
@@ -843,7 +1006,11 @@ public static class ASTGenerator
             }
             else if (context.Current?.Type != TokenType.Comma)
             {
-                throw new UnexpectedTokenException(context.Current.Value, terminator);
+                throw new UnexpectedTokenException(
+                    context.Current.Value,
+                    context.Source,
+                    terminator
+                );
             }
 
             context.MoveNext();
@@ -854,14 +1021,20 @@ public static class ASTGenerator
 
     public static TypeRefNode ProcessTypeRef(ParseContext context)
     {
+        int start = context.Position;
+
         if (context.Current?.Type == TokenType.TemplateTypeRef)
         {
             if (context.MoveNext()?.Type != TokenType.Name)
             {
-                throw new UnexpectedTokenException(context.Current.Value, TokenType.Name);
+                throw new UnexpectedTokenException(
+                    context.Current.Value,
+                    context.Source,
+                    TokenType.Name
+                );
             }
 
-            string retTypeName = context.Current.Value.Text.ToString();
+            string retTypeName = context.CurrentName;
             uint pointerDepth = 0;
             bool isRef = false;
 
@@ -883,7 +1056,7 @@ public static class ASTGenerator
                 context.MoveNext();
             }
 
-            return new LocalTypeRefNode(retTypeName, pointerDepth, isRef);
+            return Spanned(context, start, new LocalTypeRefNode(retTypeName, pointerDepth, isRef));
         }
         else
         {
@@ -897,11 +1070,15 @@ public static class ASTGenerator
             }
 
             if (context.Current?.Type != TokenType.TypeRef)
-                throw new UnexpectedTokenException(context.Current.Value, TokenType.TypeRef);
+                throw new UnexpectedTokenException(
+                    context.Current.Value,
+                    context.Source,
+                    TokenType.TypeRef
+                );
 
             if (context.MoveNext()?.Type == TokenType.Name)
             {
-                string retTypeName = context.Current.Value.Text.ToString();
+                string retTypeName = context.CurrentName;
                 var genericParams = new List<IExpressionNode>();
                 uint pointerDepth = 0;
                 bool isRef = false;
@@ -925,6 +1102,7 @@ public static class ASTGenerator
                             {
                                 throw new UnexpectedTokenException(
                                     context.Current.Value,
+                                    context.Source,
                                     TokenType.ClosingParentheses
                                 );
                             }
@@ -933,7 +1111,10 @@ public static class ASTGenerator
                         }
                         else
                         {
-                            throw new UnexpectedTokenException(context.Current.Value);
+                            throw new UnexpectedTokenException(
+                                context.Current.Value,
+                                context.Source
+                            );
                         }
 
                         if (context.Current?.Type == TokenType.Comma)
@@ -942,7 +1123,10 @@ public static class ASTGenerator
                         }
                         else if (context.Current?.Type != TokenType.GreaterThan)
                         {
-                            throw new UnexpectedTokenException(context.Current.Value);
+                            throw new UnexpectedTokenException(
+                                context.Current.Value,
+                                context.Source
+                            );
                         }
                     }
 
@@ -971,7 +1155,7 @@ public static class ASTGenerator
                         : new TypeRefNode(retTypeName, pointerDepth, isRef);
                 if (b)
                     retVal.Namespace = nmspace;
-                return retVal;
+                return Spanned(context, start, retVal);
             }
             else if (!b && context.Current?.Type == TokenType.OpeningParentheses)
             {
@@ -992,6 +1176,7 @@ public static class ASTGenerator
                     {
                         throw new UnexpectedTokenException(
                             context.Current.Value,
+                            context.Source,
                             TokenType.ClosingParentheses
                         );
                     }
@@ -1018,11 +1203,19 @@ public static class ASTGenerator
                 if (context.Current?.Type == TokenType.TypeRef)
                 {
                     retType = ProcessTypeRef(context);
-                    return new FuncTypeRefNode(retType, @params, pointerDepth, isRef);
+                    return Spanned(
+                        context,
+                        start,
+                        new FuncTypeRefNode(retType, @params, pointerDepth, isRef)
+                    );
                 }
                 else
                 {
-                    throw new UnexpectedTokenException(context.Current.Value, TokenType.TypeRef);
+                    throw new UnexpectedTokenException(
+                        context.Current.Value,
+                        context.Source,
+                        TokenType.TypeRef
+                    );
                 }
             }
             else if (!b && context.Current?.Type == TokenType.OpeningSquareBrackets)
@@ -1032,7 +1225,7 @@ public static class ASTGenerator
 
                 if (!(context.MoveNext()?.Type is TokenType.TypeRef or TokenType.TemplateTypeRef))
                 {
-                    throw new UnexpectedTokenException(context.Current.Value);
+                    throw new UnexpectedTokenException(context.Current.Value, context.Source);
                 }
 
                 var elementType = ProcessTypeRef(context);
@@ -1041,6 +1234,7 @@ public static class ASTGenerator
                 {
                     throw new UnexpectedTokenException(
                         context.Current.Value,
+                        context.Source,
                         TokenType.ClosingSquareBrackets
                     );
                 }
@@ -1063,11 +1257,19 @@ public static class ASTGenerator
                     context.MoveNext();
                 }
 
-                return new ArrayTypeRefNode(elementType, pointerDepth, isRef);
+                return Spanned(
+                    context,
+                    start,
+                    new ArrayTypeRefNode(elementType, pointerDepth, isRef)
+                );
             }
             else
             {
-                throw new UnexpectedTokenException(context.Current.Value, TokenType.Name);
+                throw new UnexpectedTokenException(
+                    context.Current.Value,
+                    context.Source,
+                    TokenType.Name
+                );
             }
         }
     }
@@ -1078,6 +1280,10 @@ public static class ASTGenerator
 
         while (context.Current != null)
         {
+            int start = context.Position;
+            int depth = stack.Count;
+            SourceSpan operand = depth > 0 ? stack.Peek().Span : default;
+
             switch (context.Current?.Type)
             {
                 case TokenType.OpeningParentheses:
@@ -1089,6 +1295,7 @@ public static class ASTGenerator
                     {
                         throw new UnexpectedTokenException(
                             context.Current.Value,
+                            context.Source,
                             TokenType.ClosingParentheses
                         );
                     }
@@ -1110,7 +1317,7 @@ public static class ASTGenerator
                 {
                     if (stack.Count == 0)
                     {
-                        throw new UnexpectedTokenException(context.Current.Value);
+                        throw new UnexpectedTokenException(context.Current.Value, context.Source);
                     }
 
                     if (stack.Peek() is TypeRefNode typeRef)
@@ -1132,19 +1339,19 @@ public static class ASTGenerator
                     break;
                 }
                 case TokenType.LiteralFloat:
-                    stack.Push(new LiteralNode(float.Parse(context.Current.Value.Text.Span)));
+                    stack.Push(new LiteralNode(float.Parse(ParseNumber(context.Current.Value))));
                     context.MoveNext();
                     break;
                 case TokenType.LiteralInt:
-                    stack.Push(new LiteralNode(int.Parse(context.Current.Value.Text.Span)));
+                    stack.Push(new LiteralNode(int.Parse(ParseNumber(context.Current.Value))));
                     context.MoveNext();
                     break;
                 case TokenType.LiteralString:
-                    stack.Push(new LiteralNode(context.Current.Value.Text.ToString()));
+                    stack.Push(new LiteralNode(context.Current.Value.Text, false));
                     context.MoveNext();
                     break;
                 case TokenType.LiteralChar:
-                    stack.Push(new LiteralNode(context.Current.Value.Text.ToString()[0]));
+                    stack.Push(new LiteralNode(context.Current.Value.Text, true));
                     context.MoveNext();
                     break;
                 case TokenType.True:
@@ -1175,9 +1382,12 @@ public static class ASTGenerator
 
                         if (isVariadic)
                         {
+                            var error = new UnexpectedTokenException(
+                                context.Previous().Value,
+                                context.Source
+                            );
                             throw new Exception(
-                                $"{new UnexpectedTokenException(context.Previous().Value).Message}"
-                                    + $"\nCannot have a variadic locally-defined function."
+                                $"{error.Message}\nCannot have a variadic locally-defined function."
                             );
                         }
 
@@ -1190,6 +1400,7 @@ public static class ASTGenerator
                         {
                             throw new UnexpectedTokenException(
                                 context.Current.Value,
+                                context.Source,
                                 TokenType.OpeningCurlyBraces
                             );
                         }
@@ -1198,6 +1409,7 @@ public static class ASTGenerator
                     {
                         throw new UnexpectedTokenException(
                             context.Current.Value,
+                            context.Source,
                             TokenType.OpeningParentheses
                         );
                     }
@@ -1222,11 +1434,11 @@ public static class ASTGenerator
                     break;
                 case TokenType.Period:
                     if (stack.Count == 0)
-                        throw new UnexpectedTokenException(context.Current.Value);
+                        throw new UnexpectedTokenException(context.Current.Value, context.Source);
 
                     if (context.MoveNext()?.Type == TokenType.Name)
                     {
-                        string name = context.Current.Value.Text.ToString();
+                        string name = context.CurrentName;
 
                         if (context.MoveNext()?.Type == TokenType.OpeningParentheses)
                         {
@@ -1248,12 +1460,16 @@ public static class ASTGenerator
                     }
                     else
                     {
-                        throw new UnexpectedTokenException(context.Current.Value, TokenType.Name);
+                        throw new UnexpectedTokenException(
+                            context.Current.Value,
+                            context.Source,
+                            TokenType.Name
+                        );
                     }
                 case TokenType.Local:
                     if (context.MoveNext()?.Type == TokenType.Name)
                     {
-                        string name = context.Current.Value.Text.ToString();
+                        string name = context.CurrentName;
 
                         if (context.MoveNext()?.Type == TokenType.Assign)
                         {
@@ -1268,7 +1484,11 @@ public static class ASTGenerator
                     }
                     else
                     {
-                        throw new UnexpectedTokenException(context.Current.Value, TokenType.Name);
+                        throw new UnexpectedTokenException(
+                            context.Current.Value,
+                            context.Source,
+                            TokenType.Name
+                        );
                     }
 
                     break;
@@ -1278,7 +1498,11 @@ public static class ASTGenerator
 
                     if (context.Current?.Type != TokenType.Then)
                     {
-                        throw new UnexpectedTokenException(context.Current.Value, TokenType.Then);
+                        throw new UnexpectedTokenException(
+                            context.Current.Value,
+                            context.Source,
+                            TokenType.Then
+                        );
                     }
 
                     context.MoveNext();
@@ -1286,7 +1510,11 @@ public static class ASTGenerator
 
                     if (context.Current?.Type != TokenType.Else)
                     {
-                        throw new UnexpectedTokenException(context.Current.Value, TokenType.Else);
+                        throw new UnexpectedTokenException(
+                            context.Current.Value,
+                            context.Source,
+                            TokenType.Else
+                        );
                     }
 
                     context.MoveNext();
@@ -1342,7 +1570,7 @@ public static class ASTGenerator
 
                     if (stack.Count == 0)
                     {
-                        throw new UnexpectedTokenException(context.Current.Value);
+                        throw new UnexpectedTokenException(context.Current.Value, context.Source);
                     }
 
                     var contestedExpr = stack.Pop();
@@ -1389,7 +1617,7 @@ public static class ASTGenerator
 
                     if (stack.Count == 0)
                     {
-                        throw new UnexpectedTokenException(context.Current.Value);
+                        throw new UnexpectedTokenException(context.Current.Value, context.Source);
                     }
 
                     var newNode = new BinaryOperationNode(stack.Peek(), OperationType.Assignment);
@@ -1410,7 +1638,7 @@ public static class ASTGenerator
                 //     break;
                 case TokenType.Not:
                     if (stack.Count > 0 && stack.Peek() is not BinaryOperationNode)
-                        throw new UnexpectedTokenException(context.Current.Value);
+                        throw new UnexpectedTokenException(context.Current.Value, context.Source);
 
                     context.MoveNext();
                     stack.Push(new InverseNode(ProcessExpression(context)));
@@ -1418,20 +1646,20 @@ public static class ASTGenerator
                 case TokenType.Increment:
                 case TokenType.Decrement:
                     if (stack.Count > 0 && stack.Peek() is not BinaryOperationNode)
-                        throw new UnexpectedTokenException(context.Current.Value);
+                        throw new UnexpectedTokenException(context.Current.Value, context.Source);
 
                     stack.Push(ProcessIncrementDecrement(context));
                     break;
                 case TokenType.TemplateTypeRef:
                 case TokenType.TypeRef:
                     if (stack.Count > 0 && stack.Peek() is not BinaryOperationNode)
-                        throw new UnexpectedTokenException(context.Current.Value);
+                        throw new UnexpectedTokenException(context.Current.Value, context.Source);
 
                     stack.Push(ProcessTypeRef(context));
                     break;
                 case TokenType.Name:
                 {
-                    string name = context.Current.Value.Text.ToString();
+                    string name = context.CurrentName;
 
                     if (context.MoveNext()?.Type == TokenType.OpeningParentheses)
                     {
@@ -1453,7 +1681,7 @@ public static class ASTGenerator
                 }
                 case TokenType.This:
                     if (stack.Count > 0 && stack.Peek() is not BinaryOperationNode)
-                        throw new UnexpectedTokenException(context.Current.Value);
+                        throw new UnexpectedTokenException(context.Current.Value, context.Source);
 
                     stack.Push(new SelfNode());
                     context.MoveNext();
@@ -1478,11 +1706,34 @@ public static class ASTGenerator
                         }
                     }
 
+                    SpanOperations(stack.Last());
                     return stack.Last();
             }
+
+            // operations are spanned once their operands are known, postfix nodes that replaced the
+            // top of the stack also cover the operand they consumed
+            if (
+                stack.Count > 0
+                && stack.Peek() is not BinaryOperationNode
+                && stack.Peek().Span.IsEmpty
+            )
+            {
+                SourceSpan span = context.SpanFrom(start);
+                stack.Peek().Span = stack.Count == depth ? operand.Union(span) : span;
+            }
         }
 
-        throw new UnexpectedTokenException(context.Current.Value);
+        throw new UnexpectedTokenException(context.Current.Value, context.Source);
+    }
+
+    private static void SpanOperations(IExpressionNode? node)
+    {
+        if (node is BinaryOperationNode binOp && binOp.Span.IsEmpty)
+        {
+            SpanOperations(binOp.Left);
+            SpanOperations(binOp.Right);
+            binOp.Span = binOp.Left.Span.Union(binOp.Right?.Span ?? default);
+        }
     }
 
     private static OperationType TokenToOpType(ParseContext context, TokenType? type)
@@ -1510,7 +1761,7 @@ public static class ASTGenerator
             TokenType.DivAssign => OperationType.Division,
             TokenType.ModAssign => OperationType.Modulus,
             TokenType.ExpAssign => OperationType.Exponential,
-            _ => throw new UnexpectedTokenException(context.Current.Value)
+            _ => throw new UnexpectedTokenException(context.Current.Value, context.Source)
         };
     }
 
@@ -1525,6 +1776,7 @@ public static class ASTGenerator
         {
             throw new UnexpectedTokenException(
                 context.Current.Value,
+                context.Source,
                 TokenType.OpeningSquareBrackets
             );
         }
@@ -1552,6 +1804,7 @@ public static class ASTGenerator
         {
             throw new UnexpectedTokenException(
                 context.Current.Value,
+                context.Source,
                 TokenType.ClosingSquareBrackets
             );
         }
@@ -1560,6 +1813,21 @@ public static class ASTGenerator
         return new LiteralArrayNode(elementType, elements.ToArray());
     }
 
+    private static T Spanned<T>(ParseContext context, int start, T node)
+        where T : IASTNode
+    {
+        node.Span = context.SpanFrom(start);
+        return node;
+    }
+
+    private static ReadOnlySpan<char> ParseNumber(Token token)
+    {
+        ReadOnlySpan<char> text = token.Text.Span;
+
+        // digit separators are kept in the token text
+        return text.Contains('_') ? text.ToString().Replace("_", "") : text;
+    }
+
     private static int GetOpPriority(OperationType operationType)
     {
         return operationType switch
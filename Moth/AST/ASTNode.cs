@@ -1,6 +1,11 @@
-﻿namespace Moth.AST;
+﻿using Moth.Tokens;
+
+namespace Moth.AST;
 
 public interface IASTNode
 {
+    // The tokens this node was parsed from, empty for nodes that were synthesized.
+    SourceSpan Span { get; set; }
+
     string GetSource();
 }
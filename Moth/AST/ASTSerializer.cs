@@ -0,0 +1,443 @@
+using Moth.AST.Node;
+using Moth.Tokens;
+
+namespace Moth.AST;
+
+// Writes a ScriptAST in a compact binary form that ASTDeserializer reads back. Strings are written
+// once to a table in front of the nodes, which refer to them by index.
+public class ASTSerializer
+{
+    // Bump this whenever the encoding or the node classes change.
+    public const int FormatVersion = 1;
+
+    private readonly MemoryStream _nodes = new MemoryStream();
+    private readonly BinaryWriter _writer;
+    private readonly List<string> _strings = new List<string>();
+    private readonly Dictionary<string, int> _stringIndexes = new Dictionary<string, int>();
+
+    public ASTSerializer()
+    {
+        _writer = new BinaryWriter(_nodes);
+    }
+
+    public void Process(Stream output, ScriptAST script)
+    {
+        WriteSpan(script.Span);
+        WriteNode(script.Namespace);
+        WriteList(script.Contents);
+        _writer.Flush();
+
+        using (var writer = new BinaryWriter(output, Encoding.UTF8, true))
+        {
+            writer.Write7BitEncodedInt(_strings.Count);
+
+            foreach (string str in _strings)
+            {
+                writer.Write(str);
+            }
+        }
+
+        _nodes.WriteTo(output);
+    }
+
+    private void WriteNode(IASTNode? node)
+    {
+        switch (node)
+        {
+            case null:
+                WriteKind(ASTNodeKind.Null);
+                return;
+            case NamespaceFromRootNode nmspace:
+                WriteKind(ASTNodeKind.NamespaceFromRoot);
+                WriteNode(nmspace.Child);
+                break;
+            case NamespaceNode nmspace:
+                WriteKind(ASTNodeKind.Namespace);
+                WriteString(nmspace.Name);
+                WriteNode(nmspace.Child);
+                break;
+            case ImportNode import:
+                WriteKind(ASTNodeKind.Import);
+                WriteNode(import.Namespace);
+                break;
+            case CommentNode comment:
+                WriteKind(ASTNodeKind.Comment);
+                WriteString(comment.Text);
+                _writer.Write(comment.IsBlock);
+                break;
+            case AttributeNode attribute:
+                WriteKind(ASTNodeKind.Attribute);
+                WriteString(attribute.Name);
+                WriteList(attribute.Arguments);
+                break;
+            case TypeTemplateNode typeTemplate:
+                WriteKind(ASTNodeKind.TypeTemplate);
+                WriteDefinition(typeTemplate);
+                WriteNode(typeTemplate.Scope);
+                _writer.Write(typeTemplate.IsUnion);
+                WriteList(typeTemplate.Params);
+                break;
+            case TypeNode type:
+                WriteKind(ASTNodeKind.Type);
+                WriteDefinition(type);
+                WriteNode(type.Scope);
+                _writer.Write(type.IsUnion);
+                break;
+            case EnumNode @enum:
+                WriteKind(ASTNodeKind.Enum);
+                WriteDefinition(@enum);
+                WriteList(@enum.EnumFlags);
+                WriteNode(@enum.Scope);
+                break;
+            case EnumFlagNode enumFlag:
+                WriteKind(ASTNodeKind.EnumFlag);
+                WriteString(enumFlag.Name);
+                _writer.Write(enumFlag.Value);
+                break;
+            case TraitNode trait:
+                WriteKind(ASTNodeKind.Trait);
+                WriteDefinition(trait);
+                WriteNode(trait.Scope);
+                break;
+            case ImplementNode implement:
+                WriteKind(ASTNodeKind.Implement);
+                WriteNode(implement.Type);
+                WriteNode(implement.Trait);
+                WriteNode(implement.Implementations);
+                break;
+            case FuncDefNode funcDef:
+                WriteKind(ASTNodeKind.FuncDef);
+                WriteDefinition(funcDef);
+                WriteNode(funcDef.ReturnTypeRef);
+                WriteList(funcDef.Params);
+                WriteNode(funcDef.ExecutionBlock);
+                _writer.Write(funcDef.IsVariadic);
+                _writer.Write(funcDef.IsStatic);
+                _writer.Write(funcDef.IsForeign);
+                break;
+            case FieldDefNode fieldDef:
+                WriteKind(ASTNodeKind.FieldDef);
+                WriteDefinition(fieldDef);
+                WriteNode(fieldDef.TypeRef);
+                break;
+            case GlobalVarNode globalVar:
+                WriteKind(ASTNodeKind.GlobalVar);
+                WriteDefinition(globalVar);
+                WriteNode(globalVar.TypeRef);
+                _writer.Write(globalVar.IsConstant);
+                _writer.Write(globalVar.IsForeign);
+                break;
+            case ParameterNode param:
+                WriteKind(ASTNodeKind.Parameter);
+                WriteString(param.Name);
+                WriteNode(param.TypeRef);
+                break;
+            case ConstTemplateParameterNode constParam:
+                WriteKind(ASTNodeKind.ConstTemplateParameter);
+                WriteString(constParam.Name);
+                WriteNode(constParam.TypeRef);
+                break;
+            case TemplateParameterNode templateParam:
+                WriteKind(ASTNodeKind.TemplateParameter);
+                WriteString(templateParam.Name);
+                break;
+            case ScopeNode scope:
+                WriteKind(ASTNodeKind.Scope);
+                WriteList(scope.Statements);
+                break;
+            case IfNode @if:
+                WriteKind(ASTNodeKind.If);
+                WriteNode(@if.Condition);
+                WriteNode(@if.Then);
+                WriteNode(@if.Else);
+                break;
+            case WhileNode @while:
+                WriteKind(ASTNodeKind.While);
+                WriteNode(@while.Condition);
+                WriteNode(@while.Then);
+                break;
+            case ConstSizeArrayTypeRefNode constSizeArray:
+                WriteKind(ASTNodeKind.ConstSizeArrayTypeRef);
+                WriteTypeRef(constSizeArray);
+                WriteNode(constSizeArray.ElementType);
+                _writer.Write(constSizeArray.Size);
+                break;
+            case ArrayTypeRefNode array:
+                WriteKind(ASTNodeKind.ArrayTypeRef);
+                WriteTypeRef(array);
+                WriteNode(array.ElementType);
+                break;
+            case FuncTypeRefNode funcType:
+                WriteKind(ASTNodeKind.FuncTypeRef);
+                WriteTypeRef(funcType);
+                WriteNode(funcType.ReturnType);
+                WriteList(funcType.ParameterTypes);
+                break;
+            case LocalTypeRefNode localType:
+                WriteKind(ASTNodeKind.LocalTypeRef);
+                WriteTypeRef(localType);
+                break;
+            case TemplateTypeRefNode templateType:
+                WriteKind(ASTNodeKind.TemplateTypeRef);
+                WriteTypeRef(templateType);
+                WriteList(templateType.Arguments);
+                break;
+            case TypeRefNode typeRef:
+                WriteKind(ASTNodeKind.TypeRef);
+                WriteTypeRef(typeRef);
+                break;
+            case BinaryOperationNode binOp:
+                WriteKind(ASTNodeKind.BinaryOperation);
+                _writer.Write((byte)binOp.Type);
+                WriteNode(binOp.Left);
+                WriteNode(binOp.Right);
+                break;
+            case CastNode cast:
+                WriteKind(ASTNodeKind.Cast);
+                WriteNode(cast.NewType);
+                WriteNode(cast.Value);
+                break;
+            case DeRefNode deRef:
+                WriteKind(ASTNodeKind.DeRef);
+                WriteNode(deRef.Value);
+                break;
+            case FuncCallNode funcCall:
+                WriteKind(ASTNodeKind.FuncCall);
+                WriteString(funcCall.Name);
+                WriteList(funcCall.Arguments);
+                WriteNode(funcCall.ToCallOn);
+                break;
+            case IndexAccessNode indexAccess:
+                WriteKind(ASTNodeKind.IndexAccess);
+                WriteNode(indexAccess.ToBeIndexed);
+                WriteList(indexAccess.Arguments);
+                break;
+            case InferredLocalDefNode inferredLocal:
+                WriteKind(ASTNodeKind.InferredLocalDef);
+                WriteString(inferredLocal.Name);
+                WriteNode(inferredLocal.Value);
+                break;
+            case LocalDefNode local:
+                WriteKind(ASTNodeKind.LocalDef);
+                WriteString(local.Name);
+                WriteNode(local.TypeRef);
+                break;
+            case LocalFuncDefNode localFunc:
+                WriteKind(ASTNodeKind.LocalFuncDef);
+                WriteNode(localFunc.ReturnTypeRef);
+                WriteList(localFunc.Params);
+                WriteNode(localFunc.ExecutionBlock);
+                break;
+            case InlineIfNode inlineIf:
+                WriteKind(ASTNodeKind.InlineIf);
+                WriteNode(inlineIf.Condition);
+                WriteNode(inlineIf.Then);
+                WriteNode(inlineIf.Else);
+                break;
+            case LiteralArrayNode literalArray:
+                WriteKind(ASTNodeKind.LiteralArray);
+                WriteNode(literalArray.ElementType);
+                WriteList(literalArray.Elements);
+                break;
+            case LiteralNode literal:
+                WriteKind(ASTNodeKind.Literal);
+                WriteLiteral(literal);
+                break;
+            case RefNode @ref:
+                WriteKind(ASTNodeKind.Ref);
+                WriteString(@ref.Name);
+                WriteNode(@ref.Parent);
+                break;
+            case SelfNode:
+                WriteKind(ASTNodeKind.Self);
+                break;
+            case ReturnNode @return:
+                WriteKind(ASTNodeKind.Return);
+                WriteNode(@return.Expression);
+                break;
+            case SubExprNode subExpr:
+                WriteKind(ASTNodeKind.SubExpr);
+                WriteNode(subExpr.Expression);
+                break;
+            case RefOfNode refOf:
+                WriteKind(ASTNodeKind.RefOf);
+                WriteNode(refOf.Expression);
+                break;
+            case InverseNode inverse:
+                WriteKind(ASTNodeKind.Inverse);
+                WriteNode(inverse.Expression);
+                break;
+            case IncrementVarNode increment:
+                WriteKind(ASTNodeKind.IncrementVar);
+                WriteNode(increment.Expression);
+                break;
+            case DecrementVarNode decrement:
+                WriteKind(ASTNodeKind.DecrementVar);
+                WriteNode(decrement.Expression);
+                break;
+            default:
+                throw new NotImplementedException(
+                    $"Cannot serialize node of type {node.GetType().Name}."
+                );
+        }
+
+        WriteSpan(node.Span);
+    }
+
+    private void WriteDefinition(DefinitionNode definition)
+    {
+        WriteString(definition.Name);
+        _writer.Write((byte)definition.Privacy);
+        WriteList(definition.Attributes);
+    }
+
+    private void WriteTypeRef(TypeRefNode typeRef)
+    {
+        WriteString(typeRef.Name);
+        _writer.Write7BitEncodedInt((int)typeRef.PointerDepth);
+        _writer.Write(typeRef.IsRef);
+        WriteNode(typeRef.Namespace);
+    }
+
+    private void WriteLiteral(LiteralNode literal)
+    {
+        if (literal.IsEscaped)
+        {
+            var kind = literal.IsChar ? LiteralKind.EscapedChar : LiteralKind.EscapedString;
+            _writer.Write((byte)kind);
+            WriteString(literal.EscapedText.ToString());
+            return;
+        }
+
+        switch (literal.Value)
+        {
+            case null:
+                _writer.Write((byte)LiteralKind.Null);
+                break;
+            case bool b:
+                _writer.Write((byte)LiteralKind.Bool);
+                _writer.Write(b);
+                break;
+            case int i:
+                _writer.Write((byte)LiteralKind.Int);
+                _writer.Write(i);
+                break;
+            case float f:
+                _writer.Write((byte)LiteralKind.Float);
+                _writer.Write(f);
+                break;
+            case string str:
+                _writer.Write((byte)LiteralKind.String);
+                WriteString(str);
+                break;
+            case char ch:
+                _writer.Write((byte)LiteralKind.Char);
+                _writer.Write((ushort)ch);
+                break;
+            default:
+                throw new NotImplementedException(
+                    $"Cannot serialize literal of type {literal.Value.GetType().Name}."
+                );
+        }
+    }
+
+    private void WriteList<T>(IReadOnlyCollection<T> nodes)
+        where T : IASTNode
+    {
+        _writer.Write7BitEncodedInt(nodes.Count);
+
+        foreach (T node in nodes)
+        {
+            WriteNode(node);
+        }
+    }
+
+    private void WriteKind(ASTNodeKind kind) => _writer.Write((byte)kind);
+
+    private void WriteSpan(SourceSpan span)
+    {
+        _writer.Write7BitEncodedInt(span.Begin);
+        _writer.Write7BitEncodedInt(span.Length);
+    }
+
+    // Index 0 is reserved for null.
+    private void WriteString(string? str)
+    {
+        if (str == null)
+        {
+            _writer.Write7BitEncodedInt(0);
+            return;
+        }
+
+        if (!_stringIndexes.TryGetValue(str, out int index))
+        {
+            _strings.Add(str);
+            index = _strings.Count;
+            _stringIndexes.Add(str, index);
+        }
+
+        _writer.Write7BitEncodedInt(index);
+    }
+}
+
+internal enum ASTNodeKind : byte
+{
+    Null,
+    Namespace,
+    NamespaceFromRoot,
+    Import,
+    Comment,
+    Attribute,
+    Type,
+    TypeTemplate,
+    Enum,
+    EnumFlag,
+    Trait,
+    Implement,
+    FuncDef,
+    FieldDef,
+    GlobalVar,
+    Parameter,
+    TemplateParameter,
+    ConstTemplateParameter,
+    Scope,
+    If,
+    While,
+    TypeRef,
+    LocalTypeRef,
+    TemplateTypeRef,
+    FuncTypeRef,
+    ArrayTypeRef,
+    ConstSizeArrayTypeRef,
+    BinaryOperation,
+    Cast,
+    DeRef,
+    FuncCall,
+    IndexAccess,
+    LocalDef,
+    InferredLocalDef,
+    LocalFuncDef,
+    InlineIf,
+    LiteralArray,
+    Literal,
+    Ref,
+    Self,
+    Return,
+    SubExpr,
+    RefOf,
+    Inverse,
+    IncrementVar,
+    DecrementVar
+}
+
+internal enum LiteralKind : byte
+{
+    Null,
+    Bool,
+    Int,
+    Float,
+    String,
+    Char,
+    EscapedString,
+    EscapedChar
+}
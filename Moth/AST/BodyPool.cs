@@ -0,0 +1,521 @@
+using Moth.AST.Node;
+using Moth.Tokens;
+
+namespace Moth.AST;
+
+// Keeps the function bodies of a script in flat pools instead of as graphs of node objects. Every
+// node is a fixed-size record in one contiguous list and refers to its children by their index in
+// it, to lists of children by their offset in a shared list of indexes, and to names by their
+// index in a table that holds each name once. A body only exists as node objects while something
+// reads it, so the bodies of a large program do not stay on the heap for the whole build.
+public sealed class BodyPool
+{
+    private const int None = -1;
+
+    private readonly List<Record> _nodes = new List<Record>();
+    private readonly List<int> _lists = new List<int>();
+    private readonly List<string> _strings = new List<string>();
+    private Dictionary<string, int>? _stringIndexes = new Dictionary<string, int>();
+    private readonly List<object?> _values = new List<object?>();
+
+    public int NodeCount
+    {
+        get { return _nodes.Count; }
+    }
+
+    // Fails, leaving the pool as it was, for a body holding a node that cannot be pooled.
+    public bool TryAdd(ScopeNode body, out int index)
+    {
+        int nodes = _nodes.Count;
+        int lists = _lists.Count;
+        int values = _values.Count;
+
+        try
+        {
+            index = AddNode(body);
+            return true;
+        }
+        catch (NotSupportedException)
+        {
+            _nodes.RemoveRange(nodes, _nodes.Count - nodes);
+            _lists.RemoveRange(lists, _lists.Count - lists);
+            _values.RemoveRange(values, _values.Count - values);
+            index = None;
+            return false;
+        }
+    }
+
+    // Lets go of the spare room in the pools, and of the table that finds names while bodies are
+    // added, once every body of a script is in.
+    public void TrimExcess()
+    {
+        _nodes.TrimExcess();
+        _lists.TrimExcess();
+        _strings.TrimExcess();
+        _values.TrimExcess();
+        _stringIndexes = null;
+    }
+
+    // Builds a new copy of a body as node objects every time.
+    public ScopeNode Build(int index) => Build<ScopeNode>(index);
+
+    private int AddNode(IASTNode? node)
+    {
+        switch (node)
+        {
+            case null:
+                return None;
+            case ScopeNode scope:
+                return Append(ASTNodeKind.Scope, scope.Span, AddList(scope.Statements));
+            case IfNode @if:
+                return Append(
+                    ASTNodeKind.If,
+                    @if.Span,
+                    AddNode(@if.Condition),
+                    AddNode(@if.Then),
+                    AddNode(@if.Else)
+                );
+            case WhileNode @while:
+                return Append(
+                    ASTNodeKind.While,
+                    @while.Span,
+                    AddNode(@while.Condition),
+                    AddNode(@while.Then)
+                );
+            case ReturnNode @return:
+                return Append(ASTNodeKind.Return, @return.Span, AddNode(@return.Expression));
+            case CommentNode comment:
+                return Append(
+                    ASTNodeKind.Comment,
+                    comment.Span,
+                    AddString(comment.Text),
+                    flags: comment.IsBlock ? (byte)1 : (byte)0
+                );
+            case NamespaceFromRootNode nmspace:
+                return Append(
+                    ASTNodeKind.NamespaceFromRoot,
+                    nmspace.Span,
+                    b: AddNode(nmspace.Child)
+                );
+            case NamespaceNode nmspace:
+                return Append(
+                    ASTNodeKind.Namespace,
+                    nmspace.Span,
+                    AddString(nmspace.Name),
+                    AddNode(nmspace.Child)
+                );
+            case ParameterNode param:
+                return Append(
+                    ASTNodeKind.Parameter,
+                    param.Span,
+                    AddString(param.Name),
+                    AddNode(param.TypeRef)
+                );
+            case ConstSizeArrayTypeRefNode constSizeArray:
+                return AppendTypeRef(
+                    ASTNodeKind.ConstSizeArrayTypeRef,
+                    constSizeArray,
+                    AddNode(constSizeArray.ElementType),
+                    AddValue(constSizeArray.Size)
+                );
+            case ArrayTypeRefNode array:
+                return AppendTypeRef(ASTNodeKind.ArrayTypeRef, array, AddNode(array.ElementType));
+            case FuncTypeRefNode funcType:
+                return AppendTypeRef(
+                    ASTNodeKind.FuncTypeRef,
+                    funcType,
+                    AddNode(funcType.ReturnType),
+                    AddList(funcType.ParameterTypes)
+                );
+            case LocalTypeRefNode localType:
+                return AppendTypeRef(
+                    ASTNodeKind.LocalTypeRef,
+                    localType,
+                    AddString(localType.Name)
+                );
+            case TemplateTypeRefNode templateType:
+                return AppendTypeRef(
+                    ASTNodeKind.TemplateTypeRef,
+                    templateType,
+                    AddString(templateType.Name),
+                    AddList(templateType.Arguments)
+                );
+            case TypeRefNode typeRef:
+                return AppendTypeRef(ASTNodeKind.TypeRef, typeRef, AddString(typeRef.Name));
+            case BinaryOperationNode binOp:
+                return Append(
+                    ASTNodeKind.BinaryOperation,
+                    binOp.Span,
+                    AddNode(binOp.Left),
+                    AddNode(binOp.Right),
+                    flags: (byte)binOp.Type
+                );
+            case CastNode cast:
+                return Append(
+                    ASTNodeKind.Cast,
+                    cast.Span,
+                    AddNode(cast.NewType),
+                    AddNode(cast.Value)
+                );
+            case DeRefNode deRef:
+                return Append(ASTNodeKind.DeRef, deRef.Span, AddNode(deRef.Value));
+            case FuncCallNode funcCall:
+                return Append(
+                    ASTNodeKind.FuncCall,
+                    funcCall.Span,
+                    AddString(funcCall.Name),
+                    AddList(funcCall.Arguments),
+                    AddNode(funcCall.ToCallOn)
+                );
+            case IndexAccessNode indexAccess:
+                return Append(
+                    ASTNodeKind.IndexAccess,
+                    indexAccess.Span,
+                    AddNode(indexAccess.ToBeIndexed),
+                    AddList(indexAccess.Arguments)
+                );
+            case InferredLocalDefNode inferredLocal:
+                return Append(
+                    ASTNodeKind.InferredLocalDef,
+                    inferredLocal.Span,
+                    AddString(inferredLocal.Name),
+                    AddNode(inferredLocal.Value)
+                );
+            case LocalDefNode local:
+                return Append(
+                    ASTNodeKind.LocalDef,
+                    local.Span,
+                    AddString(local.Name),
+                    AddNode(local.TypeRef)
+                );
+            case LocalFuncDefNode localFunc:
+                return Append(
+                    ASTNodeKind.LocalFuncDef,
+                    localFunc.Span,
+                    AddNode(localFunc.ReturnTypeRef),
+                    AddList(localFunc.Params),
+                    AddNode(localFunc.ExecutionBlock)
+                );
+            case InlineIfNode inlineIf:
+                return Append(
+                    ASTNodeKind.InlineIf,
+                    inlineIf.Span,
+                    AddNode(inlineIf.Condition),
+                    AddNode(inlineIf.Then),
+                    AddNode(inlineIf.Else)
+                );
+            case LiteralArrayNode literalArray:
+                return Append(
+                    ASTNodeKind.LiteralArray,
+                    literalArray.Span,
+                    AddNode(literalArray.ElementType),
+                    AddList(literalArray.Elements)
+                );
+            case LiteralNode literal:
+                // escaped text is kept as it is, so that reading a body does not unescape it
+                return literal.IsEscaped
+                    ? Append(
+                        ASTNodeKind.Literal,
+                        literal.Span,
+                        AddValue(literal.EscapedText),
+                        flags: literal.IsChar ? (byte)2 : (byte)1
+                    )
+                    : Append(ASTNodeKind.Literal, literal.Span, AddValue(literal.Value));
+            case RefNode @ref:
+                return Append(
+                    ASTNodeKind.Ref,
+                    @ref.Span,
+                    AddString(@ref.Name),
+                    AddNode(@ref.Parent)
+                );
+            case SelfNode self:
+                return Append(ASTNodeKind.Self, self.Span);
+            case SubExprNode subExpr:
+                return Append(ASTNodeKind.SubExpr, subExpr.Span, AddNode(subExpr.Expression));
+            case RefOfNode refOf:
+                return Append(ASTNodeKind.RefOf, refOf.Span, AddNode(refOf.Expression));
+            case InverseNode inverse:
+                return Append(ASTNodeKind.Inverse, inverse.Span, AddNode(inverse.Expression));
+            case IncrementVarNode increment:
+                return Append(
+                    ASTNodeKind.IncrementVar,
+                    increment.Span,
+                    AddNode(increment.Expression)
+                );
+            case DecrementVarNode decrement:
+                return Append(
+                    ASTNodeKind.DecrementVar,
+                    decrement.Span,
+                    AddNode(decrement.Expression)
+                );
+            default:
+                throw new NotSupportedException(
+                    $"Cannot pool node of type {node.GetType().Name}."
+                );
+        }
+    }
+
+    // A type reference keeps its pointer depth in B and its namespace in C.
+    private int AppendTypeRef(ASTNodeKind kind, TypeRefNode typeRef, int a, int d = None)
+    {
+        return Append(
+            kind,
+            typeRef.Span,
+            a,
+            (int)typeRef.PointerDepth,
+            AddNode(typeRef.Namespace),
+            d,
+            typeRef.IsRef ? (byte)1 : (byte)0
+        );
+    }
+
+    private int Append(
+        ASTNodeKind kind,
+        SourceSpan span,
+        int a = None,
+        int b = None,
+        int c = None,
+        int d = None,
+        byte flags = 0
+    )
+    {
+        _nodes.Add(new Record(kind, flags, a, b, c, d, span));
+        return _nodes.Count - 1;
+    }
+
+    // A list is its length followed by the indexes of its nodes.
+    private int AddList<T>(IReadOnlyCollection<T> nodes)
+        where T : IASTNode
+    {
+        var indexes = new int[nodes.Count];
+        int i = 0;
+
+        foreach (T node in nodes)
+        {
+            indexes[i++] = AddNode(node);
+        }
+
+        int offset = _lists.Count;
+        _lists.Add(indexes.Length);
+        _lists.AddRange(indexes);
+        return offset;
+    }
+
+    private int AddString(string? str)
+    {
+        if (str == null)
+            return None;
+
+        _stringIndexes ??= _strings
+            .Select((name, index) => (name, index))
+            .ToDictionary(pair => pair.name, pair => pair.index);
+
+        if (!_stringIndexes.TryGetValue(str, out int index))
+        {
+            index = _strings.Count;
+            _strings.Add(str);
+            _stringIndexes.Add(str, index);
+        }
+
+        return index;
+    }
+
+    private int AddValue(object? value)
+    {
+        _values.Add(value);
+        return _values.Count - 1;
+    }
+
+    private T Build<T>(int index)
+        where T : IASTNode? => (T)BuildNode(index);
+
+    private IASTNode? BuildNode(int index)
+    {
+        if (index == None)
+            return null;
+
+        Record record = _nodes[index];
+        IASTNode node = record.Kind switch
+        {
+            ASTNodeKind.Scope => new ScopeNode(BuildList<IStatementNode>(record.A)),
+            ASTNodeKind.If
+                => new IfNode(
+                    Build<IExpressionNode>(record.A),
+                    Build<ScopeNode>(record.B),
+                    Build<ScopeNode?>(record.C)
+                ),
+            ASTNodeKind.While
+                => new WhileNode(Build<IExpressionNode>(record.A), Build<ScopeNode>(record.B)),
+            ASTNodeKind.Return => new ReturnNode(Build<IExpressionNode?>(record.A)),
+            ASTNodeKind.Comment => new CommentNode(GetString(record.A), record.Flags == 1),
+            ASTNodeKind.NamespaceFromRoot
+                => new NamespaceFromRootNode() { Child = Build<NamespaceNode?>(record.B) },
+            ASTNodeKind.Namespace
+                => new NamespaceNode(GetString(record.A))
+                {
+                    Child = Build<NamespaceNode?>(record.B)
+                },
+            ASTNodeKind.Parameter
+                => new ParameterNode(GetString(record.A), Build<TypeRefNode>(record.B)),
+            ASTNodeKind.ConstSizeArrayTypeRef
+                => new ConstSizeArrayTypeRefNode(
+                    Build<TypeRefNode>(record.A),
+                    (uint)record.B,
+                    record.Flags == 1,
+                    (long)_values[record.D]!
+                )
+                {
+                    Namespace = Build<NamespaceNode?>(record.C)
+                },
+            ASTNodeKind.ArrayTypeRef
+                => new ArrayTypeRefNode(
+                    Build<TypeRefNode>(record.A),
+                    (uint)record.B,
+                    record.Flags == 1
+                )
+                {
+                    Namespace = Build<NamespaceNode?>(record.C)
+                },
+            ASTNodeKind.FuncTypeRef
+                => new FuncTypeRefNode(
+                    Build<TypeRefNode>(record.A),
+                    BuildList<TypeRefNode>(record.D),
+                    (uint)record.B,
+                    record.Flags == 1
+                )
+                {
+                    Namespace = Build<NamespaceNode?>(record.C)
+                },
+            ASTNodeKind.LocalTypeRef
+                => new LocalTypeRefNode(GetString(record.A), (uint)record.B, record.Flags == 1)
+                {
+                    Namespace = Build<NamespaceNode?>(record.C)
+                },
+            ASTNodeKind.TemplateTypeRef
+                => new TemplateTypeRefNode(
+                    GetString(record.A),
+                    BuildList<IExpressionNode>(record.D),
+                    (uint)record.B,
+                    record.Flags == 1
+                )
+                {
+                    Namespace = Build<NamespaceNode?>(record.C)
+                },
+            ASTNodeKind.TypeRef
+                => new TypeRefNode(GetString(record.A), (uint)record.B, record.Flags == 1)
+                {
+                    Namespace = Build<NamespaceNode?>(record.C)
+                },
+            ASTNodeKind.BinaryOperation
+                => new BinaryOperationNode(
+                    Build<IExpressionNode>(record.A),
+                    (OperationType)record.Flags
+                )
+                {
+                    Right = Build<IExpressionNode>(record.B)
+                },
+            ASTNodeKind.Cast
+                => new CastNode(Build<TypeRefNode>(record.A), Build<SubExprNode>(record.B)),
+            ASTNodeKind.DeRef => new DeRefNode(Build<IExpressionNode>(record.A)),
+            ASTNodeKind.FuncCall
+                => new FuncCallNode(
+                    GetString(record.A),
+                    BuildList<IExpressionNode>(record.B),
+                    Build<IExpressionNode?>(record.C)
+                ),
+            ASTNodeKind.IndexAccess
+                => new IndexAccessNode(
+                    Build<IExpressionNode>(record.A),
+                    BuildList<IExpressionNode>(record.B)
+                ),
+            ASTNodeKind.InferredLocalDef
+                => new InferredLocalDefNode(
+                    GetString(record.A),
+                    Build<IExpressionNode>(record.B)
+                ),
+            ASTNodeKind.LocalDef
+                => new LocalDefNode(GetString(record.A), Build<TypeRefNode>(record.B)),
+            ASTNodeKind.LocalFuncDef
+                => new LocalFuncDefNode(
+                    Build<TypeRefNode>(record.A),
+                    BuildList<ParameterNode>(record.B),
+                    Build<ScopeNode>(record.C)
+                ),
+            ASTNodeKind.InlineIf
+                => new InlineIfNode(
+                    Build<IExpressionNode>(record.A),
+                    Build<IExpressionNode>(record.B),
+                    Build<IExpressionNode>(record.C)
+                ),
+            ASTNodeKind.LiteralArray
+                => new LiteralArrayNode(
+                    Build<TypeRefNode>(record.A),
+                    BuildList<IExpressionNode>(record.B).ToArray()
+                ),
+            ASTNodeKind.Literal
+                => record.Flags == 0
+                    ? new LiteralNode(_values[record.A])
+                    : new LiteralNode((ReadOnlyMemory<char>)_values[record.A]!, record.Flags == 2),
+            ASTNodeKind.Ref
+                => new RefNode(GetString(record.A), Build<IExpressionNode?>(record.B)),
+            ASTNodeKind.Self => new SelfNode(),
+            ASTNodeKind.SubExpr => new SubExprNode(Build<IExpressionNode>(record.A)),
+            ASTNodeKind.RefOf => new RefOfNode(Build<IExpressionNode>(record.A)),
+            ASTNodeKind.Inverse => new InverseNode(Build<IExpressionNode>(record.A)),
+            ASTNodeKind.IncrementVar => new IncrementVarNode(Build<IExpressionNode>(record.A)),
+            ASTNodeKind.DecrementVar => new DecrementVarNode(Build<IExpressionNode>(record.A)),
+            _ => throw new Exception($"Invalid pooled node kind {record.Kind}.")
+        };
+
+        node.Span = record.Span;
+        return node;
+    }
+
+    private List<T> BuildList<T>(int offset)
+        where T : IASTNode
+    {
+        int count = _lists[offset];
+        var nodes = new List<T>(count);
+
+        for (int i = 1; i <= count; i++)
+        {
+            nodes.Add(Build<T>(_lists[offset + i]));
+        }
+
+        return nodes;
+    }
+
+    private string GetString(int index) => index == None ? null : _strings[index];
+
+    // What A to D hold depends on the kind of the node: the index of a child node, the offset of
+    // a list of them, the index of a name or a value, or a plain number.
+    private readonly struct Record
+    {
+        public readonly ASTNodeKind Kind;
+        public readonly byte Flags;
+        public readonly int A;
+        public readonly int B;
+        public readonly int C;
+        public readonly int D;
+        public readonly SourceSpan Span;
+
+        public Record(
+            ASTNodeKind kind,
+            byte flags,
+            int a,
+            int b,
+            int c,
+            int d,
+            SourceSpan span
+        )
+        {
+            Kind = kind;
+            Flags = flags;
+            A = a;
+            B = b;
+            C = c;
+            D = d;
+            Span = span;
+        }
+    }
+}
@@ -0,0 +1,277 @@
+using Moth.Tokens;
+
+namespace Moth.AST;
+
+public static class FrontEnd
+{
+    public static ScriptAST[] ProcessFiles(
+        IReadOnlyList<string> filePaths,
+        int jobs,
+        Logger logger,
+        bool verbose = false,
+        ParseCache? cache = null
+    )
+    {
+        var scripts = new ScriptAST[filePaths.Count];
+        var errors = new FrontEndException?[filePaths.Count];
+
+        Parallel.For(
+            0,
+            filePaths.Count,
+            new ParallelOptions { MaxDegreeOfParallelism = jobs > 0 ? jobs : -1 },
+            i =>
+            {
+                try
+                {
+                    scripts[i] = ProcessFile(filePaths[i], logger, verbose, cache);
+                }
+                catch (FrontEndException e)
+                {
+                    errors[i] = e;
+                }
+            }
+        );
+
+        // report in input order so that the output does not depend on scheduling
+        int failed = 0;
+
+        foreach (var error in errors)
+        {
+            if (error == null)
+                continue;
+
+            logger.Error(error.Message);
+            failed++;
+        }
+
+        if (failed > 0)
+        {
+            throw new Exception($"Front end failed on {failed} of {filePaths.Count} file(s).");
+        }
+
+        return scripts;
+    }
+
+    public static ScriptAST ProcessFile(
+        string filePath,
+        Logger logger,
+        bool verbose = false,
+        ParseCache? cache = null
+    )
+    {
+        SourceFile source;
+        List<Token> tokens;
+        var symbols = new SymbolTable();
+        ScriptAST scriptAST;
+
+        try
+        {
+            if (verbose)
+            {
+                logger.Log($"Reading \"{filePath}\"");
+            }
+
+            source = new SourceFile(File.ReadAllText(filePath), filePath);
+        }
+        catch (Exception e)
+        {
+            throw new FrontEndException(filePath, "get contents of", e);
+        }
+
+        if (cache != null && cache.TryLoad(source, out scriptAST))
+        {
+            if (verbose)
+            {
+                logger.Log($"Loaded cached AST of \"{filePath}\"");
+            }
+
+            scriptAST.PoolBodies();
+            return scriptAST;
+        }
+
+        // tokenize the contents of the file
+        try
+        {
+            if (verbose)
+            {
+                logger.Log($"Tokenizing \"{filePath}\"");
+            }
+
+            tokens = Tokenizer.Tokenize(source, symbols);
+        }
+        catch (Exception e)
+        {
+            throw new FrontEndException(filePath, "tokenize", e);
+        }
+
+        // convert to AST
+        try
+        {
+            if (verbose)
+            {
+                logger.Log($"Generating AST of \"{filePath}\"");
+            }
+
+            scriptAST = ASTGenerator.ProcessScript(new ParseContext(tokens, symbols, source));
+        }
+        catch (Exception e)
+        {
+            throw new FrontEndException(filePath, "parse tokens of", e);
+        }
+
+        try
+        {
+            cache?.Store(source, scriptAST);
+        }
+        catch (Exception e)
+        {
+            // a cache that cannot be written to only costs time
+            logger.Warn($"Failed to cache AST of \"{filePath}\" due to: {e.Message}");
+        }
+
+        // the script is kept until every file is compiled, but its bodies are read one at a time
+        scriptAST.PoolBodies();
+        return scriptAST;
+    }
+
+    public static int FormatFiles(
+        IReadOnlyList<string> filePaths,
+        int jobs,
+        Logger logger,
+        bool check,
+        bool verbose = false
+    )
+    {
+        var changed = new bool[filePaths.Count];
+        var errors = new FrontEndException?[filePaths.Count];
+
+        Parallel.For(
+            0,
+            filePaths.Count,
+            new ParallelOptions { MaxDegreeOfParallelism = jobs > 0 ? jobs : -1 },
+            i =>
+            {
+                try
+                {
+                    changed[i] = FormatFile(filePaths[i], logger, check, verbose);
+                }
+                catch (FrontEndException e)
+                {
+                    errors[i] = e;
+                }
+            }
+        );
+
+        int failed = 0;
+        int unformatted = 0;
+
+        for (int i = 0; i < filePaths.Count; i++)
+        {
+            if (errors[i] != null)
+            {
+                logger.Error(errors[i].Message);
+                failed++;
+            }
+            else if (changed[i])
+            {
+                logger.Log(
+                    check
+                        ? $"File \"{filePaths[i]}\" is not formatted."
+                        : $"File \"{filePaths[i]}\" formatted successfully."
+                );
+                unformatted++;
+            }
+        }
+
+        if (failed > 0)
+        {
+            throw new Exception($"Formatting failed on {failed} of {filePaths.Count} file(s).");
+        }
+
+        return unformatted;
+    }
+
+    // Returns whether the formatted source differs from what is on disk.
+    public static bool FormatFile(string filePath, Logger logger, bool check, bool verbose = false)
+    {
+        string fileContents;
+        List<Token> tokens;
+        var symbols = new SymbolTable();
+        string formattedSource;
+
+        try
+        {
+            if (verbose)
+            {
+                logger.Log($"Reading \"{filePath}\"");
+            }
+
+            fileContents = File.ReadAllText(filePath);
+        }
+        catch (Exception e)
+        {
+            throw new FrontEndException(filePath, "get contents of", e);
+        }
+
+        try
+        {
+            tokens = Tokenizer.Tokenize(fileContents, symbols);
+        }
+        catch (Exception e)
+        {
+            throw new FrontEndException(filePath, "tokenize", e);
+        }
+
+        try
+        {
+            formattedSource = ASTGenerator
+                .ProcessScript(
+                    new ParseContext(tokens, symbols, new SourceFile(fileContents, filePath))
+                )
+                .GetSource();
+        }
+        catch (Exception e)
+        {
+            throw new FrontEndException(filePath, "parse tokens of", e);
+        }
+
+        if (formattedSource == fileContents)
+        {
+            return false;
+        }
+
+        try
+        {
+            // never write out a formatting that changes the meaning of the file
+            if (!Utils.CompareTokens(Tokenizer.Tokenize(formattedSource), tokens))
+            {
+                throw new Exception("Formatted source does not match the original tokens.");
+            }
+
+            if (!check)
+            {
+                using (var fs = File.Create(filePath))
+                    fs.Write(Encoding.UTF8.GetBytes(formattedSource));
+            }
+        }
+        catch (Exception e)
+        {
+            throw new FrontEndException(filePath, "format", e);
+        }
+
+        return true;
+    }
+}
+
+public sealed class FrontEndException : Exception
+{
+    public string FilePath { get; }
+    public string Stage { get; }
+
+    public FrontEndException(string filePath, string stage, Exception inner)
+        : base($"Failed to {stage} \"{filePath}\" due to: {inner}", inner)
+    {
+        FilePath = filePath;
+        Stage = stage;
+    }
+}
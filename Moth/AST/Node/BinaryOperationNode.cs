@@ -1,7 +1,11 @@
-﻿namespace Moth.AST.Node;
+﻿using Moth.Tokens;
+
+namespace Moth.AST.Node;
 
 public class BinaryOperationNode : IExpressionNode
 {
+    public SourceSpan Span { get; set; }
+
     public OperationType Type { get; set; }
     public IExpressionNode Left { get; set; }
     public IExpressionNode Right { get; set; } = null;
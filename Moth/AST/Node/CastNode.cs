@@ -1,7 +1,11 @@
+using Moth.Tokens;
+
 namespace Moth.AST.Node;
 
 public class CastNode : IExpressionNode
 {
+    public SourceSpan Span { get; set; }
+
     public TypeRefNode NewType { get; set; }
     public SubExprNode Value { get; set; }
 
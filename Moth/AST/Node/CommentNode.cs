@@ -1,7 +1,11 @@
+using Moth.Tokens;
+
 namespace Moth.AST.Node;
 
 public class CommentNode : IStatementNode
 {
+    public SourceSpan Span { get; set; }
+
     public string Text { get; set; }
     public bool IsBlock { get; set; }
 
@@ -1,7 +1,11 @@
-﻿namespace Moth.AST.Node;
+﻿using Moth.Tokens;
+
+namespace Moth.AST.Node;
 
 public class DeRefNode : IExpressionNode
 {
+    public SourceSpan Span { get; set; }
+
     public IExpressionNode Value { get; set; }
 
     public DeRefNode(IExpressionNode value) => Value = value;
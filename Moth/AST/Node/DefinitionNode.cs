@@ -1,9 +1,12 @@
 ﻿using Moth.AST.Node;
+using Moth.Tokens;
 
 namespace Moth.AST.Node;
 
 public abstract class DefinitionNode : IStatementNode
 {
+    public SourceSpan Span { get; set; }
+
     public string Name { get; set; }
     public PrivacyType Privacy { get; set; }
     public List<AttributeNode> Attributes { get; set; }
@@ -1,7 +1,11 @@
+using Moth.Tokens;
+
 namespace Moth.AST.Node;
 
 public class EnumFlagNode : IASTNode
 {
+    public SourceSpan Span { get; set; }
+
     public string Name { get; set; }
     public ulong Value { get; set; }
 
@@ -5,12 +5,31 @@ namespace Moth.AST.Node;
 public class FuncDefNode : DefinitionNode
 {
     public List<ParameterNode> Params { get; set; }
-    public ScopeNode? ExecutionBlock { get; set; }
     public TypeRefNode ReturnTypeRef { get; set; }
     public bool IsVariadic { get; set; }
     public bool IsStatic { get; set; }
     public bool IsForeign { get; set; }
 
+    private ScopeNode? _executionBlock;
+    private BodyPool? _pool;
+    private int _poolIndex;
+
+    // A pooled body is built anew on every read, so it should be read once per use.
+    public ScopeNode? ExecutionBlock
+    {
+        get { return _pool != null ? _pool.Build(_poolIndex) : _executionBlock; }
+        set
+        {
+            _executionBlock = value;
+            _pool = null;
+        }
+    }
+
+    public bool HasExecutionBlock
+    {
+        get { return _pool != null || _executionBlock != null; }
+    }
+
     public FuncDefNode(
         string name,
         PrivacyType privacy,
@@ -58,9 +77,18 @@ public class FuncDefNode : DefinitionNode
 
         builder.Append($"{Reserved.Function} {Name}({@params}) {ReturnTypeRef.GetSource()}");
 
-        if (ExecutionBlock != default)
-            builder.Append($" {ExecutionBlock.GetSource()}");
+        if (ExecutionBlock is ScopeNode executionBlock)
+            builder.Append($" {executionBlock.GetSource()}");
         else
             builder.Append(";");
     }
+
+    internal void PoolBody(BodyPool pool)
+    {
+        if (_executionBlock != null && pool.TryAdd(_executionBlock, out _poolIndex))
+        {
+            _pool = pool;
+            _executionBlock = null;
+        }
+    }
 }
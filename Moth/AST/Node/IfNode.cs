@@ -1,7 +1,11 @@
-﻿namespace Moth.AST.Node;
+﻿using Moth.Tokens;
+
+namespace Moth.AST.Node;
 
 public class IfNode : IStatementNode
 {
+    public SourceSpan Span { get; set; }
+
     public IExpressionNode Condition { get; set; }
     public ScopeNode Then { get; set; }
     public ScopeNode? Else { get; set; }
@@ -1,7 +1,11 @@
+using Moth.Tokens;
+
 namespace Moth.AST.Node;
 
 public class ImplementNode : IStatementNode
 {
+    public SourceSpan Span { get; set; }
+
     public TypeRefNode Type { get; set; }
     public TypeRefNode Trait { get; set; }
     public ScopeNode Implementations { get; set; }
@@ -1,7 +1,11 @@
+using Moth.Tokens;
+
 namespace Moth.AST.Node;
 
 public class ImportNode : IStatementNode
 {
+    public SourceSpan Span { get; set; }
+
     public NamespaceNode Namespace { get; set; }
 
     public ImportNode(NamespaceNode nmspace)
@@ -1,7 +1,11 @@
-﻿namespace Moth.AST.Node;
+﻿using Moth.Tokens;
+
+namespace Moth.AST.Node;
 
 public class IndexAccessNode : IExpressionNode
 {
+    public SourceSpan Span { get; set; }
+
     public IExpressionNode ToBeIndexed { get; set; }
     public List<IExpressionNode> Arguments { get; set; }
 
@@ -1,7 +1,11 @@
-﻿namespace Moth.AST.Node;
+﻿using Moth.Tokens;
+
+namespace Moth.AST.Node;
 
 public class InlineIfNode : IExpressionNode
 {
+    public SourceSpan Span { get; set; }
+
     public IExpressionNode Condition { get; set; }
     public IExpressionNode Then { get; set; }
     public IExpressionNode Else { get; set; }
@@ -1,7 +1,11 @@
+using Moth.Tokens;
+
 namespace Moth.AST.Node;
 
 public class LiteralArrayNode : IExpressionNode
 {
+    public SourceSpan Span { get; set; }
+
     public TypeRefNode ElementType { get; set; }
     public IExpressionNode[] Elements { get; set; }
 
@@ -1,25 +1,81 @@
 ﻿using System.CodeDom;
 using System.Text.RegularExpressions;
+using Moth.Tokens;
 
 namespace Moth.AST.Node;
 
 public class LiteralNode : IExpressionNode
 {
-    public object? Value { get; set; }
+    public SourceSpan Span { get; set; }
 
-    public LiteralNode(object? value) => Value = value;
+    private object? _value;
+    private ReadOnlyMemory<char> _escapedText;
+    private bool _isChar;
+    private bool _isEscaped;
+
+    public LiteralNode(object? value) => _value = value;
+
+    // String and char literals keep their source text until the value is first needed.
+    public LiteralNode(ReadOnlyMemory<char> escapedText, bool isChar)
+    {
+        _escapedText = escapedText;
+        _isChar = isChar;
+        _isEscaped = true;
+    }
+
+    // Whether this is a string or char literal whose value has not been needed yet.
+    internal bool IsEscaped
+    {
+        get { return Volatile.Read(ref _isEscaped); }
+    }
+
+    internal ReadOnlyMemory<char> EscapedText
+    {
+        get { return _escapedText; }
+    }
+
+    internal bool IsChar
+    {
+        get { return _isChar; }
+    }
+
+    public object? Value
+    {
+        get
+        {
+            // codegen shards share the AST, so the value is published before the flag is cleared,
+            // and a thread that sees the flag cleared is guaranteed to see the value
+            if (Volatile.Read(ref _isEscaped))
+            {
+                string text = Tokenizer.Unescape(_escapedText.Span);
+                Interlocked.CompareExchange(ref _value, _isChar ? text[0] : text, null);
+                Volatile.Write(ref _isEscaped, false);
+            }
+
+            return _value;
+        }
+        set
+        {
+            _value = value;
+            Volatile.Write(ref _isEscaped, false);
+        }
+    }
 
     public string GetSource() =>
-        Value is string str
-            ? $"\"{str}\""
-            : Value is char ch
-                ? $"'{ch switch
-                {
-                    '\n' => @"\n",
-                    '\0' => @"\0",
-                    _ => throw new NotImplementedException()
-                }}'"
-                : Value != null
-                    ? Value.ToString()
-                    : Reserved.Null;
+        IsEscaped
+            ? _isChar
+                ? $"'{_escapedText}'"
+                : $"\"{_escapedText}\""
+            : Value is string str
+                ? $"\"{str}\""
+                : Value is char ch
+                    ? $"'{ch switch
+                    {
+                        '\n' => @"\n",
+                        '\0' => @"\0",
+                        _ => throw new NotImplementedException()
+                    }}'"
+                    : Value != null
+                        ? Value.ToString()
+                        : Reserved.Null;
 }
@@ -1,4 +1,5 @@
-﻿using System;
+﻿using Moth.Tokens;
+using System;
 using System.Collections.Generic;
 using System.Linq;
 using System.Text;
@@ -8,6 +9,8 @@ namespace Moth.AST.Node;
 
 public class LocalFuncDefNode : IExpressionNode
 {
+    public SourceSpan Span { get; set; }
+
     public TypeRefNode ReturnTypeRef { get; set; }
     public List<ParameterNode> Params { get; set; }
     public ScopeNode ExecutionBlock { get; set; }
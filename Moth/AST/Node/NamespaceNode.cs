@@ -1,7 +1,11 @@
+using Moth.Tokens;
+
 namespace Moth.AST.Node;
 
 public class NamespaceNode : IExpressionNode
 {
+    public SourceSpan Span { get; set; }
+
     public string Name { get; set; }
     public NamespaceNode? Child { get; set; }
 
@@ -1,7 +1,11 @@
-﻿namespace Moth.AST.Node;
+﻿using Moth.Tokens;
+
+namespace Moth.AST.Node;
 
 public class ParameterNode : IASTNode
 {
+    public SourceSpan Span { get; set; }
+
     public string Name { get; set; }
     public TypeRefNode TypeRef { get; set; }
 
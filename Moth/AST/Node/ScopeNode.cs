@@ -1,7 +1,11 @@
-﻿namespace Moth.AST.Node;
+﻿using Moth.Tokens;
+
+namespace Moth.AST.Node;
 
 public class ScopeNode : IStatementNode
 {
+    public SourceSpan Span { get; set; }
+
     public List<IStatementNode> Statements { get; set; }
 
     public ScopeNode(List<IStatementNode> statements) => Statements = statements;
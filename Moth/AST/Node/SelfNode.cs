@@ -1,7 +1,11 @@
-﻿namespace Moth.AST.Node;
+﻿using Moth.Tokens;
+
+namespace Moth.AST.Node;
 
 public class SelfNode : IExpressionNode
 {
+    public SourceSpan Span { get; set; }
+
     public string GetSource()
     {
         return Reserved.Self;
@@ -1,7 +1,11 @@
+using Moth.Tokens;
+
 namespace Moth.AST.Node;
 
 public abstract class SingleExprNode : IExpressionNode
 {
+    public SourceSpan Span { get; set; }
+
     public IExpressionNode Expression { get; set; }
 
     protected SingleExprNode(IExpressionNode expression) => Expression = expression;
@@ -1,8 +1,12 @@
-﻿namespace Moth.AST.Node;
+﻿using Moth.Tokens;
+
+namespace Moth.AST.Node;
 
 //TODO: this could just be a string
 public class TemplateParameterNode : IASTNode
 {
+    public SourceSpan Span { get; set; }
+
     public string Name { get; set; }
 
     public TemplateParameterNode(string name) => Name = name;
@@ -21,6 +21,11 @@ public class TypeNode : DefinitionNode
         _scope = scope;
     }
 
+    internal ScopeNode? Scope
+    {
+        get => _scope;
+    }
+
     public bool IsOpaque
     {
         get => _scope == null;
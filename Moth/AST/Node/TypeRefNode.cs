@@ -1,7 +1,11 @@
-﻿namespace Moth.AST.Node;
+﻿using Moth.Tokens;
+
+namespace Moth.AST.Node;
 
 public class TypeRefNode : IExpressionNode
 {
+    public SourceSpan Span { get; set; }
+
     public string Name { get; set; }
     public uint PointerDepth { get; set; }
     public bool IsRef { get; set; }
@@ -0,0 +1,126 @@
+using System.Collections.Concurrent;
+using System.Security.Cryptography;
+using Moth.Tokens;
+
+namespace Moth.AST;
+
+// Keeps parsed scripts on disk so that unchanged files skip tokenizing and parsing. Entries are
+// keyed by a hash of the file contents, the exact build of the compiler and the AST encoding
+// version, so stale entries are simply never looked up again.
+public sealed class ParseCache
+{
+    private static readonly byte[] Magic = "MOTHAST"u8.ToArray();
+
+    // the parser is part of this assembly, and its version is not bumped for every change
+    private static readonly string CompilerIdentity =
+        $"{Meta.Version}+{typeof(ParseCache).Assembly.ManifestModule.ModuleVersionId}"
+        + $"+{ASTSerializer.FormatVersion}\n";
+
+    // the latest entry of every file, kept by a resident compiler between builds
+    private static readonly ConcurrentDictionary<string, (byte[] Key, byte[] AST)> Resident =
+        new ConcurrentDictionary<string, (byte[] Key, byte[] AST)>();
+
+    // Whether entries are also kept in memory, for a process that builds more than once.
+    public static bool KeepInMemory { get; set; } = false;
+
+    public string CacheDir { get; }
+
+    public ParseCache(string cacheDir)
+    {
+        CacheDir = cacheDir;
+        Directory.CreateDirectory(cacheDir);
+    }
+
+    public bool TryLoad(SourceFile source, out ScriptAST scriptAST)
+    {
+        byte[] key = GetKey(source.Text);
+        string path = GetPath(key);
+        scriptAST = null;
+
+        if (
+            KeepInMemory
+            && Resident.TryGetValue(source.Path, out var resident)
+            && resident.Key.SequenceEqual(key)
+        )
+        {
+            scriptAST = new ASTDeserializer(new MemoryStream(resident.AST, false)).Process(source);
+            return true;
+        }
+
+        if (!File.Exists(path))
+            return false;
+
+        try
+        {
+            using (var stream = File.OpenRead(path))
+            {
+                Span<byte> header = stackalloc byte[Magic.Length + key.Length];
+                stream.ReadExactly(header);
+
+                // guards against hash collisions in the file name and truncated writes
+                if (
+                    !header[..Magic.Length].SequenceEqual(Magic)
+                    || !header[Magic.Length..].SequenceEqual(key)
+                )
+                {
+                    return false;
+                }
+
+                if (!KeepInMemory)
+                {
+                    scriptAST = new ASTDeserializer(stream).Process(source);
+                    return true;
+                }
+
+                var ast = new MemoryStream();
+                stream.CopyTo(ast);
+                Resident[source.Path] = (key, ast.ToArray());
+                ast.Seek(0, SeekOrigin.Begin);
+                scriptAST = new ASTDeserializer(ast).Process(source);
+                return true;
+            }
+        }
+        catch (Exception)
+        {
+            scriptAST = null;
+            return false;
+        }
+    }
+
+    public void Store(SourceFile source, ScriptAST scriptAST)
+    {
+        byte[] key = GetKey(source.Text);
+        string path = GetPath(key);
+        string tempPath = $"{path}.{Guid.NewGuid():N}.tmp";
+        var ast = new MemoryStream();
+
+        new ASTSerializer().Process(ast, scriptAST);
+
+        if (KeepInMemory)
+            Resident[source.Path] = (key, ast.ToArray());
+
+        // write to a temporary file first so that a concurrent or interrupted build never reads
+        // a partial entry
+        using (var stream = File.Create(tempPath))
+        {
+            stream.Write(Magic);
+            stream.Write(key);
+            ast.WriteTo(stream);
+        }
+
+        File.Move(tempPath, path, true);
+    }
+
+    private string GetPath(byte[] key) =>
+        Path.Combine(CacheDir, $"{Convert.ToHexString(key).ToLowerInvariant()}.ast");
+
+    private static byte[] GetKey(string text)
+    {
+        using (var hash = IncrementalHash.CreateHash(HashAlgorithmName.SHA256))
+        {
+            hash.AppendData(Encoding.UTF8.GetBytes(CompilerIdentity));
+            hash.AppendData(Encoding.UTF8.GetBytes(text));
+            return hash.GetHashAndReset();
+        }
+    }
+}
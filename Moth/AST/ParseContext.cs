@@ -8,11 +8,17 @@ public class ParseContext
 
     public readonly int Length;
 
+    public readonly SymbolTable Symbols;
+
+    public readonly SourceFile? Source;
+
     private readonly List<Token> _tokens;
 
-    public ParseContext(List<Token> tokens)
+    public ParseContext(List<Token> tokens, SymbolTable symbols, SourceFile? source = null)
     {
         _tokens = tokens;
+        Symbols = symbols;
+        Source = source;
         Length = _tokens.Count;
     }
 
@@ -21,12 +27,28 @@ public class ParseContext
         get { return Position >= _tokens.Count ? null : _tokens[Position]; }
     }
 
+    public string CurrentName
+    {
+        get { return Symbols[Current.Value.Symbol]; }
+    }
+
     public Token? MoveNext()
     {
         Position++;
         return Current;
     }
 
+    // Covers the tokens from start up to, but not including, the current one.
+    public SourceSpan SpanFrom(int start)
+    {
+        if (start >= Position || start >= _tokens.Count)
+        {
+            return default;
+        }
+
+        return SourceSpan.FromBounds(_tokens[start].Begin, _tokens[Position - 1].End);
+    }
+
     public Token? Previous()
     {
         Position--;
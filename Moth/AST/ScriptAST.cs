@@ -1,10 +1,16 @@
 ﻿using Moth.AST.Node;
 using Moth.LLVM;
+using Moth.Tokens;
 
 namespace Moth.AST;
 
 public class ScriptAST : IASTNode, ITreeNode
 {
+    public SourceSpan Span { get; set; }
+
+    // Resolves the spans of the nodes in this script to lines and columns.
+    public SourceFile? Source { get; set; }
+
     public NamespaceNode Namespace { get; }
     public List<IStatementNode> Contents { get; }
 
@@ -41,58 +47,124 @@ public class ScriptAST : IASTNode, ITreeNode
     {
         get { return Contents.OfType<ImportNode>().ToArray(); }
     }
-    public GlobalVarNode[] GlobalVariables
+
+    // Visits every statement in the order it appeared in the source.
+    public void Accept(ScriptVisitor visitor)
     {
-        get { return Contents.OfType<GlobalVarNode>().ToArray(); }
+        foreach (IStatementNode statement in Contents)
+        {
+            visitor.Visit(statement);
+        }
     }
 
-    public FuncDefNode[] GlobalFunctions
+    // Visits the statements one kind after the other, in the order the compiler declares them.
+    public void AcceptGrouped(ScriptVisitor visitor)
     {
-        get { return Contents.OfType<FuncDefNode>().ToArray(); }
+        var groups = new List<IStatementNode>[(int)StatementKind.Other + 1];
+
+        for (int i = 0; i < groups.Length; i++)
+        {
+            groups[i] = new List<IStatementNode>();
+        }
+
+        foreach (IStatementNode statement in Contents)
+        {
+            groups[(int)ScriptVisitor.KindOf(statement)].Add(statement);
+        }
+
+        foreach (List<IStatementNode> group in groups)
+        {
+            foreach (IStatementNode statement in group)
+            {
+                visitor.Visit(statement);
+            }
+        }
     }
 
-    public TypeNode[] TypeNodes
+    // Moves the body of every function in this script into a BodyPool, which is worth it for a
+    // script that is kept around while others are compiled.
+    public void PoolBodies()
     {
-        get { return Contents.OfType<TypeNode>().ToArray(); }
+        var pool = new BodyPool();
+
+        foreach (IStatementNode statement in Contents)
+        {
+            PoolBodies(statement, pool);
+        }
+
+        pool.TrimExcess();
     }
 
-    public EnumNode[] EnumNodes
+    public string GetSource()
     {
-        get { return Contents.OfType<EnumNode>().ToArray(); }
+        var writer = new SourceWriter(
+            new StringBuilder($"{Reserved.Namespace} {Namespace.GetSource()};\n")
+        );
+        Accept(writer);
+
+        if (writer.Builder[writer.Builder.Length - 1] != '\n')
+            writer.Builder.Append("\n");
+
+        return writer.Builder.ToString();
     }
 
-    public TraitNode[] TraitNodes
+    public void PrintTree(TextWriter writer)
     {
-        get { return Contents.OfType<TraitNode>().ToArray(); }
+        writer.Write(GetSource());
     }
 
-    public ImplementNode[] ImplementNodes
+    private static void PoolBodies(IStatementNode statement, BodyPool pool)
     {
-        get { return Contents.OfType<ImplementNode>().ToArray(); }
+        if (statement is FuncDefNode func)
+        {
+            func.PoolBody(pool);
+            return;
+        }
+
+        // methods are pooled along with the functions of the script
+        ScopeNode? members = statement switch
+        {
+            TypeNode type => type.Scope,
+            TraitNode trait => trait.Scope,
+            EnumNode @enum => @enum.Scope,
+            ImplementNode implement => implement.Implementations,
+            _ => null,
+        };
+
+        if (members == null)
+            return;
+
+        foreach (IStatementNode member in members.Statements)
+        {
+            PoolBodies(member, pool);
+        }
     }
 
-    public string GetSource()
+    private sealed class SourceWriter : ScriptVisitor
     {
-        var builder = new StringBuilder($"{Reserved.Namespace} {Namespace.GetSource()};\n");
-        IStatementNode last = null;
+        public StringBuilder Builder { get; }
 
-        foreach (var statement in Contents)
-        {
-            if (statement is not ImportNode && last is ImportNode)
-                builder.Append("\n");
+        private bool _afterImport;
 
-            builder.Append($"\n{statement.GetSource()}");
-            last = statement;
+        public SourceWriter(StringBuilder builder)
+        {
+            Builder = builder;
         }
 
-        if (builder[builder.Length - 1] != '\n')
-            builder.Append("\n");
+        public override void VisitImport(ImportNode node)
+        {
+            Builder.Append($"\n{node.GetSource()}");
+            _afterImport = true;
+        }
 
-        return builder.ToString();
-    }
+        // imports are kept apart from the rest of the file by an empty line
+        public override void DefaultVisit(IStatementNode node)
+        {
+            if (_afterImport)
+                Builder.Append("\n");
 
-    public void PrintTree(TextWriter writer)
-    {
-        writer.Write(GetSource());
+            Builder.Append($"\n{node.GetSource()}");
+            _afterImport = false;
+        }
     }
 }
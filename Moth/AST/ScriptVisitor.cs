@@ -0,0 +1,83 @@
+using Moth.AST.Node;
+
+namespace Moth.AST;
+
+// The kinds of top-level statement, in the order ScriptAST.AcceptGrouped visits them.
+public enum StatementKind : byte
+{
+    Import,
+    Global,
+    Function,
+    Type,
+    Trait,
+    Enum,
+    Implement,
+    Other,
+}
+
+// Receives the top-level statements of a script from ScriptAST.Accept or ScriptAST.AcceptGrouped.
+// Every statement that is not overridden falls through to DefaultVisit, which does nothing.
+public abstract class ScriptVisitor
+{
+    public static StatementKind KindOf(IStatementNode node)
+    {
+        return node switch
+        {
+            ImportNode => StatementKind.Import,
+            GlobalVarNode => StatementKind.Global,
+            FuncDefNode => StatementKind.Function,
+            TypeNode => StatementKind.Type,
+            TraitNode => StatementKind.Trait,
+            EnumNode => StatementKind.Enum,
+            ImplementNode => StatementKind.Implement,
+            _ => StatementKind.Other,
+        };
+    }
+
+    public void Visit(IStatementNode node)
+    {
+        switch (node)
+        {
+            case ImportNode import:
+                VisitImport(import);
+                break;
+            case GlobalVarNode global:
+                VisitGlobal(global);
+                break;
+            case FuncDefNode func:
+                VisitFunction(func);
+                break;
+            case TypeNode type:
+                VisitType(type);
+                break;
+            case TraitNode trait:
+                VisitTrait(trait);
+                break;
+            case EnumNode @enum:
+                VisitEnum(@enum);
+                break;
+            case ImplementNode implement:
+                VisitImplement(implement);
+                break;
+            default:
+                DefaultVisit(node);
+                break;
+        }
+    }
+
+    public virtual void DefaultVisit(IStatementNode node) { }
+
+    public virtual void VisitImport(ImportNode node) => DefaultVisit(node);
+
+    public virtual void VisitGlobal(GlobalVarNode node) => DefaultVisit(node);
+
+    public virtual void VisitFunction(FuncDefNode node) => DefaultVisit(node);
+
+    public virtual void VisitType(TypeNode node) => DefaultVisit(node);
+
+    public virtual void VisitTrait(TraitNode node) => DefaultVisit(node);
+
+    public virtual void VisitEnum(EnumNode node) => DefaultVisit(node);
+
+    public virtual void VisitImplement(ImplementNode node) => DefaultVisit(node);
+}
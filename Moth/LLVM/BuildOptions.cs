@@ -4,15 +4,46 @@ namespace Moth.LLVM;
 
 public class BuildOptions
 {
-    public bool DoOptimize { get; init; } = false;
+    public OptimizationLevel OptimizationLevel { get; init; } = OptimizationLevel.O0;
+    public string? PassPipeline { get; init; } = null;
+    public string TargetCPU { get; init; } = "generic";
+    public string TargetFeatures { get; init; } = "";
     public Version Version { get; init; } = new Version();
     public CompressionLevel CompressionLevel { get; init; } = CompressionLevel.Optimal;
+    public Metadata.Codec MetadataCodec { get; init; } = Metadata.Codec.Deflate;
+    public Metadata.Codec MetadataNameCodec { get; init; } = Metadata.Codec.Deflate;
     public Language[] ExportLanguages { get; init; } = new Language[0];
+    public int CodegenJobs { get; init; } = 1;
+    public bool CompileReachableOnly { get; init; } = false;
+    public bool IsLibrary { get; init; } = false;
+    public bool LinkTimeOptimization { get; init; } = false;
 
     public bool DoExport
     {
         get { return ExportLanguages.Length > 0; }
     }
+
+    // Libraries are merged into the executable that uses them instead.
+    public bool DoLinkTimeOptimization
+    {
+        get { return LinkTimeOptimization && !IsLibrary; }
+    }
+
+    public bool DoOptimize
+    {
+        get { return OptimizationLevel != OptimizationLevel.O0 || PassPipeline != null; }
+    }
+}
+
+// Named after the standard pipelines they select.
+public enum OptimizationLevel
+{
+    O0,
+    O1,
+    O2,
+    O3,
+    Os,
+    Oz
 }
 
 public enum Language
@@ -0,0 +1,96 @@
+using Moth.AST;
+using Moth.AST.Node;
+
+namespace Moth.LLVM;
+
+// One of the partitions that function bodies are compiled in when codegen is spread over several
+// LLVM contexts. Every shard declares and defines the whole program, but only compiles the bodies
+// it claims. The first shard is the compiler that owns the output module and defines everything
+// that exists before bodies are compiled, so the other shards only hand back their own bodies.
+public sealed class CodegenShard
+{
+    private readonly HashSet<LLVMValueRef> _owned = new HashSet<LLVMValueRef>();
+    private readonly HashSet<LLVMValueRef> _declared = new HashSet<LLVMValueRef>();
+
+    public int Index { get; }
+    public int Count { get; }
+    public bool IsSealed { get; private set; }
+
+    // Stops the shard between bodies once the build has failed elsewhere.
+    public CancellationToken Cancellation { get; }
+
+    // Templates first instantiated by this shard's bodies, along with the script they are used
+    // in. The first shard builds them as well, as only its types make it into the metadata.
+    public List<(ScriptAST Script, TemplateTypeRefNode TypeRef)> Instantiations { get; } =
+        new List<(ScriptAST Script, TemplateTypeRefNode TypeRef)>();
+
+    public CodegenShard(int index, int count, CancellationToken cancellation = default)
+    {
+        Index = index;
+        Count = count;
+        Cancellation = cancellation;
+    }
+
+    // Bodies are dealt out in turn, in the order the compile pass reaches them.
+    public bool Claims(int position) => position % Count == Index;
+
+    public void Own(LLVMValueRef func) => _owned.Add(func);
+
+    // Records everything that exists before any body is compiled. Globals defined up to this
+    // point are also defined by the first shard, so they become declarations right away, before
+    // anything can fold their initializers into a body.
+    public void Seal(LLVMModuleRef module)
+    {
+        IsSealed = true;
+
+        for (var func = module.FirstFunction; func.Handle != IntPtr.Zero; func = func.NextFunction)
+        {
+            _declared.Add(func);
+        }
+
+        for (
+            var global = module.FirstGlobal;
+            global.Handle != IntPtr.Zero;
+            global = global.NextGlobal
+        )
+        {
+            _declared.Add(global);
+
+            if (global.Initializer.Handle != IntPtr.Zero && !IsPrivate(global))
+            {
+                global.Initializer = default;
+                global.Linkage = LLVMLinkage.LLVMExternalLinkage;
+            }
+        }
+    }
+
+    // Leaves the bodies this shard claimed as the only definitions it exports. Bodies the first
+    // shard also has are kept for inlining only, and whatever this shard created for its own
+    // bodies is made private so that it cannot clash with another shard's copy.
+    public void Isolate(LLVMModuleRef module)
+    {
+        for (var func = module.FirstFunction; func.Handle != IntPtr.Zero; func = func.NextFunction)
+        {
+            if (func.BasicBlocksCount == 0 || _owned.Contains(func) || IsPrivate(func))
+                continue;
+
+            func.Linkage = _declared.Contains(func)
+                ? LLVMLinkage.LLVMAvailableExternallyLinkage
+                : LLVMLinkage.LLVMPrivateLinkage;
+        }
+
+        for (
+            var global = module.FirstGlobal;
+            global.Handle != IntPtr.Zero;
+            global = global.NextGlobal
+        )
+        {
+            if (global.Initializer.Handle != IntPtr.Zero && !IsPrivate(global))
+                global.Linkage = LLVMLinkage.LLVMPrivateLinkage;
+        }
+    }
+
+    private static bool IsPrivate(LLVMValueRef value) =>
+        value.Linkage == LLVMLinkage.LLVMPrivateLinkage
+        || value.Linkage == LLVMLinkage.LLVMInternalLinkage;
+}
@@ -0,0 +1,456 @@
+using Moth.AST;
+using Moth.AST.Node;
+using Moth.LLVM.Data;
+
+namespace Moth.LLVM;
+
+// Folds expressions whose value is known at compile time, so that they are emitted as a single
+// constant instead of a chain of operator calls. It follows the rules of the intrinsic operators
+// and casts exactly, and leaves anything it cannot reproduce to the compiler, such as operations
+// that would pick a widening overload or whose result is undefined in LLVM.
+public sealed class ConstEvaluator
+{
+    private readonly LLVMCompiler _compiler;
+    private readonly HashSet<IExpressionNode> _nonConstant = new HashSet<IExpressionNode>(
+        ReferenceEqualityComparer.Instance
+    );
+
+    public ConstEvaluator(LLVMCompiler compiler)
+    {
+        _compiler = compiler;
+    }
+
+    public bool TryEvaluate(IExpressionNode expr, out Constant result)
+    {
+        // a failed expression is remembered so that compiling its operands does not retry it
+        if (_nonConstant.Contains(expr))
+        {
+            result = default;
+            return false;
+        }
+
+        if (Evaluate(expr, out result))
+            return true;
+
+        _nonConstant.Add(expr);
+        return false;
+    }
+
+    public Value Emit(Constant constant)
+    {
+        if (constant.Type is Int @int)
+        {
+            return Value.Create(
+                _compiler,
+                @int,
+                LLVMValueRef.CreateConstInt(@int.LLVMType, (ulong)constant.Bits, @int is SignedInt)
+            );
+        }
+        else if (constant.Type is Float @float)
+        {
+            return Value.Create(
+                _compiler,
+                @float,
+                LLVMValueRef.CreateConstReal(@float.LLVMType, constant.Real)
+            );
+        }
+        else
+        {
+            return AbstractInt.Create(_compiler, constant.Bits);
+        }
+    }
+
+    // The value as attributes receive it, matching the types of the literals they used to take.
+    public object ToObject(Constant constant)
+    {
+        if (constant.Type == null)
+        {
+            return constant.Bits is >= int.MinValue and <= int.MaxValue
+                ? (int)constant.Bits
+                : constant.Bits;
+        }
+        else if (constant.Type == _compiler.Bool)
+        {
+            return constant.Bits != 0;
+        }
+        else if (constant.Type is Float @float)
+        {
+            return @float.Bits == 32 ? (float)constant.Real : constant.Real;
+        }
+        else
+        {
+            return constant.Type is SignedInt ? constant.Bits : (ulong)constant.Bits;
+        }
+    }
+
+    private bool Evaluate(IExpressionNode expr, out Constant result)
+    {
+        result = default;
+
+        if (expr is LiteralNode literal)
+        {
+            return TryFromLiteral(literal.Value, out result);
+        }
+        else if (expr is SubExprNode subExpr)
+        {
+            return TryEvaluate(subExpr.Expression, out result);
+        }
+        else if (expr is InverseNode inverse)
+        {
+            if (!TryEvaluate(inverse.Expression, out Constant value) || value.Type != _compiler.Bool)
+                return false;
+
+            result = FromBool(value.Bits == 0);
+            return true;
+        }
+        else if (expr is CastNode cast)
+        {
+            return TryEvaluate(cast.Value, out Constant value)
+                && TryResolvePrimitive(cast.NewType, out Data.Type destType)
+                && TryCast(value, destType, out result);
+        }
+        else if (expr is BinaryOperationNode binaryOp)
+        {
+            return binaryOp.Type != OperationType.Assignment
+                && TryEvaluate(binaryOp.Left, out Constant left)
+                && TryEvaluate(binaryOp.Right, out Constant right)
+                && TryOperate(binaryOp.Type, left, right, out result);
+        }
+        else
+        {
+            return false;
+        }
+    }
+
+    private bool TryFromLiteral(object? value, out Constant result)
+    {
+        if (value is int i32)
+        {
+            result = new Constant(null, i32, 0);
+            return true;
+        }
+        else if (value is bool @bool)
+        {
+            result = FromBool(@bool);
+            return true;
+        }
+        else if (value is char ch)
+        {
+            result = new Constant(_compiler.UInt8, Wrap(ch, _compiler.UInt8), 0);
+            return true;
+        }
+        else if (value is float f32)
+        {
+            result = new Constant(_compiler.Float32, 0, f32);
+            return true;
+        }
+        else
+        {
+            result = default;
+            return false;
+        }
+    }
+
+    // Only plain value types are folded, so that resolving the cast has no side effects.
+    private bool TryResolvePrimitive(TypeRefNode typeRef, out Data.Type type)
+    {
+        type = null;
+
+        if (typeRef.GetType() != typeof(TypeRefNode) || typeRef.PointerDepth > 0 || typeRef.IsRef)
+            return false;
+
+        type = _compiler.ResolveType(typeRef);
+        return type is Int { Bits: <= 64 } or Float { Bits: 32 or 64 };
+    }
+
+    private bool TryCast(Constant value, Data.Type destType, out Constant result)
+    {
+        result = default;
+
+        if (value.Type == null)
+        {
+            // abstract integers only convert to integers they fit in
+            if (destType is not Int destInt || Wrap(value.Bits, destInt) != value.Bits)
+                return false;
+
+            if (destInt is UnsignedInt && value.Bits < 0)
+                return false;
+
+            result = new Constant(destInt, value.Bits, 0);
+            return true;
+        }
+        else if (value.Type is Int srcInt)
+        {
+            if (destType is Int destInt)
+            {
+                // every integer cast sign-extends, except from a bool
+                long bits =
+                    srcInt == _compiler.Bool
+                        ? value.Bits
+                        : destInt == _compiler.Bool
+                            ? value.Bits != 0
+                                ? 1
+                                : 0
+                            : SignExtend(value.Bits, srcInt.Bits);
+                result = new Constant(destInt, Wrap(bits, destInt), 0);
+            }
+            else
+            {
+                double real = srcInt is SignedInt ? value.Bits : (ulong)value.Bits;
+                result = new Constant(destType, 0, Round(real, (Float)destType));
+            }
+
+            return true;
+        }
+        else
+        {
+            if (destType is Float destFloat)
+            {
+                result = new Constant(destFloat, 0, Round(value.Real, destFloat));
+                return true;
+            }
+
+            var dest = (Int)destType;
+            double truncated = Math.Truncate(value.Real);
+
+            // out of range conversions are poison in LLVM, so they are left to the compiler
+            if (dest == _compiler.Bool || double.IsNaN(truncated))
+                return false;
+
+            if (dest is SignedInt)
+            {
+                double bound = Math.Pow(2, dest.Bits - 1);
+
+                if (truncated < -bound || truncated >= bound)
+                    return false;
+
+                result = new Constant(dest, (long)truncated, 0);
+            }
+            else
+            {
+                if (truncated < 0 || truncated >= Math.Pow(2, dest.Bits))
+                    return false;
+
+                result = new Constant(dest, (long)(ulong)truncated, 0);
+            }
+
+            return true;
+        }
+    }
+
+    private bool TryOperate(
+        OperationType opType,
+        Constant left,
+        Constant right,
+        out Constant result
+    )
+    {
+        result = default;
+
+        if (opType is OperationType.And or OperationType.Or)
+        {
+            if (left.Type != _compiler.Bool || right.Type != _compiler.Bool)
+                return false;
+
+            result = FromBool(
+                opType == OperationType.And
+                    ? left.Bits != 0 && right.Bits != 0
+                    : left.Bits != 0 || right.Bits != 0
+            );
+            return true;
+        }
+
+        if (opType == OperationType.NotEqual)
+        {
+            if (!TryOperate(OperationType.Equal, left, right, out Constant equal))
+                return false;
+
+            result = FromBool(equal.Bits == 0);
+            return true;
+        }
+
+        if (left.Type == null && right.Type == null)
+        {
+            return TryOperateAbstract(opType, left.Bits, right.Bits, out result);
+        }
+
+        if (left.Type is not Int @int)
+            return false;
+
+        // the right operand has to be of the same type, or an abstract integer that fits in it
+        if (right.Type == null)
+        {
+            if (Wrap(right.Bits, @int) != right.Bits || (@int is UnsignedInt && right.Bits < 0))
+                return false;
+        }
+        else if (right.Type != @int)
+        {
+            return false;
+        }
+
+        return @int is SignedInt
+            ? TryOperateSigned(opType, @int, left.Bits, right.Bits, out result)
+            : TryOperateUnsigned(opType, @int, (ulong)left.Bits, (ulong)right.Bits, out result);
+    }
+
+    private bool TryOperateAbstract(OperationType opType, long left, long right, out Constant result)
+    {
+        result = default;
+
+        if (right == 0 && opType is OperationType.Division or OperationType.Modulus)
+            return false;
+
+        object value = opType switch
+        {
+            OperationType.Addition => left + right,
+            OperationType.Subtraction => left - right,
+            OperationType.Multiplication => left * right,
+            OperationType.Division => left / right,
+            OperationType.Exponential => (long)Math.Pow(left, right),
+            OperationType.Modulus => left % right,
+            OperationType.LesserThan => left < right,
+            OperationType.LesserThanOrEqual => left <= right,
+            OperationType.GreaterThan => left > right,
+            OperationType.GreaterThanOrEqual => left >= right,
+            OperationType.Equal => left == right,
+            _ => null
+        };
+
+        if (value is bool @bool)
+        {
+            result = FromBool(@bool);
+        }
+        else if (value is long @long)
+        {
+            result = new Constant(null, @long, 0);
+        }
+        else
+        {
+            return false;
+        }
+
+        return true;
+    }
+
+    private bool TryOperateSigned(
+        OperationType opType,
+        Int type,
+        long left,
+        long right,
+        out Constant result
+    )
+    {
+        result = default;
+
+        if (opType is OperationType.Division or OperationType.Modulus)
+        {
+            // division by zero and overflowing division are undefined
+            if (right == 0 || (right == -1 && left == Wrap(1L << ((int)type.Bits - 1), type)))
+                return false;
+        }
+
+        object value = opType switch
+        {
+            OperationType.Addition => left + right,
+            OperationType.Subtraction => left - right,
+            OperationType.Multiplication => left * right,
+            OperationType.Division => left / right,
+            OperationType.Modulus => left % right,
+            OperationType.LesserThan => left < right,
+            OperationType.LesserThanOrEqual => left <= right,
+            OperationType.GreaterThan => left > right,
+            OperationType.GreaterThanOrEqual => left >= right,
+            OperationType.Equal => left == right,
+            _ => null
+        };
+
+        return TryWrapResult(value, type, out result);
+    }
+
+    private bool TryOperateUnsigned(
+        OperationType opType,
+        Int type,
+        ulong left,
+        ulong right,
+        out Constant result
+    )
+    {
+        result = default;
+
+        if (right == 0 && opType is OperationType.Division or OperationType.Modulus)
+            return false;
+
+        object value = opType switch
+        {
+            OperationType.Addition => (long)(left + right),
+            OperationType.Subtraction => (long)(left - right),
+            OperationType.Multiplication => (long)(left * right),
+            OperationType.Division => (long)(left / right),
+            OperationType.Modulus => (long)(left % right),
+            OperationType.LesserThan => left < right,
+            OperationType.LesserThanOrEqual => left <= right,
+            OperationType.GreaterThan => left > right,
+            OperationType.GreaterThanOrEqual => left >= right,
+            OperationType.Equal => left == right,
+            _ => null
+        };
+
+        return TryWrapResult(value, type, out result);
+    }
+
+    private bool TryWrapResult(object? value, Int type, out Constant result)
+    {
+        if (value is bool @bool)
+        {
+            result = FromBool(@bool);
+            return true;
+        }
+        else if (value is long @long)
+        {
+            result = new Constant(type, Wrap(@long, type), 0);
+            return true;
+        }
+        else
+        {
+            result = default;
+            return false;
+        }
+    }
+
+    private Constant FromBool(bool value) => new Constant(_compiler.Bool, value ? 1 : 0, 0);
+
+    // Integers are kept as their value in the type's width, sign-extended for signed types.
+    private static long Wrap(long bits, Int type)
+    {
+        if (type.Bits >= 64)
+            return bits;
+
+        int shift = 64 - (int)type.Bits;
+        return type is SignedInt ? (bits << shift) >> shift : (long)((ulong)(bits << shift) >> shift);
+    }
+
+    private static long SignExtend(long bits, uint width)
+    {
+        int shift = 64 - (int)width;
+        return width >= 64 ? bits : (bits << shift) >> shift;
+    }
+
+    private static double Round(double value, Float type) =>
+        type.Bits == 32 ? (double)(float)value : value;
+
+    // A folded value. Integers keep their bits and floats their value, and a missing type marks an
+    // abstract integer, which takes its type from where it is used just like an integer literal.
+    public readonly struct Constant
+    {
+        public Data.Type? Type { get; }
+        public long Bits { get; }
+        public double Real { get; }
+
+        public Constant(Data.Type? type, long bits, double real)
+        {
+            Type = type;
+            Bits = bits;
+            Real = real;
+        }
+    }
+}
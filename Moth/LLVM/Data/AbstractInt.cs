@@ -9,7 +9,7 @@ public class AbstractInt : PrimitiveStructDecl
     private long _value;
 
     public AbstractInt(LLVMCompiler compiler, long value)
-        : base(compiler, "__abstract_integer", LLVMTypeRef.Int32, 32)
+        : base(compiler, "__abstract_integer", compiler.Context.Int32Type, 32)
     {
         _value = value;
     }
@@ -75,6 +75,8 @@ public class AbstractInt : PrimitiveStructDecl
 
     public override bool Equals(object? obj) => obj is AbstractInt;
 
+    public override int GetHashCode() => Name.GetHashCode();
+
     public class ImplicitConversionTable : LLVM.ImplicitConversionTable
     {
         private long _value;
@@ -281,7 +283,7 @@ public class AbstractInt : PrimitiveStructDecl
                 ? Value.Create(
                     _compiler,
                     _compiler.Bool,
-                    LLVMValueRef.CreateConstInt(LLVMTypeRef.Int1, (ulong)(b ? 1 : 0))
+                    LLVMValueRef.CreateConstInt(_compiler.Context.Int1Type, (ulong)(b ? 1 : 0))
                 )
                 : AbstractInt.Create(_compiler, (long)result);
         }
@@ -5,9 +5,6 @@ namespace Moth.LLVM.Data;
 
 public class Array : Value
 {
-    public static Dictionary<Type, ArrStructDecl> ArrayTypes { get; } =
-        new Dictionary<Type, ArrStructDecl>();
-
     public override ArrStructDecl Type { get; }
     public override LLVMValueRef LLVMValue { get; }
 
@@ -31,25 +28,13 @@ public class Array : Value
         );
         compiler.Builder.BuildStore(compiler.Builder.BuildLoad2(arrLLVMType, values), arr);
         compiler.Builder.BuildStore(
-            LLVMValueRef.CreateConstInt(LLVMTypeRef.Int32, (ulong)elements.Length),
+            LLVMValueRef.CreateConstInt(compiler.Context.Int32Type, (ulong)elements.Length),
             length
         );
     }
 
-    public static ArrStructDecl ResolveType(LLVMCompiler compiler, Type elementType)
-    {
-        if (Array.ArrayTypes.TryGetValue(elementType, out ArrStructDecl type))
-        {
-            // Keep empty
-        }
-        else
-        {
-            type = new ArrStructDecl(compiler, elementType);
-            ArrayTypes.Add(elementType, type);
-        }
-
-        return type;
-    }
+    public static ArrStructDecl ResolveType(LLVMCompiler compiler, Type elementType) =>
+        compiler.TypeTable.GetArray(elementType);
 }
 
 public class ArrayIndexerFunction : DefinedFunction
@@ -63,10 +48,9 @@ public class ArrayIndexerFunction : DefinedFunction
             compiler,
             internalArrayStruct,
             Reserved.Indexer,
-            new FuncType(
-                compiler,
-                new RefType(compiler, elementType),
-                new Type[] { new PtrType(compiler, internalArrayStruct), compiler.UInt32 },
+            compiler.TypeTable.GetFunction(
+                compiler.TypeTable.GetReference(elementType),
+                new Type[] { compiler.TypeTable.GetPointer(internalArrayStruct), compiler.UInt32 },
                 false
             ),
             new Parameter[0],
@@ -83,7 +83,7 @@ public class EnumDecl : TypeDecl
                     FlagType,
                     _compiler.Builder.BuildExtractElement(
                         prev.LLVMValue,
-                        LLVMValueRef.CreateConstInt(LLVMTypeRef.Int32, 0)
+                        LLVMValueRef.CreateConstInt(_compiler.Context.Int32Type, 0)
                     )
                 );
             }
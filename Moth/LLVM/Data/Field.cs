@@ -43,7 +43,7 @@ public class Field : IContainer
     {
         return new Pointer(
             _compiler,
-            new VarType(_compiler, Type),
+            _compiler.TypeTable.GetVar(Type),
             _compiler.Builder.BuildStructGEP2(
                 (Parent as StructDecl).LLVMType,
                 parent.LLVMValue,
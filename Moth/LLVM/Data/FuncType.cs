@@ -76,7 +76,8 @@ public class FuncType : PtrType
         return builder.ToString();
     }
 
-    public override int GetHashCode() => ReturnType.GetHashCode() * ParameterTypes.GetHashes();
+    public override int GetHashCode() =>
+        HashCode.Combine(ReturnType, ParameterTypes.GetHashes(), IsVariadic);
 
     public virtual Value Call(LLVMValueRef func, Value[] args) =>
         Value.Create(
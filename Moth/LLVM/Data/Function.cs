@@ -84,6 +84,12 @@ public class DefinedFunction : Function
         Attributes = attributes;
     }
 
+    public override Value Call(Value[] args)
+    {
+        _compiler.Reach(this);
+        return base.Call(args);
+    }
+
     public Version OriginModuleVersion
     {
         get
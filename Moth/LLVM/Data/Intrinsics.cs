@@ -18,10 +18,9 @@ public abstract class IntrinsicOperator : IntrinsicFunction
         : base(
             compiler,
             Utils.ExpandOpName(Utils.OpTypeToString(opType)),
-            new FuncType(
-                compiler,
+            compiler.TypeTable.GetFunction(
                 retStructDecl,
-                new Type[] { new PtrType(compiler, leftStructDecl), rightStructDecl },
+                new Type[] { compiler.TypeTable.GetPointer(leftStructDecl), rightStructDecl },
                 false
             )
         )
@@ -99,7 +98,11 @@ public sealed class ConstRetFn : IntrinsicFunction
     private LLVMModuleRef _module { get; }
 
     public ConstRetFn(LLVMCompiler compiler, string name, Value value, LLVMModuleRef module)
-        : base(compiler, name, new FuncType(compiler, value.Type, new Type[] { }, false))
+        : base(
+            compiler,
+            name,
+            compiler.TypeTable.GetFunction(value.Type, new Type[] { }, false)
+        )
     {
         if (!value.LLVMValue.IsConstant)
         {
@@ -136,7 +139,11 @@ public sealed class Pow : IntrinsicFunction
         Type left,
         Type right
     )
-        : base(compiler, name, new FuncType(compiler, retType, new Type[] { left, right }, false))
+        : base(
+            compiler,
+            name,
+            compiler.TypeTable.GetFunction(retType, new Type[] { left, right }, false)
+        )
     {
         _module = module;
     }
@@ -15,10 +15,20 @@ public class Namespace : IContainer
     public Dictionary<string, IGlobal> GlobalVariables { get; } = new Dictionary<string, IGlobal>();
     public Dictionary<string, Template> Templates { get; } = new Dictionary<string, Template>();
 
+    // Loaded libraries with symbols in this namespace, which are only created once a lookup asks
+    // for their name.
+    private readonly List<MetadataDeserializer> _libraries = new List<MetadataDeserializer>();
+
+    // the library each type and global came from, for reporting conflicts
+    private readonly Dictionary<string, string> _typeLibraries = new Dictionary<string, string>();
+    private readonly Dictionary<string, string> _globalLibraries =
+        new Dictionary<string, string>();
+
     public Namespace(Namespace? parent, string name)
     {
         Parent = parent;
         Name = name;
+        FullName = parent == null ? name : $"{parent.FullName}::{name}";
     }
 
     public Namespace? ParentNamespace
@@ -26,227 +36,159 @@ public class Namespace : IContainer
         get { return Parent is Namespace nmspace ? nmspace : null; }
     }
 
-    public string FullName
-    {
-        get
-        {
-            if (ParentNamespace == null)
-            {
-                return Name;
-            }
-            else
-            {
-                return $"{ParentNamespace.FullName}::{Name}";
-            }
-        }
-    }
+    public string FullName { get; }
 
-    public Namespace GetNamespace(string name)
+    public void AddLibrary(MetadataDeserializer library) => _libraries.Add(library);
+
+    // Creates whatever the loaded libraries define under a name in this namespace.
+    public void Materialize(string name)
     {
-        if (Namespaces.TryGetValue(name, out Namespace nmspace))
+        foreach (MetadataDeserializer library in _libraries)
         {
-            return nmspace;
-        }
-        else
-        {
-            return ParentNamespace != null
-                ? ParentNamespace.GetNamespace(name)
-                : throw new Exception($"Namespace \"{name}\" was not found.");
+            library.Materialize(this, name);
         }
     }
 
-    public bool TryGetNamespace(string name, out Namespace nmspace)
+    // Adds a type of the project, or of the library named. The loaded libraries are asked for the
+    // name first, since their symbols are created lazily and would otherwise clash with it later.
+    public void AddType(string name, TypeDecl type, string? library = null)
     {
-        try
-        {
-            nmspace = GetNamespace(name);
+        if (library == null)
+            Materialize(name);
 
-            if (nmspace == null)
-            {
-                throw new Exception();
-            }
+        if (Types.ContainsKey(name))
+            throw Conflict("Type", name, library, _typeLibraries.GetValueOrDefault(name));
 
-            return true;
-        }
-        catch
-        {
-            nmspace = null;
-            return false;
-        }
-    }
+        Types.Add(name, type);
 
-    public Function GetFunction(string name, IReadOnlyList<Type> paramTypes)
-    {
-        if (
-            Functions.TryGetValue(name, out OverloadList overloads)
-            && overloads.TryGet(paramTypes, out Function func)
-        )
-        {
-            return func;
-        }
-        else
-        {
-            return ParentNamespace != null
-                ? ParentNamespace.GetFunction(name, paramTypes)
-                : throw new Exception($"Function \"{name}\" was not found.");
-        }
+        if (library != null)
+            _typeLibraries.Add(name, library);
     }
 
-    public bool TryGetFunction(string name, IReadOnlyList<Type> paramTypes, out Function func)
+    public void AddGlobal(string name, IGlobal global, string? library = null)
     {
-        try
-        {
-            func = GetFunction(name, paramTypes);
+        if (library == null)
+            Materialize(name);
 
-            if (func == null)
-            {
-                throw new Exception();
-            }
+        if (GlobalVariables.ContainsKey(name))
+            throw Conflict("Global", name, library, _globalLibraries.GetValueOrDefault(name));
 
-            return true;
-        }
-        catch
-        {
-            func = null;
-            return false;
-        }
-    }
+        GlobalVariables.Add(name, global);
 
-    public TypeDecl GetType(string name)
-    {
-        if (Types.TryGetValue(name, out TypeDecl type))
-        {
-            return type;
-        }
-        else
-        {
-            return ParentNamespace != null
-                ? ParentNamespace.GetType(name)
-                : throw new Exception($"Type \"{name}\" was not found in namespace \"{Name}\"");
-        }
+        if (library != null)
+            _globalLibraries.Add(name, library);
     }
 
-    public bool TryGetType(string name, out TypeDecl structDecl)
+    private Exception Conflict(string kind, string name, string? library, string? existing)
     {
-        try
-        {
-            structDecl = GetType(name);
+        return new Exception(
+            $"{kind} \"{FullName}::{name}\" {Origin(library)} conflicts with the one "
+                + $"{Origin(existing)}."
+        );
+    }
 
-            if (structDecl == null)
-            {
-                throw new Exception();
-            }
+    private static string Origin(string? library) =>
+        library == null ? "defined in this project" : $"from library \"{library}\"";
 
-            return true;
-        }
-        catch
-        {
-            structDecl = null;
-            return false;
-        }
+    public Namespace GetNamespace(string name)
+    {
+        return TryGetNamespace(name, out Namespace nmspace)
+            ? nmspace
+            : throw new Exception($"Namespace \"{name}\" was not found.");
     }
 
-    public TraitDecl GetTrait(string name)
+    public bool TryGetNamespace(string name, out Namespace nmspace) =>
+        TryFind(static n => n.Namespaces, name, out nmspace);
+
+    public Function GetFunction(string name, IReadOnlyList<Type> paramTypes)
     {
-        if (Traits.TryGetValue(name, out TraitDecl trait))
-        {
-            return trait;
-        }
-        else
-        {
-            return ParentNamespace != null
-                ? ParentNamespace.GetTrait(name)
-                : throw new Exception($"Trait \"{name}\" was not found in namespace \"{Name}\"");
-        }
+        return TryGetFunction(name, paramTypes, out Function func)
+            ? func
+            : throw new Exception($"Function \"{name}\" was not found.");
     }
 
-    public bool TryGetTrait(string name, out TraitDecl traitDecl)
+    public bool TryGetFunction(string name, IReadOnlyList<Type> paramTypes, out Function func)
     {
-        try
+        for (Namespace? nmspace = this; nmspace != null; nmspace = nmspace.ParentNamespace)
         {
-            traitDecl = GetTrait(name);
+            nmspace.Materialize(name);
 
-            if (traitDecl == null)
+            if (
+                nmspace.Functions.TryGetValue(name, out OverloadList overloads)
+                && overloads.TryGet(paramTypes, out func)
+            )
             {
-                throw new Exception();
+                return true;
             }
-
-            return true;
-        }
-        catch
-        {
-            traitDecl = null;
-            return false;
         }
+
+        func = null;
+        return false;
     }
 
-    public Template GetTemplate(string name)
+    public TypeDecl GetType(string name)
     {
-        if (Templates.TryGetValue(name, out Template template))
-        {
-            return template;
-        }
-        else
-        {
-            return ParentNamespace != null
-                ? ParentNamespace.GetTemplate(name)
-                : throw new Exception($"Template \"{name}\" was not found in namespace \"{Name}\"");
-        }
+        return TryGetType(name, out TypeDecl type)
+            ? type
+            : throw new Exception($"Type \"{name}\" was not found in namespace \"{FullName}\"");
     }
 
-    public bool TryGetTemplate(string name, out Template template)
+    public bool TryGetType(string name, out TypeDecl structDecl) =>
+        TryFind(static n => n.Types, name, out structDecl);
+
+    public TraitDecl GetTrait(string name)
     {
-        try
-        {
-            template = GetTemplate(name);
+        return TryGetTrait(name, out TraitDecl trait)
+            ? trait
+            : throw new Exception($"Trait \"{name}\" was not found in namespace \"{FullName}\"");
+    }
 
-            if (template == null)
-            {
-                throw new Exception();
-            }
+    public bool TryGetTrait(string name, out TraitDecl traitDecl) =>
+        TryFind(static n => n.Traits, name, out traitDecl);
 
-            return true;
-        }
-        catch
-        {
-            template = null;
-            return false;
-        }
+    public Template GetTemplate(string name)
+    {
+        return TryGetTemplate(name, out Template template)
+            ? template
+            : throw new Exception(
+                $"Template \"{name}\" was not found in namespace \"{FullName}\""
+            );
     }
 
+    public bool TryGetTemplate(string name, out Template template) =>
+        TryFind(static n => n.Templates, name, out template);
+
     public IGlobal GetGlobal(string name)
     {
-        if (GlobalVariables.TryGetValue(name, out IGlobal global))
-        {
-            return global;
-        }
-        else
-        {
-            return ParentNamespace != null
-                ? ParentNamespace.GetGlobal(name)
-                : throw new Exception(
-                    $"Global variable \"{name}\" was not found in namespace \"{Name}\""
-                );
-        }
+        return TryGetGlobal(name, out IGlobal global)
+            ? global
+            : throw new Exception(
+                $"Global variable \"{name}\" was not found in namespace \"{FullName}\""
+            );
     }
 
-    public bool TryGetGlobal(string name, out IGlobal globalVar)
+    public bool TryGetGlobal(string name, out IGlobal globalVar) =>
+        TryFind(static n => n.GlobalVariables, name, out globalVar);
+
+    // Looks the name up in this namespace and then in each of its parents, without throwing.
+    private bool TryFind<T>(
+        Func<Namespace, Dictionary<string, T>> getTable,
+        string name,
+        out T value
+    )
+        where T : class
     {
-        try
+        for (Namespace? nmspace = this; nmspace != null; nmspace = nmspace.ParentNamespace)
         {
-            globalVar = GetGlobal(name);
+            nmspace.Materialize(name);
 
-            if (globalVar == null)
+            if (getTable(nmspace).TryGetValue(name, out value) && value != null)
             {
-                throw new Exception();
+                return true;
             }
-
-            return true;
-        }
-        catch
-        {
-            globalVar = null;
-            return false;
         }
+
+        value = null;
+        return false;
     }
 }
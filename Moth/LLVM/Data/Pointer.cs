@@ -64,7 +64,7 @@ public class TraitPointer : Pointer
         var index = Type.BaseType.VTable.GetIndex(method);
         var vtable = compiler.Builder.BuildExtractElement(
             LLVMValue,
-            LLVMValueRef.CreateConstInt(LLVMTypeRef.Int32, 1)
+            LLVMValueRef.CreateConstInt(compiler.Context.Int32Type, 1)
         );
         var func = compiler.Builder.BuildInBoundsGEP2(method.Type.LLVMType, vtable, index);
         return method.Type.Call(func, args);
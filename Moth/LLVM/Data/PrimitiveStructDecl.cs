@@ -82,7 +82,11 @@ public sealed class ArrStructDecl : PrimitiveStructDecl
             compiler,
             $"[{elementType}]",
             compiler.Context.GetStructType(
-                new[] { new PtrType(compiler, elementType).LLVMType, LLVMTypeRef.Int32 },
+                new[]
+                {
+                    compiler.TypeTable.GetPointer(elementType).LLVMType,
+                    compiler.Context.Int32Type
+                },
                 false
             ),
             64
@@ -129,7 +133,7 @@ public sealed class ArrStructDecl : PrimitiveStructDecl
 public class Void : PrimitiveStructDecl
 {
     public Void(LLVMCompiler compiler)
-        : base(compiler, Reserved.Void, LLVMTypeRef.Void, 0) { }
+        : base(compiler, Reserved.Void, compiler.Context.VoidType, 0) { }
 
     protected override Dictionary<string, OverloadList> GenerateDefaultMethods()
     {
@@ -171,7 +175,7 @@ public class Void : PrimitiveStructDecl
 public class Null : PrimitiveStructDecl
 {
     public Null(LLVMCompiler compiler)
-        : base(compiler, Reserved.Null, LLVMTypeRef.Int8, 8) { }
+        : base(compiler, Reserved.Null, compiler.Context.Int8Type, 8) { }
 
     public override ImplicitConversionTable GetImplicitConversions() =>
         new ImplicitConversionTable(_compiler);
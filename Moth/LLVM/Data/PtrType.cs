@@ -64,7 +64,7 @@ public class PtrType : Type
     public override bool Equals(object? obj) =>
         obj is PtrType bType && BaseType.Equals(bType.BaseType);
 
-    public override int GetHashCode() => BaseType.GetHashCode();
+    public override int GetHashCode() => HashCode.Combine(TypeKind.Pointer, BaseType);
 }
 
 public class TraitPtrType : PtrType
@@ -75,7 +75,7 @@ public class TraitPtrType : PtrType
     public TraitPtrType(LLVMCompiler compiler, TraitDecl baseType)
         : base(compiler, baseType, TypeKind.Pointer)
     {
-        LLVMType = LLVMTypeRef.CreateStruct(
+        LLVMType = _compiler.Context.GetStructType(
             new LLVMTypeRef[]
             {
                 LLVMTypeRef.CreatePointer(_compiler.Int8.LLVMType, 0),
@@ -104,10 +104,14 @@ public class RefType : PtrType
         var table = new ImplicitConversionTable(_compiler);
 
         table.Add(
-            new PtrType(_compiler, BaseType),
+            _compiler.TypeTable.GetPointer(BaseType),
             (prev) =>
             {
-                return new Pointer(_compiler, new PtrType(_compiler, BaseType), prev.LLVMValue);
+                return new Pointer(
+                    _compiler,
+                    _compiler.TypeTable.GetPointer(BaseType),
+                    prev.LLVMValue
+                );
             }
         );
 
@@ -139,7 +143,7 @@ public sealed class VarType : RefType
     public override ImplicitConversionTable GetImplicitConversions()
     {
         var table = base.GetImplicitConversions();
-        table.Remove(new PtrType(_compiler, BaseType));
+        table.Remove(_compiler.TypeTable.GetPointer(BaseType));
         return table;
     }
 
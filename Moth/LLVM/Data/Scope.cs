@@ -1,13 +1,46 @@
 ﻿namespace Moth.LLVM.Data;
 
+// Holds the variables declared directly in a block, and sees those of the enclosing blocks through
+// its parent, so that entering a block does not copy every variable in scope.
 public class Scope
 {
     public LLVMBasicBlockRef LLVMBlock { get; set; }
-    public Dictionary<string, Variable> Variables { get; set; } =
-        new Dictionary<string, Variable>();
+    public Scope? Parent { get; }
+    public Dictionary<string, Variable> Variables { get; } = new Dictionary<string, Variable>();
 
-    public Scope(LLVMBasicBlockRef llvmBlock)
+    public Scope(LLVMBasicBlockRef llvmBlock, Scope? parent = null)
     {
         LLVMBlock = llvmBlock;
+        Parent = parent;
+    }
+
+    public bool TryGetVariable(string name, out Variable variable)
+    {
+        Scope? scope = this;
+
+        while (scope != null)
+        {
+            if (scope.Variables.TryGetValue(name, out variable))
+                return true;
+
+            scope = scope.Parent;
+        }
+
+        variable = null;
+        return false;
+    }
+
+    public Variable GetVariable(string name) =>
+        TryGetVariable(name, out Variable variable)
+            ? variable
+            : throw new Exception($"Variable \"{name}\" does not exist in the current scope.");
+
+    // Variables cannot shadow one another, including those of an enclosing block.
+    public void AddVariable(string name, Variable variable)
+    {
+        if (TryGetVariable(name, out _))
+            throw new Exception($"Variable \"{name}\" is already defined in the current scope.");
+
+        Variables.Add(name, variable);
     }
 }
@@ -180,7 +180,7 @@ public class StructDecl : TypeDecl
         return new Variable(
             _compiler,
             Reserved.Self,
-            new VarType(_compiler, this),
+            _compiler.TypeTable.GetVar(this),
             _compiler.Builder.BuildAlloca(LLVMType)
         );
     }
@@ -196,7 +196,15 @@ public class OpaqueStructDecl : StructDecl
         bool isUnion,
         Dictionary<string, IAttribute> attributes
     )
-        : base(compiler, parent, name, privacy, isUnion, attributes, decl => LLVMTypeRef.Int8) { }
+        : base(
+            compiler,
+            parent,
+            name,
+            privacy,
+            isUnion,
+            attributes,
+            decl => compiler.Context.Int8Type
+        ) { }
 
     public override StructDecl AddBuiltins() => this;
 }
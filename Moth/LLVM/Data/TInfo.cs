@@ -6,7 +6,7 @@ public class TInfo //TODO: compiler data?
 
     public TInfo(LLVMCompiler compiler, TypeDecl typeDecl)
     {
-        var llvmType = LLVMTypeRef.CreateInt(128);
+        var llvmType = compiler.Context.GetIntType(128);
         var global = compiler.Module.AddGlobal(llvmType, $"<TInfo/{typeDecl.FullName}>");
 
         global.Initializer = LLVMValueRef.CreateConstIntOfArbitraryPrecision(
@@ -19,7 +19,8 @@ public class Template : ICompilerData
 
     private LLVMCompiler _compiler;
     private List<AttributeNode> _attributeList;
-    private Dictionary<string, StructDecl> _builtTypes = new Dictionary<string, StructDecl>();
+    private Dictionary<TypeSignature, StructDecl> _builtTypes =
+        new Dictionary<TypeSignature, StructDecl>();
 
     public Template(
         LLVMCompiler compiler,
@@ -51,7 +52,7 @@ public class Template : ICompilerData
                 attribute.Name,
                 _compiler.MakeAttribute(
                     attribute.Name,
-                    LLVMCompiler.CleanAttributeArgs(attribute.Arguments.ToArray())
+                    _compiler.CleanAttributeArgs(attribute.Arguments.ToArray())
                 )
             );
         }
@@ -70,10 +71,8 @@ public class Template : ICompilerData
         }
     }
 
-    public StructDecl Build(IReadOnlyList<IExpressionNode> args)
+    public StructDecl Build(IReadOnlyList<Type> args)
     {
-        string sig = ArgsToSig(args);
-
         if (args.Count != Params.Length)
         {
             throw new Exception(
@@ -81,40 +80,21 @@ public class Template : ICompilerData
             );
         }
 
-        if (_builtTypes.TryGetValue(sig, out StructDecl @struct))
+        if (_builtTypes.TryGetValue(new TypeSignature(args), out StructDecl @struct))
         {
             return @struct;
         }
 
-        for (var i = 0; i < Params.Length; i++)
+        foreach (TemplateParameter param in Params)
         {
-            var param = Params[i];
-            var arg = args[i];
-
             if (param.IsConst)
             {
-                if (arg is not LiteralNode literal)
-                {
-                    throw new Exception(
-                        $"Template argument {i} for template \"{Name}\" is expected to be a constant value."
-                    );
-                }
-
-                throw new NotImplementedException();
-            }
-            else
-            {
-                if (arg is not TypeRefNode typeRef)
-                {
-                    throw new Exception(
-                        $"Template argument {i} for template \"{Name}\" is expected to be a type."
-                    );
-                }
+                throw new NotImplementedException(); //TODO: constant template arguments
             }
         }
 
         var structNode = new TypeNode(
-            $"{Name}{Template.ArgsToSig(args)}",
+            GetInstanceName(Name, args),
             Privacy,
             new ScopeNode(new List<IStatementNode>(Members)),
             IsUnion,
@@ -129,23 +109,17 @@ public class Template : ICompilerData
             Attributes,
             Fields
         );
-        _builtTypes.Add(sig, @struct);
+        _builtTypes.Add(new TypeSignature(args.ToArray()), @struct);
+
+        // registered like any other type so that the instantiation is exported with the module
+        Parent.Types.TryAdd(structNode.Name, @struct);
+        _compiler.Types.Add(@struct);
         _compiler.BuildTemplate(this, structNode, @struct, args);
         return @struct;
     }
 
-    public static string ArgsToSig(IReadOnlyList<IExpressionNode> args)
-    {
-        var builder = new StringBuilder();
-
-        builder.Append('<');
-
-        foreach (var arg in args)
-        {
-            builder.Append(',');
-        }
-
-        builder.Append('>');
-        return builder.ToString(); //TODO: improve
-    }
+    // Names an instantiation after its canonical arguments, so that the same instantiation gets the
+    // same name in every module.
+    public static string GetInstanceName(string name, IReadOnlyList<Type> args) =>
+        $"{name}<{String.Join(", ", args)}>";
 }
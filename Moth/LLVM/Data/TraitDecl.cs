@@ -21,7 +21,7 @@ public class TraitDecl : TypeDecl
         PrivacyType privacy,
         Dictionary<string, IAttribute> attributes
     )
-        : base(compiler, parent, name, (decl) => LLVMTypeRef.Int8, privacy, attributes) { }
+        : base(compiler, parent, name, (decl) => compiler.Context.Int8Type, privacy, attributes) { }
 
     public Function GetMethod(string name, IReadOnlyList<Type> paramTypes)
     {
@@ -33,19 +33,10 @@ public class Type : ICompilerData
         get { throw new NotImplementedException(); }
     }
 
-    public bool CanConvertTo(Type other)
-    {
-        if (Equals(other))
-            return true;
-        return GetImplicitConversions().Contains(other);
-    }
+    public bool CanConvertTo(Type other) => _compiler.TypeTable.CanConvert(this, other);
 
     public virtual ImplicitConversionTable GetImplicitConversions() =>
         new ImplicitConversionTable(_compiler);
 
     public override string ToString() => throw new NotImplementedException();
-
-    public override bool Equals(object? obj) => throw new NotImplementedException();
-
-    public override int GetHashCode() => (int)Kind;
 }
@@ -126,7 +126,7 @@ public class TypeDecl : Type, IContainer
         {
             LLVMValueRef retValue =
                 LLVMType.Kind == LLVMTypeKind.LLVMVoidTypeKind
-                    ? LLVMValueRef.CreateConstInt(LLVMTypeRef.Int64, 0)
+                    ? LLVMValueRef.CreateConstInt(_compiler.Context.Int64Type, 0)
                     : LLVMType.SizeOf;
 
             var value = Value.Create(_compiler, _compiler.UInt64, retValue);
@@ -139,7 +139,7 @@ public class TypeDecl : Type, IContainer
         {
             LLVMValueRef retValue =
                 LLVMType.Kind == LLVMTypeKind.LLVMVoidTypeKind
-                    ? LLVMValueRef.CreateConstInt(LLVMTypeRef.Int64, 1)
+                    ? LLVMValueRef.CreateConstInt(_compiler.Context.Int64Type, 1)
                     : LLVMType.AlignOf;
 
             var value = Value.Create(_compiler, _compiler.UInt64, retValue);
@@ -221,18 +221,28 @@ public class TypeDecl : Type, IContainer
         out Function func
     )
     {
-        try
+        if (
+            StaticMethods.TryGetValue(name, out OverloadList overloads)
+            && overloads.TryGet(paramTypes, out func)
+        )
         {
-            func = GetFunction(name, paramTypes, currentTypeDecl, recursive);
-
-            if (func == null)
+            if (
+                func is DefinedFunction defFunc
+                && defFunc.Privacy == PrivacyType.Priv
+                && currentTypeDecl != this
+            )
             {
-                throw new Exception();
+                func = null;
+                return false;
             }
 
             return true;
         }
-        catch
+        else if (recursive)
+        {
+            return ParentNamespace.TryGetFunction(name, paramTypes, out func);
+        }
+        else
         {
             func = null;
             return false;
@@ -243,5 +253,5 @@ public class TypeDecl : Type, IContainer
 
     public override bool Equals(object? obj) => obj is TypeDecl type && UUID == type.UUID;
 
-    public override int GetHashCode() => Name.GetHashCode() * Privacy.GetHashCode();
+    public override int GetHashCode() => UUID.GetHashCode();
 }
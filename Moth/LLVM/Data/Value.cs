@@ -50,7 +50,7 @@ public class Value : ICompilerData
 
         LLVMValueRef newVal = _compiler.Builder.BuildAlloca(Type.LLVMType);
         _compiler.Builder.BuildStore(LLVMValue, newVal);
-        return new Pointer(_compiler, new RefType(_compiler, Type), newVal);
+        return new Pointer(_compiler, _compiler.TypeTable.GetReference(Type), newVal);
     }
 
     public virtual Value DeRef()
@@ -82,6 +82,6 @@ public class Value : ICompilerData
     {
         var tempPtr = compiler.Builder.BuildAlloca(temporary.Type.LLVMType);
         compiler.Builder.BuildStore(temporary.LLVMValue, tempPtr);
-        return new Pointer(compiler, new PtrType(compiler, temporary.Type), tempPtr);
+        return new Pointer(compiler, compiler.TypeTable.GetPointer(temporary.Type), tempPtr);
     }
 }
@@ -1,5 +1,5 @@
-﻿using System.IO.Compression;
-using System.Reflection;
+﻿using System.Reflection;
+using System.Runtime.ExceptionServices;
 using System.Runtime.InteropServices.ComTypes;
 using System.Text.RegularExpressions;
 using LLVMSharp;
@@ -37,9 +37,10 @@ public class LLVMCompiler : IDisposable
     public LLVMContextRef Context { get; }
     public LLVMModuleRef Module { get; }
     public LLVMBuilderRef Builder { get; set; }
-    public LLVMPassManagerRef FunctionPassManager { get; }
     public Namespace GlobalNamespace { get; }
     public HeaderBuilder Header { get; }
+    public TypeTable TypeTable { get; }
+    public ConstEvaluator ConstEvaluator { get; }
     public List<TypeDecl> Types { get; } = new List<TypeDecl>();
     public List<EnumDecl> Enums { get; } = new List<EnumDecl>();
     public List<TraitDecl> Traits { get; } = new List<TraitDecl>();
@@ -47,21 +48,60 @@ public class LLVMCompiler : IDisposable
     public List<IGlobal> Globals { get; } = new List<IGlobal>();
     public Func<string, IReadOnlyList<object>, IAttribute> MakeAttribute { get; }
 
+    // the attribute types are found through reflection once per process
+    private static readonly Lazy<Func<string, IReadOnlyList<object>, IAttribute>> AttributeFactory =
+        new Lazy<Func<string, IReadOnlyList<object>, IAttribute>>(
+            () => IAttribute.MakeCreationFunction(Assembly.GetExecutingAssembly().GetTypes())
+        );
+
     private readonly Logger _logger;
     private readonly Dictionary<string, IntrinsicFunction> _intrinsics =
         new Dictionary<string, IntrinsicFunction>();
     private readonly Dictionary<string, FuncType> _foreigns = new Dictionary<string, FuncType>();
     private Dictionary<string, Data.Type> _anonTypes = new Dictionary<string, Data.Type>();
     private Namespace[] _imports = null;
+    private readonly ResolutionCache<Namespace> _namespaceResolutions =
+        new ResolutionCache<Namespace>();
+    private readonly ResolutionCache<TypeDecl> _typeResolutions = new ResolutionCache<TypeDecl>();
+    private readonly ResolutionCache<TraitDecl> _traitResolutions =
+        new ResolutionCache<TraitDecl>();
+    private readonly ResolutionCache<Template> _templateResolutions =
+        new ResolutionCache<Template>();
+    private readonly List<string> _libraries = new List<string>();
+    private readonly List<MetadataDeserializer> _loadedLibraries =
+        new List<MetadataDeserializer>();
+    private readonly Dictionary<Function, DeferredBody> _deferred =
+        new Dictionary<Function, DeferredBody>(ReferenceEqualityComparer.Instance);
+    private readonly HashSet<Function> _reached = new HashSet<Function>(
+        ReferenceEqualityComparer.Instance
+    );
+    private readonly Queue<Function> _worklist = new Queue<Function>();
+    private CodegenShard? _shard;
+    private ScriptAST? _script;
+    private LLVMTargetMachineRef _targetMachine;
     private Namespace? _currentNamespace;
     private Function? _currentFunction;
 
+    // Every compiler owns its context, so that a process which builds more than once does not keep
+    // the types and constants of every build in the global context.
     public LLVMCompiler(string moduleName, Logger parentLogger, BuildOptions options)
+        : this(moduleName, parentLogger, options, LLVMContextRef.Create(), null) { }
+
+    private LLVMCompiler(
+        string moduleName,
+        Logger parentLogger,
+        BuildOptions options,
+        LLVMContextRef context,
+        CodegenShard? shard
+    )
     {
-        _logger = parentLogger.MakeSubLogger("llvm");
+        _logger = parentLogger.MakeSubLogger(shard == null ? "llvm" : $"shard{shard.Index}");
+        _shard = shard;
+        TypeTable = new TypeTable(this);
+        ConstEvaluator = new ConstEvaluator(this);
         ModuleName = moduleName;
         Options = options;
-        Context = LLVMContextRef.Global;
+        Context = context;
         Builder = Context.CreateBuilder();
         Module = Context.CreateModuleWithName(ModuleName);
         Header = new HeaderBuilder(this);
@@ -69,49 +109,27 @@ public class LLVMCompiler : IDisposable
         Null = new Null(this);
         Void = new Void(this);
 
-        Bool = new UnsignedInt(this, Reserved.Bool, LLVMTypeRef.Int1, 1);
-        UInt8 = new UnsignedInt(this, Reserved.UInt8, LLVMTypeRef.Int8, 8);
-        UInt16 = new UnsignedInt(this, Reserved.UInt16, LLVMTypeRef.Int16, 16);
-        UInt32 = new UnsignedInt(this, Reserved.UInt32, LLVMTypeRef.Int32, 32);
-        UInt64 = new UnsignedInt(this, Reserved.UInt64, LLVMTypeRef.Int64, 64);
-        UInt128 = new UnsignedInt(this, Reserved.UInt128, LLVMTypeRef.CreateInt(128), 128);
+        Bool = new UnsignedInt(this, Reserved.Bool, Context.Int1Type, 1);
+        UInt8 = new UnsignedInt(this, Reserved.UInt8, Context.Int8Type, 8);
+        UInt16 = new UnsignedInt(this, Reserved.UInt16, Context.Int16Type, 16);
+        UInt32 = new UnsignedInt(this, Reserved.UInt32, Context.Int32Type, 32);
+        UInt64 = new UnsignedInt(this, Reserved.UInt64, Context.Int64Type, 64);
+        UInt128 = new UnsignedInt(this, Reserved.UInt128, Context.GetIntType(128), 128);
 
-        Int8 = new SignedInt(this, Reserved.Int8, LLVMTypeRef.Int8, 8);
-        Int16 = new SignedInt(this, Reserved.Int16, LLVMTypeRef.Int16, 16);
-        Int32 = new SignedInt(this, Reserved.Int32, LLVMTypeRef.Int32, 32);
-        Int64 = new SignedInt(this, Reserved.Int64, LLVMTypeRef.Int64, 64);
-        Int128 = new SignedInt(this, Reserved.Int128, LLVMTypeRef.CreateInt(128), 128);
+        Int8 = new SignedInt(this, Reserved.Int8, Context.Int8Type, 8);
+        Int16 = new SignedInt(this, Reserved.Int16, Context.Int16Type, 16);
+        Int32 = new SignedInt(this, Reserved.Int32, Context.Int32Type, 32);
+        Int64 = new SignedInt(this, Reserved.Int64, Context.Int64Type, 64);
+        Int128 = new SignedInt(this, Reserved.Int128, Context.GetIntType(128), 128);
 
-        Float16 = new Float(this, Reserved.Float16, LLVMTypeRef.Half, 16);
-        Float32 = new Float(this, Reserved.Float32, LLVMTypeRef.Float, 32);
-        Float64 = new Float(this, Reserved.Float64, LLVMTypeRef.Double, 64);
+        Float16 = new Float(this, Reserved.Float16, Context.HalfType, 16);
+        Float32 = new Float(this, Reserved.Float32, Context.FloatType, 32);
+        Float64 = new Float(this, Reserved.Float64, Context.DoubleType, 64);
 
         GlobalNamespace = InitGlobalNamespace();
         AddDefaultForeigns();
 
-        if (Options.DoOptimize)
-        {
-            Log("(unsafe) Creating function optimization pass manager...");
-
-            unsafe
-            {
-                FunctionPassManager = LLVMSharp.Interop.LLVM.CreateFunctionPassManagerForModule(
-                    Module
-                );
-
-                LLVMSharp.Interop.LLVM.AddInstructionCombiningPass(FunctionPassManager);
-                LLVMSharp.Interop.LLVM.AddReassociatePass(FunctionPassManager);
-                LLVMSharp.Interop.LLVM.AddGVNPass(FunctionPassManager);
-                LLVMSharp.Interop.LLVM.AddCFGSimplificationPass(FunctionPassManager);
-
-                LLVMSharp.Interop.LLVM.InitializeFunctionPassManager(FunctionPassManager);
-            }
-        }
-
-        Log("Registering compiler attributes...");
-        MakeAttribute = IAttribute.MakeCreationFunction(
-            Assembly.GetExecutingAssembly().GetTypes().ToArray()
-        );
+        MakeAttribute = AttributeFactory.Value;
     }
 
     public LLVMCompiler(
@@ -122,6 +140,44 @@ public class LLVMCompiler : IDisposable
     )
         : this(moduleName, parentLogger, options) => Compile(scripts);
 
+    // The machine the module is built for, which is the host, tuned for the CPU and features in
+    // the build options. It is only created when something needs it, since the targets have to be
+    // initialized first.
+    public unsafe LLVMTargetMachineRef TargetMachine
+    {
+        get
+        {
+            if (_targetMachine == default)
+            {
+                string triple = LLVMTargetRef.DefaultTriple;
+                bool native = Options.TargetCPU == "native";
+
+                _targetMachine = LLVMTargetRef
+                    .GetTargetFromTriple(triple)
+                    .CreateTargetMachine(
+                        triple,
+                        native
+                            ? TakeMessage(LLVMSharp.Interop.LLVM.GetHostCPUName())
+                            : Options.TargetCPU,
+                        native && Options.TargetFeatures == ""
+                            ? TakeMessage(LLVMSharp.Interop.LLVM.GetHostCPUFeatures())
+                            : Options.TargetFeatures,
+                        Options.OptimizationLevel switch
+                        {
+                            OptimizationLevel.O0 => LLVMCodeGenOptLevel.LLVMCodeGenLevelNone,
+                            OptimizationLevel.O1 => LLVMCodeGenOptLevel.LLVMCodeGenLevelLess,
+                            OptimizationLevel.O3 => LLVMCodeGenOptLevel.LLVMCodeGenLevelAggressive,
+                            _ => LLVMCodeGenOptLevel.LLVMCodeGenLevelDefault,
+                        },
+                        LLVMRelocMode.LLVMRelocPIC,
+                        LLVMCodeModel.LLVMCodeModelDefault
+                    );
+            }
+
+            return _targetMachine;
+        }
+    }
+
     public Version ModuleVersion
     {
         get => Options.Version;
@@ -167,168 +223,214 @@ public class LLVMCompiler : IDisposable
 
     public LLVMCompiler Compile(IReadOnlyCollection<ScriptAST> scripts)
     {
-        foreach (ScriptAST script in scripts)
+        RunPass(new DeclarePass(this), scripts);
+        RunPass(new DefinePass(this), scripts);
+
+        if (Options.CompileReachableOnly)
         {
-            OpenFile(script.Namespace, script.Imports.ToArray());
+            if (Options.CodegenJobs > 1)
+                Warn("Function bodies are compiled in one shard when only reachable ones are.");
 
-            foreach (TypeNode typeNode in script.TypeNodes)
-            {
-                if (typeNode is TypeTemplateNode typeTemplateNode)
-                {
-                    PrepareTypeTemplate(typeTemplateNode);
-                }
-                else
-                {
-                    DefineType(typeNode);
-                }
-            }
+            RunPass(new CompilePass(this), scripts);
+            CompileReachable();
+        }
+        else if (Options.CodegenJobs > 1)
+        {
+            CompileSharded(scripts);
+        }
+        else
+        {
+            RunPass(new CompilePass(this), scripts);
+        }
 
-            foreach (TraitNode traitNode in script.TraitNodes)
-            {
-                if (traitNode is TraitTemplateNode traitTemplateNode)
-                {
-                    PrepareTraitTemplate(traitTemplateNode);
-                }
-                else
-                {
-                    DefineTrait(traitNode);
-                }
-            }
+        foreach (var type in Types)
+        {
+            if (type.TInfo == null && !type.IsExternal)
+                Warn($"Type \"{type.FullName}\" has no registered TypeInfo constant.");
+        }
 
-            foreach (EnumNode enumNode in script.EnumNodes)
-            {
-                if (enumNode is EnumTemplateNode enumTemplateNode)
-                {
-                    PrepareEnumTemplate(enumTemplateNode);
-                }
-                else
-                {
-                    DefineEnum(enumNode);
-                }
-            }
+        if (Options.DoLinkTimeOptimization)
+        {
+            // the lto pipeline expects modules that were already simplified, as libraries are when
+            // they are built, so this module gets the same treatment before they are merged
+            if (Options.DoOptimize && Options.PassPipeline == null)
+                RunPipeline($"lto-pre-link<{Options.OptimizationLevel}>");
+
+            LinkLibraries();
         }
 
-        foreach (ScriptAST script in scripts)
+        if (Options.DoOptimize)
+            Optimize();
+
+        return this;
+    }
+
+    // Merges the modules of every loaded library into this one, and hides everything that is not
+    // an entry point, so that the optimizer can inline across modules and drop what is unused.
+    public unsafe void LinkLibraries()
+    {
+        foreach (string path in _libraries)
         {
-            OpenFile(script.Namespace, script.Imports.ToArray());
+            Log($"(unsafe) Linking \"{path}\" for link-time optimization...");
 
-            foreach (GlobalVarNode global in script.GlobalVariables)
-            {
-                DefineGlobal(global);
-            }
+            if (LLVMSharp.Interop.LLVM.LinkModules2(Module, LoadLLVMModule(path)) != 0)
+                throw new Exception($"Cannot link \"{path}\" into the output module.");
+        }
+
+        var entryPoints = new HashSet<string> { Reserved.Main };
 
-            foreach (FuncDefNode funcDefNode in script.GlobalFunctions)
+        foreach (DefinedFunction func in Header.Functions)
+        {
+            entryPoints.Add(func.LLVMValue.Name);
+
+            foreach (Language lang in Options.ExportLanguages)
             {
-                DefineFunction(funcDefNode);
+                entryPoints.Add(Utils.MakeStubName(lang, func.FullName));
             }
+        }
 
-            foreach (TypeNode structNode in script.TypeNodes)
-            {
-                if (structNode is not TypeTemplateNode)
-                {
-                    var attributes = new Dictionary<string, IAttribute>();
+        for (var func = Module.FirstFunction; func.Handle != IntPtr.Zero; func = func.NextFunction)
+        {
+            if (func.BasicBlocksCount > 0 && !entryPoints.Contains(func.Name))
+                Internalize(func);
+        }
 
-                    foreach (AttributeNode attribute in structNode.Attributes)
-                    {
-                        attributes.Add(
-                            attribute.Name,
-                            MakeAttribute(
-                                attribute.Name,
-                                CleanAttributeArgs(attribute.Arguments.ToArray())
-                            )
-                        );
-                    }
+        for (
+            var global = Module.FirstGlobal;
+            global.Handle != IntPtr.Zero;
+            global = global.NextGlobal
+        )
+        {
+            if (global.Initializer.Handle != IntPtr.Zero)
+                Internalize(global);
+        }
+    }
 
-                    if (
-                        !(
-                            attributes.TryGetValue(Reserved.TargetOS, out IAttribute targetOS)
-                            && !((TargetOSAttribute)targetOS).Targets.Contains(Utils.GetOS())
-                        )
-                    )
-                    {
-                        TypeDecl typeDecl = GetType(structNode.Name);
+    // Runs the standard pipeline of the optimization level, or the custom one if it was given,
+    // over the whole module.
+    public void Optimize()
+    {
+        RunPipeline(
+            Options.PassPipeline
+                ?? (
+                    Options.DoLinkTimeOptimization
+                        ? $"lto<{Options.OptimizationLevel}>"
+                        : $"default<{Options.OptimizationLevel}>"
+                )
+        );
+    }
 
-                        if (!structNode.IsOpaque)
-                        {
-                            foreach (FuncDefNode funcDefNode in structNode.Functions)
-                            {
-                                DefineFunction(funcDefNode, typeDecl);
-                            }
-                        }
-                    }
-                }
-            }
+    private unsafe void RunPipeline(string pipeline)
+    {
+        bool vectorize = Options.OptimizationLevel >= OptimizationLevel.O2;
 
-            foreach (ImplementNode implementNode in script.ImplementNodes)
-            {
-                var trait = GetTrait(implementNode.Trait.Name); //TODO: traits should be treated like types, *mostly*
+        Log($"(unsafe) Running optimization pipeline \"{pipeline}\"...");
+        ApplyTarget();
 
-                if (ResolveType(implementNode.Type) is not StructDecl type)
-                    throw new Exception($"Cannot implement non-trait \"{implementNode.Type}\".");
+        var options = LLVMSharp.Interop.LLVM.CreatePassBuilderOptions();
+        LLVMSharp.Interop.LLVM.PassBuilderOptionsSetLoopVectorization(options, vectorize ? 1 : 0);
+        LLVMSharp.Interop.LLVM.PassBuilderOptionsSetSLPVectorization(options, vectorize ? 1 : 0);
 
-                if (trait.IsExternal && type.IsExternal)
-                    throw new Exception(
-                        $"Cannot implement external trait \"{trait.FullName}\" for external type \"{type.FullName}\"."
-                    );
+        var buffer = new byte[Encoding.UTF8.GetMaxByteCount(pipeline.Length) + 1];
+        var count = Encoding.UTF8.GetBytes(pipeline, buffer);
+        buffer[count] = 0;
+        LLVMOpaqueError* error;
 
-                ImplementTraitForType(trait, type, implementNode.Implementations);
-            }
+        fixed (byte* ptr = buffer)
+        {
+            error = LLVMSharp.Interop.LLVM.RunPasses(Module, (sbyte*)ptr, TargetMachine, options);
         }
 
-        foreach (ScriptAST script in scripts)
+        LLVMSharp.Interop.LLVM.DisposePassBuilderOptions(options);
+
+        if (error != null)
         {
-            OpenFile(script.Namespace, script.Imports.ToArray());
+            sbyte* message = LLVMSharp.Interop.LLVM.GetErrorMessage(error);
+            var text = new string(message);
 
-            foreach (FuncDefNode funcDefNode in script.GlobalFunctions)
-            {
-                CompileFunction(funcDefNode);
-            }
+            LLVMSharp.Interop.LLVM.DisposeErrorMessage(message);
+            throw new Exception($"Cannot run optimization pipeline \"{pipeline}\": {text}");
+        }
+    }
 
-            foreach (TypeNode structNode in script.TypeNodes)
-            {
-                if (structNode is not TypeTemplateNode)
-                {
-                    var attributes = new Dictionary<string, IAttribute>();
+    // Generates machine code for the module and writes it to a native object file.
+    public void EmitObjectFile(string path)
+    {
+        Log($"Emitting object file \"{path}\"...");
+        ApplyTarget();
+        TargetMachine.EmitToFile(Module, path, LLVMCodeGenFileType.LLVMObjectFile);
+    }
 
-                    foreach (AttributeNode attribute in structNode.Attributes)
-                    {
-                        attributes.Add(
-                            attribute.Name,
-                            MakeAttribute(
-                                attribute.Name,
-                                CleanAttributeArgs(attribute.Arguments.ToArray())
-                            )
-                        );
-                    }
+    // Runs main in this process through MCJIT instead of linking an executable. The Moth libraries
+    // have to be merged into the module first, and the C libraries loaded into the process.
+    public int RunMain(IReadOnlyList<string> args)
+    {
+        if (Module.GetNamedFunction(Reserved.Main).Handle == IntPtr.Zero)
+            throw new Exception("Cannot run a module without a main function.");
 
-                    if (
-                        !(
-                            attributes.TryGetValue(Reserved.TargetOS, out IAttribute targetOS)
-                            && !((TargetOSAttribute)targetOS).Targets.Contains(Utils.GetOS())
-                        )
-                    )
-                    {
-                        TypeDecl typeDecl = GetType(structNode.Name);
+        Log("Running main through the JIT...");
+        ApplyTarget();
 
-                        if (!structNode.IsOpaque)
-                        {
-                            foreach (FuncDefNode funcDefNode in structNode.Functions)
-                            {
-                                CompileFunction(funcDefNode, typeDecl);
-                            }
-                        }
-                    }
-                }
-            }
+        // the engine takes ownership of the module it runs, so it is given a copy
+        var module = Module.Clone();
+        var engine = module.CreateExecutionEngine();
+
+        try
+        {
+            return engine.RunFunctionAsMain(
+                module.GetNamedFunction(Reserved.Main),
+                (uint)args.Count + 1,
+                args.Prepend(ModuleName).ToArray(),
+                new string[0]
+            );
+        }
+        finally
+        {
+            engine.Dispose();
         }
+    }
 
-        foreach (var type in Types)
+    // Makes the symbols of a shared library available to code run through the JIT.
+    public unsafe void LoadNativeLibrary(string path)
+    {
+        var buffer = new byte[Encoding.UTF8.GetMaxByteCount(path.Length) + 1];
+        var count = Encoding.UTF8.GetBytes(path, buffer);
+        buffer[count] = 0;
+
+        fixed (byte* ptr = buffer)
         {
-            if (type.TInfo == null && !type.IsExternal)
-                Warn($"Type \"{type.FullName}\" has no registered TypeInfo constant.");
+            if (LLVMSharp.Interop.LLVM.LoadLibraryPermanently((sbyte*)ptr) != 0)
+                throw new Exception($"Cannot load \"{path}\" into the JIT.");
         }
+    }
 
-        return this;
+    private static void Internalize(LLVMValueRef value)
+    {
+        if (value.Linkage != LLVMLinkage.LLVMPrivateLinkage)
+            value.Linkage = LLVMLinkage.LLVMInternalLinkage;
+    }
+
+    // Sets the triple and data layout of the module to those of the target machine.
+    private unsafe void ApplyTarget()
+    {
+        var layout = LLVMSharp.Interop.LLVM.CreateTargetDataLayout(TargetMachine);
+        Module.Target = LLVMTargetRef.DefaultTriple;
+        LLVMSharp.Interop.LLVM.SetModuleDataLayout(Module, layout);
+        LLVMSharp.Interop.LLVM.DisposeTargetData(layout);
+    }
+
+    private static unsafe string TakeMessage(sbyte* message)
+    {
+        var text = new string(message);
+        LLVMSharp.Interop.LLVM.DisposeMessage(message);
+        return text;
+    }
+
+    // Marks a function as used, so that its body is compiled when only reachable ones are.
+    public void Reach(Function func)
+    {
+        if (Options.CompileReachableOnly && _reached.Add(func))
+            _worklist.Enqueue(func);
     }
 
     public IntrinsicFunction GetIntrinsic(string name) =>
@@ -350,6 +452,7 @@ public class LLVMCompiler : IDisposable
                 {
                     var @new = new Namespace(value, nmspace.Name);
                     value.Namespaces.Add(nmspace.Name, @new);
+                    ClearResolutions();
                     value = @new;
                 }
             }
@@ -363,6 +466,7 @@ public class LLVMCompiler : IDisposable
                 {
                     var @new = new Namespace(GlobalNamespace, nmspace.Name);
                     GlobalNamespace.Namespaces.Add(nmspace.Name, @new);
+                    ClearResolutions();
                     value = @new;
                 }
             }
@@ -373,7 +477,7 @@ public class LLVMCompiler : IDisposable
         return value;
     }
 
-    public Namespace[] ResolveImports(ImportNode[] imports)
+    public Namespace[] ResolveImports(IReadOnlyList<ImportNode> imports)
     {
         List<Namespace> result = new List<Namespace>();
 
@@ -393,77 +497,140 @@ public class LLVMCompiler : IDisposable
 
     public void Error(string message) => _logger.Error(message);
 
-    public unsafe void LoadLibrary(string path)
+    public void LoadLibrary(string path) => LoadLibraries(new[] { path });
+
+    // Reads, decompresses and decodes the metadata of the libraries in parallel, then adds them to
+    // the namespaces one at a time in the order given. Failures are reported at the point of the
+    // merge where the library would have been loaded, so the result is the same as a serial load.
+    public void LoadLibraries(IReadOnlyList<string> paths)
     {
-        using (var module = LoadLLVMModule(path))
-        {
-            var match = Regex.Match(Path.GetFileName(path), "(.*)(?=\\.mothlib.bc)");
+        var libraries = new MetadataDeserializer[paths.Count];
+        var failures = new ExceptionDispatchInfo?[paths.Count];
 
-            if (!match.Success)
+        Parallel.For(
+            0,
+            paths.Count,
+            i =>
             {
-                throw new Exception(
-                    $"Cannot load mothlibs, \"{path}\" does not have the correct extension."
-                );
+                try
+                {
+                    libraries[i] = DecodeLibrary(paths[i]);
+                }
+                catch (Exception e)
+                {
+                    failures[i] = ExceptionDispatchInfo.Capture(e);
+                }
             }
+        );
 
-            var libName = match.Value;
-            var global = module.GetNamedGlobal($"<{libName}/metadata>");
-            match = Regex.Match(global.ToString(), "(?<=<metadata>)(.*)(?=<\\/metadata>)");
+        for (int i = 0; i < paths.Count; i++)
+        {
+            _libraries.Add(paths[i]);
+            failures[i]?.Throw();
+            libraries[i].Process();
 
-            if (!match.Success)
+            foreach (MetadataDeserializer loaded in _loadedLibraries)
             {
-                throw new Exception($"Cannot load mothlibs, missing metadata for \"{libName}\".");
+                libraries[i].CheckConflicts(loaded);
             }
 
-            using (
-                var gzip = new GZipStream(
-                    new MemoryStream(Utils.Unescape(match.Value), false),
-                    CompressionMode.Decompress
-                )
-            )
-            {
-                using (var metadata = new MemoryStream())
-                {
-                    gzip.CopyTo(metadata);
-                    metadata.Seek(0, SeekOrigin.Begin);
+            _loadedLibraries.Add(libraries[i]);
+        }
 
-                    var deserializer = new MetadataDeserializer(this, metadata);
-                    deserializer.Process(libName);
-                }
-            }
+        ClearResolutions();
+    }
+
+    // Runs on several threads at once, so nothing here may change the compiler's state.
+    private MetadataDeserializer DecodeLibrary(string path)
+    {
+        var match = Regex.Match(Path.GetFileName(path), "(.*)(?=\\.mothlib.bc)");
+
+        if (!match.Success)
+        {
+            throw new Exception(
+                $"Cannot load mothlibs, \"{path}\" does not have the correct extension."
+            );
         }
+
+        var libName = match.Value;
+        var deserializer = new MetadataDeserializer(
+            this,
+            MetadataCache.GetOrLoad(path, () => ReadMetadata(path, libName)),
+            libName
+        );
+
+        deserializer.Decode();
+        return deserializer;
     }
 
-    public unsafe byte[] GenerateMetadata(string assemblyName)
+    // Maps the uncompressed metadata of a library from the sidecar file written next to it, or
+    // decompresses the copy embedded in the library's module if there is no sidecar as new as the
+    // library.
+    private unsafe MetadataImage ReadMetadata(string path, string libName)
     {
-        using (var result = new MemoryStream())
+        string sidecar = Path.Combine(Path.GetDirectoryName(path) ?? "", $"{libName}.meta");
+
+        if (
+            File.Exists(sidecar)
+            && File.GetLastWriteTimeUtc(sidecar) >= File.GetLastWriteTimeUtc(path)
+        )
         {
-            result.Write(Encoding.UTF8.GetBytes("<metadata>"));
+            return MetadataImage.Map(sidecar);
+        }
 
-            using (var serializer = new MetadataSerializer(this))
-            {
-                var bytes = serializer.Process();
-                var gzip = new GZipStream(result, Options.CompressionLevel);
+        byte[] blob;
 
-                bytes.WriteTo(gzip);
-                gzip.Flush();
+        // a context of its own, since libraries are read in parallel
+        using (var context = LLVMContextRef.Create())
+        using (var module = LoadLLVMModule(path, context))
+        {
+            var global = module.GetNamedGlobal($"<{libName}/metadata>");
+
+            if (global.Handle == IntPtr.Zero || global.Initializer.Handle == IntPtr.Zero)
+            {
+                throw new Exception($"Cannot load mothlibs, missing metadata for \"{libName}\".");
             }
 
-            result.Write(Encoding.UTF8.GetBytes("</metadata>"));
+            nuint length;
+            sbyte* bytes = LLVMSharp.Interop.LLVM.GetAsString(global.Initializer, &length);
+            blob = new ReadOnlySpan<byte>(bytes, (int)length).ToArray();
+        }
 
-            var global = Module.AddGlobal(
-                LLVMTypeRef.CreateArray(LLVMTypeRef.Int8, (uint)result.Length),
-                $"<{assemblyName}/metadata>"
-            );
+        return MetadataCodec.Unpack(blob, libName);
+    }
 
-            global.Initializer = LLVMValueRef.CreateConstArray(
-                LLVMTypeRef.Int8,
-                result.ToArray().AsLLVMValues()
+    // Embeds the compressed metadata in the module as a single byte string, and returns it
+    // uncompressed so that it can be written next to the library, where it is mapped when loaded.
+    public unsafe byte[] GenerateMetadata(string assemblyName)
+    {
+        using (var serializer = new MetadataSerializer(this))
+        {
+            byte[] image = serializer.Process().ToArray();
+            byte[] blob = MetadataCodec.Pack(
+                image,
+                Options.MetadataCodec,
+                Options.MetadataNameCodec,
+                Options.CompressionLevel
             );
+            LLVMValueRef initializer;
+
+            fixed (byte* ptr = blob)
+            {
+                initializer = LLVMSharp.Interop.LLVM.ConstStringInContext(
+                    Context,
+                    (sbyte*)ptr,
+                    (uint)blob.Length,
+                    1
+                );
+            }
+
+            var global = Module.AddGlobal(initializer.TypeOf, $"<{assemblyName}/metadata>");
+
+            global.Initializer = initializer;
             global.Linkage = LLVMLinkage.LLVMDLLExportLinkage;
             global.IsGlobalConstant = true;
 
-            return result.ToArray();
+            return image;
         }
     }
 
@@ -487,6 +654,7 @@ public class LLVMCompiler : IDisposable
             return;
         }
 
+        ClearResolutions();
         CurrentNamespace.Templates.Add(
             typeTemplateNode.Name,
             new Template(
@@ -532,7 +700,7 @@ public class LLVMCompiler : IDisposable
         Template template,
         TypeNode typeNode,
         StructDecl structDecl,
-        IReadOnlyList<IExpressionNode> args
+        IReadOnlyList<Data.Type> args
     )
     {
         var oldBuilder = Builder;
@@ -545,13 +713,7 @@ public class LLVMCompiler : IDisposable
 
         for (var i = 0; i < template.Params.Length; i++)
         {
-            var param = template.Params[i];
-            var arg = args[i];
-
-            if (!param.IsConst)
-            {
-                newAnonTypes.Add(param.Name, ResolveType((TypeRefNode)arg));
-            }
+            newAnonTypes.Add(template.Params[i].Name, args[i]);
         }
 
         Builder = Context.CreateBuilder();
@@ -560,6 +722,9 @@ public class LLVMCompiler : IDisposable
         _anonTypes = newAnonTypes;
         CurrentFunction = null;
 
+        // the fields may refer to the template parameters, so they are resolved in here
+        structDecl.AddBuiltins();
+
         foreach (FuncDefNode funcDefNode in typeNode.Functions)
         {
             DefineFunction(funcDefNode, structDecl);
@@ -623,7 +788,8 @@ public class LLVMCompiler : IDisposable
             );
         }
 
-        CurrentNamespace.Types.Add(typeNode.Name, newStructDecl);
+        CurrentNamespace.AddType(typeNode.Name, newStructDecl);
+        ClearResolutions();
         Types.Add(newStructDecl.AddBuiltins());
     }
 
@@ -655,6 +821,7 @@ public class LLVMCompiler : IDisposable
             attributes
         );
         CurrentNamespace.Traits.Add(traitNode.Name, newTrait);
+        ClearResolutions();
         Traits.Add(newTrait);
     }
 
@@ -691,7 +858,8 @@ public class LLVMCompiler : IDisposable
             newEnum.Flags.Add(flag.Name, new EnumFlag(flag.Name, flag.Value));
         }
 
-        CurrentNamespace.Types.Add(enumNode.Name, newEnum);
+        CurrentNamespace.AddType(enumNode.Name, newEnum);
+        ClearResolutions();
         Types.Add(newEnum);
     }
 
@@ -719,7 +887,7 @@ public class LLVMCompiler : IDisposable
 
         if (typeDecl != null && !funcDefNode.IsStatic)
         {
-            paramTypes.Add(new PtrType(this, typeDecl));
+            paramTypes.Add(TypeTable.GetPointer(typeDecl));
             index++;
         }
 
@@ -755,7 +923,7 @@ public class LLVMCompiler : IDisposable
         );
         FuncType funcType =
             typeDecl == null
-                ? new FuncType(this, returnType, paramTypes.ToArray(), funcDefNode.IsVariadic)
+                ? TypeTable.GetFunction(returnType, paramTypes.ToArray(), funcDefNode.IsVariadic)
                 : new MethodType(
                     this,
                     returnType,
@@ -797,76 +965,12 @@ public class LLVMCompiler : IDisposable
         Functions.Add(func);
     }
 
-    public void CompileFunction(FuncDefNode funcDefNode, TypeDecl? typeDecl = null)
+    public Function? CompileFunction(FuncDefNode funcDefNode, TypeDecl? typeDecl = null)
     {
-        // Confirm that the definition is for the correct OS
-        {
-            foreach (AttributeNode attribute in funcDefNode.Attributes)
-            {
-                if (attribute.Name == Reserved.TargetOS)
-                {
-                    var targetOS = (TargetOSAttribute)MakeAttribute(
-                        attribute.Name,
-                        CleanAttributeArgs(attribute.Arguments.ToArray())
-                    );
-                    if (!targetOS.Targets.Contains(Utils.GetOS()))
-                        return;
-                }
-            }
-        }
-
-        Function? func;
-        OverloadList? overloads;
-        var paramTypes = new List<Data.Type>();
-
-        foreach (ParameterNode param in funcDefNode.Params)
-        {
-            paramTypes.Add(ResolveParameter(param));
-        }
+        Function? func = GetDefinition(funcDefNode, typeDecl);
 
-        if (!funcDefNode.IsStatic && typeDecl != null)
-        {
-            var newParamTypes = new List<Data.Type>() { new PtrType(this, typeDecl) };
-
-            newParamTypes.AddRange(paramTypes);
-            paramTypes = newParamTypes;
-        }
-
-        if (funcDefNode.IsForeign || funcDefNode.ExecutionBlock == null)
-        {
-            return;
-        }
-        else if (
-            typeDecl != null
-            && !funcDefNode.IsStatic
-            && typeDecl.Methods.TryGetValue(funcDefNode.Name, out overloads)
-            && overloads.TryGet(paramTypes, out func)
-        )
-        {
-            // Keep empty
-        }
-        else if (
-            typeDecl != null
-            && funcDefNode.IsStatic
-            && typeDecl.StaticMethods.TryGetValue(funcDefNode.Name, out overloads)
-            && overloads.TryGet(paramTypes, out func)
-        )
-        {
-            // Keep empty
-        }
-        else if (
-            CurrentNamespace.Functions.TryGetValue(funcDefNode.Name, out overloads)
-            && overloads.TryGet(paramTypes, out func)
-        )
-        {
-            // Keep empty
-        }
-        else
-        {
-            throw new Exception(
-                $"Cannot compile function \"{funcDefNode.Name}\" as it is undefined."
-            );
-        }
+        if (func == null)
+            return null;
 
         CurrentFunction = func;
         func.OpeningScope = new Scope(func.LLVMValue.AppendBasicBlock("entry"));
@@ -891,7 +995,7 @@ public class LLVMCompiler : IDisposable
             }
 
             var @new = retType.Init();
-            func.OpeningScope.Variables.Add(@new.Name, @new);
+            func.OpeningScope.AddVariable(@new.Name, @new);
 
             if (!(@new.Type.BaseType is StructDecl structOfNew))
                 throw new Exception(
@@ -918,36 +1022,98 @@ public class LLVMCompiler : IDisposable
                 param.Name
             );
             Builder.BuildStore(func.LLVMValue.Params[param.ParamIndex], paramAsVar);
-            func.OpeningScope.Variables.Add(
+            func.OpeningScope.AddVariable(
                 param.Name,
                 new Variable(
                     this,
                     param.Name,
-                    new VarType(this, CurrentFunction.Type.ParameterTypes[param.ParamIndex]),
+                    TypeTable.GetVar(CurrentFunction.Type.ParameterTypes[param.ParamIndex]),
                     paramAsVar
                 )
             );
         }
 
-        if (CompileScope(func.OpeningScope, funcDefNode.ExecutionBlock))
+        if (!CompileScope(func.OpeningScope, funcDefNode.ExecutionBlock))
         {
-            if (Options.DoOptimize)
-            {
-                Log($"(unsafe) Running optimization pass on function \"{func.FullName}\".");
+            throw new Exception("Function is not guaranteed to return.");
+        }
 
-                unsafe
+        return func;
+    }
+
+    // Finds the function a definition declared, or null if it has no body in this build.
+    private Function? GetDefinition(FuncDefNode funcDefNode, TypeDecl? typeDecl)
+    {
+        // Confirm that the definition is for the correct OS
+        {
+            foreach (AttributeNode attribute in funcDefNode.Attributes)
+            {
+                if (attribute.Name == Reserved.TargetOS)
                 {
-                    LLVMSharp.Interop.LLVM.RunFunctionPassManager(
-                        FunctionPassManager,
-                        func.LLVMValue
+                    var targetOS = (TargetOSAttribute)MakeAttribute(
+                        attribute.Name,
+                        CleanAttributeArgs(attribute.Arguments.ToArray())
                     );
+                    if (!targetOS.Targets.Contains(Utils.GetOS()))
+                        return null;
                 }
             }
         }
+
+        Function? func;
+        OverloadList? overloads;
+        var paramTypes = new List<Data.Type>();
+
+        foreach (ParameterNode param in funcDefNode.Params)
+        {
+            paramTypes.Add(ResolveParameter(param));
+        }
+
+        if (!funcDefNode.IsStatic && typeDecl != null)
+        {
+            var newParamTypes = new List<Data.Type>() { TypeTable.GetPointer(typeDecl) };
+
+            newParamTypes.AddRange(paramTypes);
+            paramTypes = newParamTypes;
+        }
+
+        if (funcDefNode.IsForeign || !funcDefNode.HasExecutionBlock)
+        {
+            return null;
+        }
+        else if (
+            typeDecl != null
+            && !funcDefNode.IsStatic
+            && typeDecl.Methods.TryGetValue(funcDefNode.Name, out overloads)
+            && overloads.TryGet(paramTypes, out func)
+        )
+        {
+            // Keep empty
+        }
+        else if (
+            typeDecl != null
+            && funcDefNode.IsStatic
+            && typeDecl.StaticMethods.TryGetValue(funcDefNode.Name, out overloads)
+            && overloads.TryGet(paramTypes, out func)
+        )
+        {
+            // Keep empty
+        }
+        else if (
+            CurrentNamespace.Functions.TryGetValue(funcDefNode.Name, out overloads)
+            && overloads.TryGet(paramTypes, out func)
+        )
+        {
+            // Keep empty
+        }
         else
         {
-            throw new Exception("Function is not guaranteed to return.");
+            throw new Exception(
+                $"Cannot compile function \"{funcDefNode.Name}\" as it is undefined."
+            );
         }
+
+        return func;
     }
 
     public LLVMValueRef HandleForeign(string funcName, FuncType funcType)
@@ -1001,13 +1167,13 @@ public class LLVMCompiler : IDisposable
             this,
             CurrentNamespace,
             globalDef.Name,
-            new VarType(this, globalType),
+            TypeTable.GetVar(globalType),
             globalVal,
             attributes,
             globalDef.Privacy
         );
         globalVal.IsExternallyInitialized = globalDef.IsForeign;
-        CurrentNamespace.GlobalVariables.Add(globalDef.Name, global);
+        CurrentNamespace.AddGlobal(globalDef.Name, global);
         Globals.Add(global);
         //TODO: add const support to globals
     }
@@ -1045,10 +1211,7 @@ public class LLVMCompiler : IDisposable
             }
             else if (statement is ScopeNode newScopeNode)
             {
-                var newScope = new Scope(CurrentFunction.LLVMValue.AppendBasicBlock(""))
-                {
-                    Variables = new Dictionary<string, Variable>(scope.Variables),
-                };
+                var newScope = new Scope(CurrentFunction.LLVMValue.AppendBasicBlock(""), scope);
                 Builder.BuildBr(newScope.LLVMBlock);
                 Builder.PositionAtEnd(newScope.LLVMBlock);
 
@@ -1075,10 +1238,7 @@ public class LLVMCompiler : IDisposable
                 Builder.BuildCondBr(condition.LLVMValue, then, @continue);
                 Builder.PositionAtEnd(then);
 
-                var newScope = new Scope(then)
-                {
-                    Variables = new Dictionary<string, Variable>(scope.Variables),
-                };
+                var newScope = new Scope(then, scope);
 
                 if (!CompileScope(newScope, @while.Then))
                 {
@@ -1104,10 +1264,7 @@ public class LLVMCompiler : IDisposable
                     Builder.PositionAtEnd(then);
 
                     {
-                        var newScope = new Scope(then)
-                        {
-                            Variables = new Dictionary<string, Variable>(scope.Variables),
-                        };
+                        var newScope = new Scope(then, scope);
 
                         if (CompileScope(newScope, @if.Then))
                         {
@@ -1129,10 +1286,7 @@ public class LLVMCompiler : IDisposable
                 {
                     Builder.PositionAtEnd(@else);
 
-                    var newScope = new Scope(@else)
-                    {
-                        Variables = new Dictionary<string, Variable>(scope.Variables),
-                    };
+                    var newScope = new Scope(@else, scope);
 
                     if (@if.Else != null && CompileScope(newScope, @if.Else))
                     {
@@ -1187,8 +1341,7 @@ public class LLVMCompiler : IDisposable
         }
         else if (typeRef is TemplateTypeRefNode tmplTypeRef)
         {
-            Template template = GetTemplate(tmplTypeRef.Name);
-            type = template.Build(tmplTypeRef.Arguments);
+            type = ResolveTemplateInstance(tmplTypeRef);
         }
         else if (typeRef is FuncTypeRefNode fnTypeRef)
         {
@@ -1201,7 +1354,7 @@ public class LLVMCompiler : IDisposable
                 paramTypes.Add(paramType);
             }
 
-            type = new LocalFuncType(this, retType, paramTypes.ToArray());
+            type = TypeTable.GetLocalFunction(retType, paramTypes.ToArray());
         }
         else if (typeRef is ArrayTypeRefNode arrayTypeRef)
         {
@@ -1216,19 +1369,59 @@ public class LLVMCompiler : IDisposable
 
         for (int i = 0; i < typeRef.PointerDepth; i++)
         {
-            type = new PtrType(this, type);
+            type = TypeTable.GetPointer(type);
         }
 
         if (typeRef.IsRef)
         {
-            type = new RefType(this, type);
+            type = TypeTable.GetReference(type);
         }
 
         return type;
     }
 
+    public Data.Type ResolveTemplateInstance(TemplateTypeRefNode tmplTypeRef)
+    {
+        var args = new Data.Type[tmplTypeRef.Arguments.Count];
+
+        for (int i = 0; i < args.Length; i++)
+        {
+            args[i] = tmplTypeRef.Arguments[i] is TypeRefNode argTypeRef
+                ? ResolveType(argTypeRef)
+                : throw new Exception(
+                    $"Template argument {i} for template \"{tmplTypeRef.Name}\" is expected to be a type."
+                );
+        }
+
+        // instantiations exported by a library are reused instead of being built again
+        string name = Template.GetInstanceName(tmplTypeRef.Name, args);
+
+        if (
+            CurrentNamespace.TryGetType(name, out TypeDecl built)
+            || _imports.TryGetType(name, out built)
+        )
+        {
+            return built;
+        }
+
+        // handed back for the first shard to build too, except for those made inside the body of
+        // another instance, as they are made again along with it
+        if (_shard is { IsSealed: true } && _anonTypes.Count == 0 && _script != null)
+            _shard.Instantiations.Add((_script, tmplTypeRef));
+
+        return GetTemplate(tmplTypeRef.Name).Build(args);
+    }
+
     public Value CompileExpression(Scope scope, IExpressionNode expr)
     {
+        if (
+            expr is BinaryOperationNode or CastNode or InverseNode
+            && ConstEvaluator.TryEvaluate(expr, out ConstEvaluator.Constant constant)
+        )
+        {
+            return ConstEvaluator.Emit(constant);
+        }
+
         if (expr is BinaryOperationNode binaryOp)
         {
             return binaryOp.Type == OperationType.Assignment
@@ -1258,7 +1451,7 @@ public class LLVMCompiler : IDisposable
                 index++;
             }
 
-            var funcType = new LocalFuncType(this, retType, paramTypes.ToArray());
+            var funcType = TypeTable.GetLocalFunction(retType, paramTypes.ToArray());
             LLVMValueRef llvmFunc = Module.AddFunction(
                 Reserved.LocalFunc,
                 funcType.BaseType.LLVMType
@@ -1342,7 +1535,7 @@ public class LLVMCompiler : IDisposable
             {
                 if (CurrentFunction.Name == Reserved.Init)
                 {
-                    return scope.Variables[Reserved.Self];
+                    return scope.GetVariable(Reserved.Self);
                 }
                 else
                 {
@@ -1353,7 +1546,7 @@ public class LLVMCompiler : IDisposable
             {
                 return Value.Create(
                     this,
-                    new PtrType(this, CurrentFunction.OwnerType),
+                    TypeTable.GetPointer(CurrentFunction.OwnerType),
                     CurrentFunction.LLVMValue.FirstParam
                 );
             }
@@ -1381,7 +1574,7 @@ public class LLVMCompiler : IDisposable
 
                 return new Pointer(
                     this,
-                    new RefType(this, resultType),
+                    TypeTable.GetReference(resultType),
                     Builder.BuildInBoundsGEP2(
                         resultType.LLVMType,
                         toBeIndexed.LLVMValue,
@@ -1423,7 +1616,7 @@ public class LLVMCompiler : IDisposable
                 Builder.BuildICmp(
                     LLVMIntPredicate.LLVMIntEQ,
                     value.LLVMValue,
-                    LLVMValueRef.CreateConstInt(LLVMTypeRef.Int1, 0)
+                    LLVMValueRef.CreateConstInt(Context.Int1Type, 0)
                 )
             );
         }
@@ -1518,7 +1711,7 @@ public class LLVMCompiler : IDisposable
             global.Initializer = constStr;
             global.Linkage = LLVMLinkage.LLVMPrivateLinkage;
             global.IsGlobalConstant = true;
-            return Value.Create(this, new PtrType(this, typeDecl), global);
+            return Value.Create(this, TypeTable.GetPointer(typeDecl), global);
         }
         else if (literalNode.Value is bool @bool)
         {
@@ -1526,7 +1719,7 @@ public class LLVMCompiler : IDisposable
             return Value.Create(
                 this,
                 typeDecl,
-                LLVMValueRef.CreateConstInt(LLVMTypeRef.Int1, (ulong)(@bool ? 1 : 0))
+                LLVMValueRef.CreateConstInt(Context.Int1Type, (ulong)(@bool ? 1 : 0))
             );
         }
         else if (literalNode.Value is int i32)
@@ -1539,13 +1732,13 @@ public class LLVMCompiler : IDisposable
             return Value.Create(
                 this,
                 typeDecl,
-                LLVMValueRef.CreateConstReal(LLVMTypeRef.Float, f32)
+                LLVMValueRef.CreateConstReal(Context.FloatType, f32)
             );
         }
         else if (literalNode.Value is char ch)
         {
             TypeDecl typeDecl = UInt8;
-            return Value.Create(this, typeDecl, LLVMValueRef.CreateConstInt(LLVMTypeRef.Int8, ch));
+            return Value.Create(this, typeDecl, LLVMValueRef.CreateConstInt(Context.Int8Type, ch));
         }
         else if (literalNode.Value == null)
         {
@@ -1597,7 +1790,7 @@ public class LLVMCompiler : IDisposable
                             )
                             .ImplicitConvertTo(Bool)
                             .LLVMValue,
-                        LLVMValueRef.CreateConstInt(LLVMTypeRef.Int1, 0)
+                        LLVMValueRef.CreateConstInt(Context.Int1Type, 0)
                     )
                 ),
             _
@@ -1879,8 +2072,8 @@ public class LLVMCompiler : IDisposable
         }
 
         LLVMValueRef llvmVariable = Builder.BuildAlloca(type.LLVMType, localDef.Name);
-        Variable ret = new Variable(this, localDef.Name, new VarType(this, type), llvmVariable);
-        scope.Variables.Add(localDef.Name, ret);
+        Variable ret = new Variable(this, localDef.Name, TypeTable.GetVar(type), llvmVariable);
+        scope.AddVariable(localDef.Name, ret);
 
         if (value != null)
         {
@@ -1945,7 +2138,7 @@ public class LLVMCompiler : IDisposable
         }
         else
         {
-            if (scope.Variables.TryGetValue(@ref.Name, out Variable @var))
+            if (scope.TryGetVariable(@ref.Name, out Variable @var))
             {
                 return @var;
             }
@@ -2019,7 +2212,7 @@ public class LLVMCompiler : IDisposable
                     {
                         toCallOn = Value.Create(
                             this,
-                            new PtrType(this, @varType.BaseType),
+                            TypeTable.GetPointer(@varType.BaseType),
                             toCallOn.LLVMValue
                         );
                     }
@@ -2070,7 +2263,7 @@ public class LLVMCompiler : IDisposable
             }
         }
         else if (
-            scope.Variables.TryGetValue(funcCall.Name, out Variable funcVar)
+            scope.TryGetVariable(funcCall.Name, out Variable funcVar)
             && funcVar.Type.BaseType is FuncType funcVarType
         )
         {
@@ -2122,12 +2315,18 @@ public class LLVMCompiler : IDisposable
         {
             return CurrentNamespace;
         }
-        else if (CurrentNamespace.TryGetNamespace(name, out Namespace nmspace))
+        else if (
+            _namespaceResolutions.TryGet(CurrentNamespace, _imports, name, out Namespace nmspace)
+        )
         {
             return nmspace;
         }
-        else if (_imports.TryGetNamespace(name, out nmspace))
+        else if (
+            CurrentNamespace.TryGetNamespace(name, out nmspace)
+            || _imports.TryGetNamespace(name, out nmspace)
+        )
         {
+            _namespaceResolutions.Add(CurrentNamespace, _imports, name, nmspace);
             return nmspace;
         }
         else
@@ -2138,12 +2337,15 @@ public class LLVMCompiler : IDisposable
 
     public TypeDecl GetType(string name)
     {
-        if (CurrentNamespace.TryGetType(name, out TypeDecl type))
+        if (_typeResolutions.TryGet(CurrentNamespace, _imports, name, out TypeDecl type))
         {
             return type;
         }
-        else if (_imports.TryGetType(name, out type))
+        else if (
+            CurrentNamespace.TryGetType(name, out type) || _imports.TryGetType(name, out type)
+        )
         {
+            _typeResolutions.Add(CurrentNamespace, _imports, name, type);
             return type;
         }
         else
@@ -2154,12 +2356,15 @@ public class LLVMCompiler : IDisposable
 
     public TraitDecl GetTrait(string name)
     {
-        if (CurrentNamespace.TryGetTrait(name, out TraitDecl trait))
+        if (_traitResolutions.TryGet(CurrentNamespace, _imports, name, out TraitDecl trait))
         {
             return trait;
         }
-        else if (_imports.TryGetTrait(name, out trait))
+        else if (
+            CurrentNamespace.TryGetTrait(name, out trait) || _imports.TryGetTrait(name, out trait)
+        )
         {
+            _traitResolutions.Add(CurrentNamespace, _imports, name, trait);
             return trait;
         }
         else
@@ -2170,12 +2375,16 @@ public class LLVMCompiler : IDisposable
 
     public Template GetTemplate(string name)
     {
-        if (CurrentNamespace.TryGetTemplate(name, out Template template))
+        if (_templateResolutions.TryGet(CurrentNamespace, _imports, name, out Template template))
         {
             return template;
         }
-        else if (_imports.TryGetTemplate(name, out template))
+        else if (
+            CurrentNamespace.TryGetTemplate(name, out template)
+            || _imports.TryGetTemplate(name, out template)
+        )
         {
+            _templateResolutions.Add(CurrentNamespace, _imports, name, template);
             return template;
         }
         else
@@ -2214,7 +2423,7 @@ public class LLVMCompiler : IDisposable
         }
     }
 
-    public static IReadOnlyList<object> CleanAttributeArgs(IExpressionNode[] args)
+    public IReadOnlyList<object> CleanAttributeArgs(IExpressionNode[] args)
     {
         var result = new List<object>();
 
@@ -2224,9 +2433,13 @@ public class LLVMCompiler : IDisposable
             {
                 result.Add(litNode.Value);
             }
+            else if (ConstEvaluator.TryEvaluate(expr, out ConstEvaluator.Constant constant))
+            {
+                result.Add(ConstEvaluator.ToObject(constant));
+            }
             else
             {
-                throw new Exception("Cannot pass non-literal parameters to an attribute.");
+                throw new Exception("Cannot pass non-constant parameters to an attribute.");
             }
         }
 
@@ -2235,9 +2448,12 @@ public class LLVMCompiler : IDisposable
 
     public void Dispose()
     {
-        FunctionPassManager.Dispose();
+        if (_targetMachine != default)
+            _targetMachine.Dispose();
+
         Builder.Dispose();
         Module.Dispose();
+        Context.Dispose();
     }
 
     private Namespace InitGlobalNamespace()
@@ -2273,20 +2489,27 @@ public class LLVMCompiler : IDisposable
         {
             entries.Add(
                 Reserved.Malloc,
-                new FuncType(this, new PtrType(this, Void), new Data.Type[1] { UInt64 }, false)
+                TypeTable.GetFunction(
+                    TypeTable.GetPointer(Void),
+                    new Data.Type[1] { UInt64 },
+                    false
+                )
             );
             entries.Add(
                 Reserved.Realloc,
-                new FuncType(
-                    this,
-                    new PtrType(this, Void),
-                    new Data.Type[2] { new PtrType(this, Void), UInt64 },
+                TypeTable.GetFunction(
+                    TypeTable.GetPointer(Void),
+                    new Data.Type[2] { TypeTable.GetPointer(Void), UInt64 },
                     false
                 )
             );
             entries.Add(
                 Reserved.Free,
-                new FuncType(this, Void, new Data.Type[1] { new PtrType(this, Void) }, false)
+                TypeTable.GetFunction(
+                    Void,
+                    new Data.Type[1] { TypeTable.GetPointer(Void) },
+                    false
+                )
             );
         }
 
@@ -2312,16 +2535,237 @@ public class LLVMCompiler : IDisposable
         return func;
     }
 
-    private void OpenFile(NamespaceNode @namespace, ImportNode[] imports)
+    // Visits the statements of every script, grouped by kind, before the next pass begins.
+    private void RunPass(ScriptVisitor pass, IReadOnlyCollection<ScriptAST> scripts)
+    {
+        foreach (ScriptAST script in scripts)
+        {
+            _script = script;
+            OpenFile(script.Namespace, script.Imports);
+            script.AcceptGrouped(pass);
+        }
+
+        _script = null;
+    }
+
+    // Compiles the function bodies in as many shards as there are codegen jobs. This compiler is
+    // the first shard, and every other shard repeats the first two passes in a context of its own
+    // before compiling its share of the bodies, which are then linked into this module.
+    private void CompileSharded(IReadOnlyCollection<ScriptAST> scripts)
+    {
+        int count = Options.CodegenJobs;
+        var shards = new CodegenShard[count - 1];
+        var bitcode = new Task<LLVMMemoryBufferRef>[count - 1];
+        int linked = 0;
+
+        Log($"Compiling function bodies in {count} shards...");
+
+        using (var cancellation = new CancellationTokenSource())
+        {
+            for (int i = 1; i < count; i++)
+            {
+                var shard = new CodegenShard(i, count, cancellation.Token);
+                shards[i - 1] = shard;
+                bitcode[i - 1] = Task.Run(() => CompileShard(scripts, shard));
+            }
+
+            try
+            {
+                _shard = new CodegenShard(0, count);
+                DeclareAll();
+                RunPass(new CompilePass(this), scripts);
+                _shard = null;
+
+                // rethrows the exception of a failed shard instead of an aggregate
+                foreach (Task<LLVMMemoryBufferRef> task in bitcode)
+                {
+                    task.GetAwaiter().GetResult();
+                }
+
+                // built here before anything is linked, as the shards' own copies are private and
+                // would take the names these get otherwise
+                foreach (CodegenShard shard in shards)
+                {
+                    foreach (
+                        (ScriptAST script, TemplateTypeRefNode typeRef) in shard.Instantiations
+                    )
+                    {
+                        OpenFile(script.Namespace, script.Imports);
+                        _ = ResolveTemplateInstance(typeRef);
+                    }
+                }
+
+                while (linked < bitcode.Length)
+                {
+                    LinkShard(bitcode[linked++].Result);
+                }
+            }
+            catch
+            {
+                // no shard may keep compiling past a failed build, least of all in a compile
+                // server, and the bitcode that will not be linked is freed
+                cancellation.Cancel();
+                Task.WhenAny(Task.WhenAll(bitcode)).Wait();
+
+                for (int i = linked; i < bitcode.Length; i++)
+                {
+                    if (bitcode[i].IsCompletedSuccessfully)
+                        bitcode[i].Result.Dispose();
+                    else
+                        _ = bitcode[i].Exception;
+                }
+
+                throw;
+            }
+            finally
+            {
+                _shard = null;
+            }
+        }
+    }
+
+    private LLVMMemoryBufferRef CompileShard(
+        IReadOnlyCollection<ScriptAST> scripts,
+        CodegenShard shard
+    )
+    {
+        using (
+            var compiler = new LLVMCompiler(
+                ModuleName,
+                _logger,
+                Options,
+                LLVMContextRef.Create(),
+                shard
+            )
+        )
+        {
+            compiler.LoadLibraries(_libraries);
+
+            compiler.RunPass(new DeclarePass(compiler), scripts);
+            compiler.RunPass(new DefinePass(compiler), scripts);
+            compiler.DeclareAll();
+            shard.Seal(compiler.Module);
+            compiler.RunPass(new CompilePass(compiler), scripts);
+            shard.Isolate(compiler.Module);
+
+            return compiler.Module.WriteBitcodeToMemoryBuffer();
+        }
+    }
+
+    // The module takes over the buffer once it is read, and is itself consumed by linking.
+    private unsafe void LinkShard(LLVMMemoryBufferRef buffer)
+    {
+        LLVMModuleRef module;
+
+        try
+        {
+            module = Context.GetBitcodeModule(buffer);
+        }
+        catch
+        {
+            buffer.Dispose();
+            throw;
+        }
+
+        if (LLVMSharp.Interop.LLVM.LinkModules2(Module, module) != 0)
+            throw new Exception("Failed to link a codegen shard into the output module.");
+    }
+
+    // Holds on to a body until something reachable calls its function.
+    private void DeferFunction(FuncDefNode funcDefNode, TypeDecl? typeDecl)
+    {
+        Function? func = GetDefinition(funcDefNode, typeDecl);
+
+        if (func == null)
+            return;
+
+        _deferred.Add(func, new DeferredBody(funcDefNode, typeDecl, CurrentNamespace, _imports));
+
+        if (IsRoot(func))
+            Reach(func);
+    }
+
+    // The entry point, exported functions and, in a library, everything another module can call.
+    private bool IsRoot(Function func) =>
+        func is DefinedFunction defined
+        && (
+            defined.Name == Reserved.Main
+            || defined.Attributes.ContainsKey(Reserved.Export)
+            || (Options.IsLibrary && defined.Privacy == PrivacyType.Pub)
+        );
+
+    // Compiles the deferred bodies of every reached function, which reaches the functions they
+    // call in turn. Whatever is never reached is left without a body.
+    private void CompileReachable()
+    {
+        while (_worklist.Count > 0)
+        {
+            if (_deferred.Remove(_worklist.Dequeue(), out DeferredBody body))
+            {
+                CurrentNamespace = body.Namespace;
+                _imports = body.Imports;
+                CompileFunction(body.Node, body.Owner);
+            }
+        }
+
+        Log($"Skipped {_deferred.Count} unreachable function bodies.");
+    }
+
+    // Creates the values of every function and type info up front, which are otherwise created
+    // on first use, so that each shard starts compiling bodies with the same declarations.
+    private void DeclareAll()
+    {
+        foreach (DefinedFunction func in Functions)
+        {
+            _ = func.LLVMValue;
+        }
+
+        foreach (TypeDecl type in Types)
+        {
+            _ = type.TInfo;
+        }
+    }
+
+    private void OpenFile(NamespaceNode @namespace, IReadOnlyList<ImportNode> imports)
     {
         CurrentNamespace = ResolveNamespace(@namespace);
         _imports = ResolveImports(imports);
+        ClearResolutions();
+    }
+
+    private void ClearResolutions()
+    {
+        _namespaceResolutions.Clear();
+        _typeResolutions.Clear();
+        _traitResolutions.Clear();
+        _templateResolutions.Clear();
+    }
+
+    // Whether the type is not excluded from the current build by a target OS attribute.
+    private bool IsTargeted(TypeNode typeNode)
+    {
+        var attributes = new Dictionary<string, IAttribute>();
+
+        foreach (AttributeNode attribute in typeNode.Attributes)
+        {
+            attributes.Add(
+                attribute.Name,
+                MakeAttribute(attribute.Name, CleanAttributeArgs(attribute.Arguments.ToArray()))
+            );
+        }
+
+        return !(
+            attributes.TryGetValue(Reserved.TargetOS, out IAttribute targetOS)
+            && !((TargetOSAttribute)targetOS).Targets.Contains(Utils.GetOS())
+        );
     }
 
-    private unsafe LLVMModuleRef LoadLLVMModule(string path)
+    private LLVMModuleRef LoadLLVMModule(string path) => LoadLLVMModule(path, Context);
+
+    private unsafe LLVMModuleRef LoadLLVMModule(string path, LLVMContextRef context)
     {
         var buffer = GetMemoryBufferFromFile(path);
-        var module = Context.GetBitcodeModule(buffer);
+        var module = context.GetBitcodeModule(buffer);
         return module;
     }
 
@@ -2345,4 +2789,181 @@ public class LLVMCompiler : IDisposable
             return memoryBuffer;
         }
     }
+
+    // A function body whose compilation waits until its function is reached, along with the file
+    // it was declared in.
+    private readonly struct DeferredBody
+    {
+        public readonly FuncDefNode Node;
+        public readonly TypeDecl? Owner;
+        public readonly Namespace Namespace;
+        public readonly Namespace[] Imports;
+
+        public DeferredBody(
+            FuncDefNode node,
+            TypeDecl? owner,
+            Namespace @namespace,
+            Namespace[] imports
+        )
+        {
+            Node = node;
+            Owner = owner;
+            Namespace = @namespace;
+            Imports = imports;
+        }
+    }
+
+    // Declares every type, trait and enum so that later passes can refer to them.
+    private sealed class DeclarePass : ScriptVisitor
+    {
+        private readonly LLVMCompiler _compiler;
+
+        public DeclarePass(LLVMCompiler compiler)
+        {
+            _compiler = compiler;
+        }
+
+        public override void VisitType(TypeNode node)
+        {
+            if (node is TypeTemplateNode typeTemplateNode)
+            {
+                _compiler.PrepareTypeTemplate(typeTemplateNode);
+            }
+            else
+            {
+                _compiler.DefineType(node);
+            }
+        }
+
+        public override void VisitTrait(TraitNode node)
+        {
+            if (node is TraitTemplateNode traitTemplateNode)
+            {
+                _compiler.PrepareTraitTemplate(traitTemplateNode);
+            }
+            else
+            {
+                _compiler.DefineTrait(node);
+            }
+        }
+
+        public override void VisitEnum(EnumNode node)
+        {
+            if (node is EnumTemplateNode enumTemplateNode)
+            {
+                _compiler.PrepareEnumTemplate(enumTemplateNode);
+            }
+            else
+            {
+                _compiler.DefineEnum(node);
+            }
+        }
+    }
+
+    // Defines the signatures of globals, functions and methods, and implements traits.
+    private sealed class DefinePass : ScriptVisitor
+    {
+        private readonly LLVMCompiler _compiler;
+
+        public DefinePass(LLVMCompiler compiler)
+        {
+            _compiler = compiler;
+        }
+
+        public override void VisitGlobal(GlobalVarNode node)
+        {
+            _compiler.DefineGlobal(node);
+        }
+
+        public override void VisitFunction(FuncDefNode node)
+        {
+            _compiler.DefineFunction(node);
+        }
+
+        public override void VisitType(TypeNode node)
+        {
+            if (node is TypeTemplateNode || !_compiler.IsTargeted(node))
+                return;
+
+            TypeDecl typeDecl = _compiler.GetType(node.Name);
+
+            if (!node.IsOpaque)
+            {
+                foreach (FuncDefNode funcDefNode in node.Functions)
+                {
+                    _compiler.DefineFunction(funcDefNode, typeDecl);
+                }
+            }
+        }
+
+        public override void VisitImplement(ImplementNode node)
+        {
+            var trait = _compiler.GetTrait(node.Trait.Name); //TODO: traits should be treated like types, *mostly*
+
+            if (_compiler.ResolveType(node.Type) is not StructDecl type)
+                throw new Exception($"Cannot implement non-trait \"{node.Type}\".");
+
+            if (trait.IsExternal && type.IsExternal)
+                throw new Exception(
+                    $"Cannot implement external trait \"{trait.FullName}\" for external type \"{type.FullName}\"."
+                );
+
+            _compiler.ImplementTraitForType(trait, type, node.Implementations);
+        }
+    }
+
+    // Compiles the bodies of functions and methods, or only those claimed by the current shard.
+    // When only reachable bodies are compiled, they are deferred instead.
+    private sealed class CompilePass : ScriptVisitor
+    {
+        private readonly LLVMCompiler _compiler;
+        private int _position;
+
+        public CompilePass(LLVMCompiler compiler)
+        {
+            _compiler = compiler;
+        }
+
+        public override void VisitFunction(FuncDefNode node)
+        {
+            Compile(node, null);
+        }
+
+        public override void VisitType(TypeNode node)
+        {
+            if (node is TypeTemplateNode || !_compiler.IsTargeted(node))
+                return;
+
+            TypeDecl typeDecl = _compiler.GetType(node.Name);
+
+            if (!node.IsOpaque)
+            {
+                foreach (FuncDefNode funcDefNode in node.Functions)
+                {
+                    Compile(funcDefNode, typeDecl);
+                }
+            }
+        }
+
+        private void Compile(FuncDefNode node, TypeDecl? typeDecl)
+        {
+            if (_compiler.Options.CompileReachableOnly)
+            {
+                _compiler.DeferFunction(node, typeDecl);
+                return;
+            }
+
+            CodegenShard? shard = _compiler._shard;
+
+            shard?.Cancellation.ThrowIfCancellationRequested();
+
+            if (shard != null && !shard.Claims(_position++))
+                return;
+
+            Function? func = _compiler.CompileFunction(node, typeDecl);
+
+            if (shard != null && func != null)
+                shard.Own(func.LLVMValue);
+        }
+    }
 }
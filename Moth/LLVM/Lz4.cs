@@ -0,0 +1,177 @@
+using System.Buffers.Binary;
+
+namespace Moth.LLVM;
+
+// The LZ4 block format, for metadata that should load as fast as possible. Compression is a
+// single greedy pass over a table of recent positions, which trades some ratio for speed.
+public static class Lz4
+{
+    private const int MinMatch = 4;
+    private const int LastLiterals = 5;
+    private const int MatchFindLimit = 12;
+    private const int MaxOffset = ushort.MaxValue;
+    private const int HashBits = 16;
+
+    public static byte[] Compress(ReadOnlySpan<byte> source)
+    {
+        var output = new byte[source.Length + source.Length / 255 + 16];
+        var table = new int[1 << HashBits];
+        int length = 0;
+        int anchor = 0;
+        int position = 0;
+
+        // the format requires the last match to start this far from the end
+        while (position <= source.Length - MatchFindLimit)
+        {
+            uint sequence = BinaryPrimitives.ReadUInt32LittleEndian(source.Slice(position));
+            int hash = (int)((sequence * 2654435761u) >> (32 - HashBits));
+
+            // positions are stored plus one, so that zero means empty
+            int candidate = table[hash] - 1;
+            table[hash] = position + 1;
+
+            if (
+                candidate < 0
+                || position - candidate > MaxOffset
+                || BinaryPrimitives.ReadUInt32LittleEndian(source.Slice(candidate)) != sequence
+            )
+            {
+                position++;
+                continue;
+            }
+
+            int matchLength = MinMatch;
+
+            while (
+                position + matchLength < source.Length - LastLiterals
+                && source[candidate + matchLength] == source[position + matchLength]
+            )
+            {
+                matchLength++;
+            }
+
+            length = WriteSequence(
+                output,
+                length,
+                source.Slice(anchor, position - anchor),
+                position - candidate,
+                matchLength
+            );
+            position += matchLength;
+            anchor = position;
+        }
+
+        length = WriteSequence(output, length, source.Slice(anchor), 0, 0);
+        return output.AsSpan(0, length).ToArray();
+    }
+
+    public static void Decompress(ReadOnlySpan<byte> source, Span<byte> destination)
+    {
+        int input = 0;
+        int output = 0;
+
+        while (true)
+        {
+            byte token = Read(source, ref input);
+            int literals = ReadLength(source, ref input, token >> 4);
+
+            if (literals > source.Length - input || literals > destination.Length - output)
+                throw Corrupt();
+
+            source.Slice(input, literals).CopyTo(destination.Slice(output));
+            input += literals;
+            output += literals;
+
+            // the last sequence only has literals
+            if (input == source.Length)
+                break;
+
+            int offset = Read(source, ref input) | (Read(source, ref input) << 8);
+            int matchLength = ReadLength(source, ref input, token & 0xF) + MinMatch;
+
+            if (offset == 0 || offset > output || matchLength > destination.Length - output)
+                throw Corrupt();
+
+            if (offset >= matchLength)
+            {
+                destination.Slice(output - offset, matchLength).CopyTo(destination.Slice(output));
+                output += matchLength;
+            }
+            else
+            {
+                // the match overlaps what it produces, so it is copied a byte at a time
+                for (int i = 0; i < matchLength; i++, output++)
+                {
+                    destination[output] = destination[output - offset];
+                }
+            }
+        }
+
+        if (output != destination.Length)
+            throw Corrupt();
+    }
+
+    private static int WriteSequence(
+        byte[] output,
+        int length,
+        ReadOnlySpan<byte> literals,
+        int offset,
+        int matchLength
+    )
+    {
+        int tokenPosition = length++;
+        int token = Math.Min(literals.Length, 15) << 4;
+
+        length = WriteLength(output, length, literals.Length);
+        literals.CopyTo(output.AsSpan(length));
+        length += literals.Length;
+
+        if (matchLength > 0)
+        {
+            token |= Math.Min(matchLength - MinMatch, 15);
+            output[length++] = (byte)offset;
+            output[length++] = (byte)(offset >> 8);
+            length = WriteLength(output, length, matchLength - MinMatch);
+        }
+
+        output[tokenPosition] = (byte)token;
+        return length;
+    }
+
+    // Lengths of 15 or more continue after the token in bytes of 255, ending with the remainder.
+    private static int WriteLength(byte[] output, int length, int value)
+    {
+        if (value < 15)
+            return length;
+
+        for (value -= 15; value >= 255; value -= 255)
+        {
+            output[length++] = 255;
+        }
+
+        output[length++] = (byte)value;
+        return length;
+    }
+
+    private static int ReadLength(ReadOnlySpan<byte> source, ref int input, int value)
+    {
+        if (value < 15)
+            return value;
+
+        byte next;
+
+        do
+        {
+            next = Read(source, ref input);
+            value += next;
+        } while (next == 255);
+
+        return value;
+    }
+
+    private static byte Read(ReadOnlySpan<byte> source, ref int input) =>
+        input < source.Length ? source[input++] : throw Corrupt();
+
+    private static Exception Corrupt() =>
+        new Exception("Failed to decompress metadata, it may be corrupt.");
+}
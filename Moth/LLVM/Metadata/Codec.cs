@@ -0,0 +1,9 @@
+namespace Moth.LLVM.Metadata;
+
+public enum Codec : byte
+{
+    None,
+    Deflate,
+    Brotli,
+    Lz4
+}
@@ -2,6 +2,13 @@ namespace Moth.LLVM.Metadata;
 
 public struct Header
 {
+    public const uint CurrentFormat = 3;
+
+    public uint format;
+    public Codec table_codec;
+    public Codec name_codec;
+    public uint table_compressed_size;
+    public uint name_compressed_size;
     public uint type_table_offset;
     public uint field_table_offset;
     public uint function_table_offset;
@@ -10,6 +17,10 @@ public struct Header
     public uint param_table_offset;
     public uint paramtype_table_offset;
     public uint typeref_table_offset;
+    public uint namespace_table_offset;
+    public uint type_index_offset;
+    public uint function_index_offset;
+    public uint global_index_offset;
     public uint name_table_offset;
     public uint size;
 }
@@ -0,0 +1,7 @@
+namespace Moth.LLVM.Metadata;
+
+public struct IndexEntry
+{
+    public uint hash;
+    public uint table_index;
+}
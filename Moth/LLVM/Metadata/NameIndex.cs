@@ -0,0 +1,39 @@
+namespace Moth.LLVM.Metadata;
+
+// The hashed name index stored for the type, function and global tables. An index is the number
+// of buckets, which is a power of two, followed by where each bucket starts in the entries and
+// then the entries themselves, grouped by bucket.
+//
+// Types and globals are indexed by their full name. Functions are indexed by their full name
+// without the signature, so that the overloads of a name share a key, except for methods, which
+// are indexed by the full name of their type so that they can be found together with it.
+public static class NameIndex
+{
+    public static uint Hash(string key)
+    {
+        // FNV-1a, since the hash has to be the same in every process that reads the library
+        uint hash = 2166136261;
+
+        foreach (char ch in key)
+        {
+            hash = (hash ^ (byte)ch) * 16777619;
+        }
+
+        return hash;
+    }
+
+    public static string KeyOf(string fullName)
+    {
+        int signature = fullName.IndexOf('(');
+        string name = signature == -1 ? fullName : fullName.Substring(0, signature);
+        return name.Contains('#') && name.LastIndexOf('.') > name.IndexOf('#')
+            ? name.Substring(0, name.LastIndexOf('.'))
+            : name;
+    }
+
+    public static string NamespaceOf(string fullName)
+    {
+        int end = fullName.IndexOfAny(new[] { '#', '.' });
+        return end == -1 ? fullName : fullName.Substring(0, end);
+    }
+}
@@ -0,0 +1,7 @@
+namespace Moth.LLVM.Metadata;
+
+public struct Namespace
+{
+    public uint name_table_index;
+    public uint name_table_length;
+}
@@ -0,0 +1,63 @@
+using System.Collections.Concurrent;
+
+namespace Moth.LLVM;
+
+// Keeps the metadata image of every library loaded by this process, so that codegen shards and
+// later builds in a resident compiler do not map or decompress the same library again. An entry is
+// only used while the library file keeps the same size and modification time. An image is only
+// disposed once its library was rebuilt, as the symbols created from it read its tables lazily
+// and the builds of a resident compiler run one after the other.
+public static class MetadataCache
+{
+    private static readonly ConcurrentDictionary<string, Entry> Entries =
+        new ConcurrentDictionary<string, Entry>();
+
+    public static MetadataImage GetOrLoad(string path, Func<MetadataImage> load)
+    {
+        var file = new FileInfo(path);
+        string key = file.FullName;
+
+        if (
+            Entries.TryGetValue(key, out Entry entry)
+            && entry.Length == file.Length
+            && entry.LastWriteTime == file.LastWriteTimeUtc
+        )
+        {
+            return entry.Metadata;
+        }
+
+        // codegen shards load the same libraries at once, and only one of them may replace an entry
+        lock (Entries)
+        {
+            if (
+                Entries.TryGetValue(key, out entry)
+                && entry.Length == file.Length
+                && entry.LastWriteTime == file.LastWriteTimeUtc
+            )
+            {
+                return entry.Metadata;
+            }
+
+            MetadataImage metadata = load();
+            Entries[key] = new Entry(file.Length, file.LastWriteTimeUtc, metadata);
+
+            // otherwise the image of the old library stays mapped or pinned until the process exits
+            entry.Metadata?.Dispose();
+            return metadata;
+        }
+    }
+
+    private readonly struct Entry
+    {
+        public long Length { get; }
+        public DateTime LastWriteTime { get; }
+        public MetadataImage Metadata { get; }
+
+        public Entry(long length, DateTime lastWriteTime, MetadataImage metadata)
+        {
+            Length = length;
+            LastWriteTime = lastWriteTime;
+            Metadata = metadata;
+        }
+    }
+}
@@ -0,0 +1,174 @@
+using System.IO.Compression;
+using System.Runtime.InteropServices;
+
+namespace Moth.LLVM;
+
+// Compresses a metadata image for embedding in a library. The versions and the header stay
+// uncompressed and record which codec each part uses, followed by the structural tables and then
+// the name table, which are compressed separately since names compress very differently.
+public static unsafe class MetadataCodec
+{
+    private static uint PrefixSize
+    {
+        get { return (uint)sizeof(Version) * 2 + (uint)sizeof(Metadata.Header); }
+    }
+
+    public static Metadata.Codec Parse(string str)
+    {
+        return str switch
+        {
+            "none" => Metadata.Codec.None,
+            "deflate" => Metadata.Codec.Deflate,
+            "brotli" => Metadata.Codec.Brotli,
+            "lz4" => Metadata.Codec.Lz4,
+            _ => throw new NotImplementedException($"Unsupported metadata codec: \"{str}\"")
+        };
+    }
+
+    public static byte[] Pack(
+        byte[] image,
+        Metadata.Codec tableCodec,
+        Metadata.Codec nameCodec,
+        CompressionLevel level
+    )
+    {
+        var header = ReadHeader(image);
+        byte[] tables = Compress(
+            image.AsSpan((int)PrefixSize, (int)(header.name_table_offset - PrefixSize)),
+            tableCodec,
+            level
+        );
+        byte[] names = Compress(image.AsSpan((int)header.name_table_offset), nameCodec, level);
+
+        header.table_codec = tableCodec;
+        header.name_codec = nameCodec;
+        header.table_compressed_size = (uint)tables.Length;
+        header.name_compressed_size = (uint)names.Length;
+
+        var result = new byte[PrefixSize + tables.Length + names.Length];
+        image.AsSpan(0, (int)PrefixSize).CopyTo(result);
+        MemoryMarshal.Write(result.AsSpan(sizeof(Version) * 2), in header);
+        tables.CopyTo(result, PrefixSize);
+        names.CopyTo(result, PrefixSize + tables.Length);
+        return result;
+    }
+
+    public static MetadataImage Unpack(ReadOnlySpan<byte> blob, string libName)
+    {
+        var header = ReadHeader(blob);
+
+        if (header.format != Metadata.Header.CurrentFormat)
+        {
+            throw new Exception(
+                $"Cannot load library \"{libName}\", its metadata is in an older format. "
+                    + "Rebuild it with this version of mothc."
+            );
+        }
+
+        if (
+            header.name_table_offset < PrefixSize
+            || header.size < header.name_table_offset
+            || blob.Length
+                != (long)PrefixSize + header.table_compressed_size + header.name_compressed_size
+        )
+        {
+            throw new Exception($"Failed to read the entirety of the metadata for \"{libName}\".");
+        }
+
+        // the image is read in place through a pointer, so the array must not move
+        byte[] image = GC.AllocateUninitializedArray<byte>((int)header.size, true);
+        blob.Slice(0, (int)PrefixSize).CopyTo(image);
+        Decompress(
+            blob.Slice((int)PrefixSize, (int)header.table_compressed_size),
+            header.table_codec,
+            image.AsSpan((int)PrefixSize, (int)(header.name_table_offset - PrefixSize))
+        );
+        Decompress(
+            blob.Slice((int)(PrefixSize + header.table_compressed_size)),
+            header.name_codec,
+            image.AsSpan((int)header.name_table_offset)
+        );
+        return MetadataImage.FromPinned(image);
+    }
+
+    public static byte[] Compress(
+        ReadOnlySpan<byte> data,
+        Metadata.Codec codec,
+        CompressionLevel level
+    )
+    {
+        if (codec == Metadata.Codec.None)
+            return data.ToArray();
+
+        if (codec == Metadata.Codec.Lz4)
+            return Lz4.Compress(data);
+
+        using (var result = new MemoryStream())
+        {
+            Stream stream = codec switch
+            {
+                Metadata.Codec.Deflate => new DeflateStream(result, level, true),
+                Metadata.Codec.Brotli => new BrotliStream(result, level, true),
+                _ => throw new NotImplementedException($"Unsupported metadata codec: {codec}")
+            };
+
+            using (stream)
+            {
+                stream.Write(data);
+            }
+
+            return result.ToArray();
+        }
+    }
+
+    public static void Decompress(
+        ReadOnlySpan<byte> data,
+        Metadata.Codec codec,
+        Span<byte> destination
+    )
+    {
+        switch (codec)
+        {
+            case Metadata.Codec.None:
+                if (data.Length != destination.Length)
+                    throw new Exception("Failed to decompress metadata, it may be corrupt.");
+
+                data.CopyTo(destination);
+                break;
+            case Metadata.Codec.Lz4:
+                Lz4.Decompress(data, destination);
+                break;
+            case Metadata.Codec.Brotli:
+                if (
+                    !BrotliDecoder.TryDecompress(data, destination, out int written)
+                    || written != destination.Length
+                )
+                {
+                    throw new Exception("Failed to decompress metadata, it may be corrupt.");
+                }
+
+                break;
+            case Metadata.Codec.Deflate:
+                fixed (byte* ptr = data)
+                {
+                    using (var source = new UnmanagedMemoryStream(ptr, data.Length))
+                    using (var deflate = new DeflateStream(source, CompressionMode.Decompress))
+                    {
+                        deflate.ReadExactly(destination);
+                    }
+                }
+
+                break;
+            default:
+                throw new NotImplementedException($"Unsupported metadata codec: {codec}");
+        }
+    }
+
+    public static Metadata.Header ReadHeader(ReadOnlySpan<byte> blob)
+    {
+        if (blob.Length < PrefixSize)
+            throw new Exception("Metadata ends early, it may be corrupt.");
+
+        return MemoryMarshal.Read<Metadata.Header>(blob.Slice(sizeof(Version) * 2));
+    }
+}
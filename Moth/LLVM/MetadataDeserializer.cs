@@ -1,4 +1,4 @@
-using System.IO.Compression;
+using System.Runtime.InteropServices;
 using System.Text.RegularExpressions;
 using Moth.AST.Node;
 using Moth.LLVM.Data;
@@ -7,242 +7,481 @@ using Moth.LLVM.Data;
 //TODO: unless they don't? maybe it is better if attributes aren't kept in metadata
 namespace Moth.LLVM;
 
+// Creates the symbols of a library from its metadata image. Loading only creates the namespaces
+// the library has symbols in. A type, function or global is created when a lookup first asks for
+// its name in its namespace, or when something else that is created refers to it, so a project
+// only pays for the parts of a library it uses.
 public unsafe class MetadataDeserializer
 {
     private LLVMCompiler _compiler;
-    private MemoryStream _stream;
+    private MetadataImage _image;
+    private string _libName;
     private Version _version = new Version();
     private Version _moduleVersion = new Version();
     private Metadata.Header _header = new Metadata.Header();
-    private Metadata.Type[] _types;
-    private Metadata.Field[] _fields;
-    private Metadata.Function[] _functions;
-    private Metadata.Global[] _globals;
-    private Metadata.FuncType[] _funcTypes;
-    private Metadata.Parameter[] _parameters;
-    private Metadata.ParamType[] _paramTypes;
-    private byte[] _typeRefs;
-    private byte[] _names;
-
-    public MetadataDeserializer(LLVMCompiler compiler, MemoryStream stream)
+    private Exception? _invalid;
+    private List<string> _namespaces = new List<string>();
+    private HashSet<(Namespace, string)> _materialized = new HashSet<(Namespace, string)>();
+    private Dictionary<uint, TypeDecl> _typeDecls = new Dictionary<uint, TypeDecl>();
+    private HashSet<uint> _functions = new HashSet<uint>();
+    private HashSet<uint> _globals = new HashSet<uint>();
+
+    public MetadataDeserializer(LLVMCompiler compiler, MetadataImage image, string libName)
     {
         _compiler = compiler;
-        _stream = stream;
+        _image = image;
+        _libName = libName;
     }
 
-    public void Process(string libName)
+    // Reads the header and the namespace table without touching the compiler, so that several
+    // libraries can be decoded in parallel. Problems are kept for Process to report, after the
+    // version checks, so that they come out in the same order as when loading one at a time.
+    public void Decode()
     {
-        var version = new Version();
-        _stream.ReadExactly(new Span<byte>((byte*)&version, sizeof(Version)));
-        _version = version;
+        _version = _image.Read<Version>(0);
 
+        if (_version.Major != Meta.Version.Major)
+            return;
+
+        _moduleVersion = _image.Read<Version>((uint)sizeof(Version));
+        _header = _image.Read<Metadata.Header>((uint)sizeof(Version) * 2);
+
+        if (_header.format != Metadata.Header.CurrentFormat)
+        {
+            _invalid = new Exception(
+                $"Cannot load library \"{_libName}\", its metadata is in an older format. "
+                    + "Rebuild it with this version of mothc."
+            );
+            return;
+        }
+
+        if (_header.size != _image.Length || !HasOrderedTables())
+        {
+            _invalid = new Exception(
+                $"Failed to read the entirety of the metadata for \"{_libName}\"."
+            );
+            return;
+        }
+
+        uint namespaceCount =
+            (_header.type_index_offset - _header.namespace_table_offset)
+            / (uint)sizeof(Metadata.Namespace);
+
+        for (uint i = 0; i < namespaceCount; i++)
+        {
+            var nmspace = ReadEntry<Metadata.Namespace>(
+                _header.namespace_table_offset,
+                _header.type_index_offset,
+                i
+            );
+            GetName(nmspace.name_table_index, nmspace.name_table_length, out string fullname);
+            _namespaces.Add(fullname);
+        }
+    }
+
+    // Adds the decoded library to the compiler's namespaces.
+    public void Process()
+    {
         if (_version.Major != Meta.Version.Major)
         {
             throw new Exception(
-                $"Cannot load libary \"{libName}\" due to mismatched major version!"
+                $"Cannot load libary \"{_libName}\" due to mismatched major version!"
                     + $"\nCompiler: {Meta.Version}"
-                    + $"\n{libName}: {_version}"
+                    + $"\n{_libName}: {_version}"
             );
         }
 
         if (_version.Minor != Meta.Version.Minor)
         {
             _compiler.Warn(
-                $"Library \"{libName}\" has mismatched minor version."
+                $"Library \"{_libName}\" has mismatched minor version."
                     + $"\nCompiler: {Meta.Version}"
-                    + $"\n{libName}: {_version}"
+                    + $"\n{_libName}: {_version}"
             );
         }
 
         if (_version.Patch != Meta.Version.Patch)
         {
             _compiler.Warn(
-                $"Library \"{libName}\" has mismatched patch version."
+                $"Library \"{_libName}\" has mismatched patch version."
                     + $"\nCompiler: {Meta.Version}"
-                    + $"\n{libName}: {_version}"
+                    + $"\n{_libName}: {_version}"
             );
         }
 
-        var moduleVersion = new Version();
-        _stream.ReadExactly(new Span<byte>(&moduleVersion, sizeof(Version)));
-        _moduleVersion = moduleVersion;
-
-        var header = new Metadata.Header();
-        _stream.ReadExactly(new Span<byte>(&header, sizeof(Metadata.Header)));
-        _header = header;
-
-        InArr(ref _types, _header.field_table_offset);
-        InArr(ref _fields, _header.function_table_offset);
-        InArr(ref _functions, _header.global_variable_table_offset);
-        InArr(ref _globals, _header.functype_table_offset);
-        InArr(ref _funcTypes, _header.param_table_offset);
-        InArr(ref _parameters, _header.paramtype_table_offset);
-        InArr(ref _paramTypes, _header.typeref_table_offset);
-        InArr(ref _typeRefs, _header.name_table_offset);
-        InArr(ref _names, _header.size);
-
-        if (_stream.ReadByte() != -1)
+        if (_invalid != null)
+            throw _invalid;
+
+        foreach (string fullname in _namespaces)
         {
-            throw new Exception($"Failed to read the entirety of the metadata for \"{libName}\".");
+            GetNamespace(fullname).AddLibrary(this);
         }
+    }
 
-        foreach (var type in _types)
+    // Creates the types, functions and globals this library defines under a name in a namespace.
+    public void Materialize(Namespace nmspace, string name)
+    {
+        if (!_materialized.Add((nmspace, name)))
+            return;
+
+        string typeKey = $"{nmspace.FullName}#{name}";
+        string key = $"{nmspace.FullName}.{name}";
+
+        foreach (uint index in Find(_header.type_index_offset, typeKey, GetTypeName))
         {
-            var name = GetName(type.name_table_index, type.name_table_length, out string fullname);
-            var parent = GetNamespace(fullname);
-            StructDecl result;
+            GetTypeDecl(index);
+        }
 
-            if (type.is_foreign)
-            {
-                result = new OpaqueStructDecl(
-                    _compiler,
-                    parent,
-                    name,
-                    type.privacy,
-                    type.is_union,
-                    new Dictionary<string, IAttribute>()
-                )
-                {
-                    IsExternal = true
-                };
-            }
-            else
-            {
-                result = new StructDecl(
-                    _compiler,
-                    parent,
-                    name,
-                    type.privacy,
-                    type.is_union,
-                    new Dictionary<string, IAttribute>(),
-                    _compiler.Context.CreateNamedStruct(fullname)
-                )
-                {
-                    IsExternal = true
-                };
-                result.AddBuiltins();
-            }
+        foreach (uint index in Find(_header.function_index_offset, key, GetFunctionName))
+        {
+            AddFunction(index, null);
+        }
 
-            parent.Types.Add(name, result);
+        foreach (uint index in Find(_header.global_index_offset, key, GetGlobalName))
+        {
+            AddGlobal(index);
         }
+    }
+
+    // Reports a type or global that both this library and one loaded before it define, since
+    // lazily created symbols would otherwise only clash once something looks the name up. Names
+    // are only read for entries whose hashes match.
+    public void CheckConflicts(MetadataDeserializer other)
+    {
+        CheckConflicts(
+            "Type",
+            other,
+            _header.type_index_offset,
+            other._header.type_index_offset,
+            GetTypeName,
+            other.GetTypeName
+        );
+        CheckConflicts(
+            "Global",
+            other,
+            _header.global_index_offset,
+            other._header.global_index_offset,
+            GetGlobalName,
+            other.GetGlobalName
+        );
+    }
+
+    private void CheckConflicts(
+        string kind,
+        MetadataDeserializer other,
+        uint indexOffset,
+        uint otherIndexOffset,
+        Func<uint, string> getFullName,
+        Func<uint, string> getOtherFullName
+    )
+    {
+        var hashes = new HashSet<uint>();
 
-        foreach (var type in _types)
+        foreach (Metadata.IndexEntry entry in other.ReadIndex(otherIndexOffset))
         {
-            var name = GetName(type.name_table_index, type.name_table_length, out string fullname);
-            var parent = GetNamespace(fullname);
-            var result = parent.Types[name];
+            hashes.Add(entry.hash);
+        }
+
+        foreach (Metadata.IndexEntry entry in ReadIndex(indexOffset))
+        {
+            if (!hashes.Contains(entry.hash))
+                continue;
 
-            if (result is StructDecl structDecl && structDecl is not OpaqueStructDecl) //TODO: do other type decls need to be handled?
+            string key = Metadata.NameIndex.KeyOf(getFullName(entry.table_index));
+
+            if (other.Find(otherIndexOffset, key, getOtherFullName).Count > 0)
             {
-                var fields = GetFields(structDecl, type.field_table_index, type.field_table_length);
-                result.LLVMType.StructSetBody(fields.AsLLVMTypes(), false);
+                int separator = key.IndexOfAny(new[] { '#', '.' });
+                throw new Exception(
+                    $"{kind} \"{key.Substring(0, separator)}::{key.Substring(separator + 1)}\" "
+                        + $"from library \"{_libName}\" conflicts with the one from library "
+                        + $"\"{other._libName}\"."
+                );
             }
         }
+    }
+
+    private bool HasOrderedTables()
+    {
+        uint[] offsets =
+        {
+            (uint)sizeof(Version) * 2 + (uint)sizeof(Metadata.Header),
+            _header.type_table_offset,
+            _header.field_table_offset,
+            _header.function_table_offset,
+            _header.global_variable_table_offset,
+            _header.functype_table_offset,
+            _header.param_table_offset,
+            _header.paramtype_table_offset,
+            _header.typeref_table_offset,
+            _header.namespace_table_offset,
+            _header.type_index_offset,
+            _header.function_index_offset,
+            _header.global_index_offset,
+            _header.name_table_offset,
+            _header.size
+        };
+
+        for (int i = 1; i < offsets.Length; i++)
+        {
+            if (offsets[i] < offsets[i - 1])
+                return false;
+        }
+
+        return offsets[0] == _header.type_table_offset;
+    }
+
+    // Returns every entry of one of the name indexes.
+    private Metadata.IndexEntry[] ReadIndex(uint indexOffset)
+    {
+        uint bucketCount = _image.Read<uint>(indexOffset);
 
-        foreach (var func in _functions)
+        if (bucketCount == 0 || (bucketCount & (bucketCount - 1)) != 0)
+            throw new Exception("Failed to read a name index in metadata, it may be corrupt.");
+
+        uint count = _image.Read<uint>(indexOffset + sizeof(uint) * (1 + bucketCount));
+        uint entriesOffset = indexOffset + sizeof(uint) * (bucketCount + 2);
+        var result = new Metadata.IndexEntry[count];
+
+        for (uint i = 0; i < count; i++)
         {
-            var name = TrimSigFromName(
-                GetName(func.name_table_index, func.name_table_length, out string fullname)
+            result[i] = _image.Read<Metadata.IndexEntry>(
+                entriesOffset + i * (uint)sizeof(Metadata.IndexEntry)
             );
-            var parentNmspace = GetNamespace(fullname);
-            var overloadList = new OverloadList(name);
-            IContainer parent;
+        }
 
-            if (TryGetTypeDeclByString(fullname, out TypeDecl typeDecl))
-            {
-                if (func.is_method)
-                {
-                    typeDecl.Methods.TryAdd(name, overloadList);
-                    overloadList = typeDecl.Methods[name];
-                }
-                else
-                {
-                    typeDecl.StaticMethods.TryAdd(name, overloadList);
-                    overloadList = typeDecl.StaticMethods[name];
-                }
+        return result;
+    }
 
-                parent = typeDecl;
-            }
-            else
+    // Returns the table indexes of the entries stored under a key in one of the name indexes.
+    private List<uint> Find(uint indexOffset, string key, Func<uint, string> getFullName)
+    {
+        var result = new List<uint>();
+        uint hash = Metadata.NameIndex.Hash(key);
+        uint bucketCount = _image.Read<uint>(indexOffset);
+
+        if (bucketCount == 0 || (bucketCount & (bucketCount - 1)) != 0)
+            throw new Exception("Failed to read a name index in metadata, it may be corrupt.");
+
+        uint bucketOffset = indexOffset + sizeof(uint) * (1 + (hash & (bucketCount - 1)));
+        uint entriesOffset = indexOffset + sizeof(uint) * (bucketCount + 2);
+        uint start = _image.Read<uint>(bucketOffset);
+        uint end = _image.Read<uint>(bucketOffset + sizeof(uint));
+
+        for (uint i = start; i < end; i++)
+        {
+            var entry = _image.Read<Metadata.IndexEntry>(
+                entriesOffset + i * (uint)sizeof(Metadata.IndexEntry)
+            );
+
+            if (
+                entry.hash == hash
+                && Metadata.NameIndex.KeyOf(getFullName(entry.table_index)) == key
+            )
             {
-                parentNmspace.Functions.TryAdd(name, overloadList);
-                overloadList = parentNmspace.Functions[name];
-                parent = parentNmspace;
+                result.Add(entry.table_index);
             }
+        }
 
-            var funcType = GetType(func.typeref_table_index, func.typeref_table_length)
-                is FuncType fnType
-                ? fnType
-                : throw new Exception(
-                    "Internal error: function type in metadata is not a valid function type."
-                );
-            Function result = new DefinedFunction(
+        return result;
+    }
+
+    private string GetTypeName(uint index)
+    {
+        var type = ReadEntry<Metadata.Type>(
+            _header.type_table_offset,
+            _header.field_table_offset,
+            index
+        );
+        GetName(type.name_table_index, type.name_table_length, out string fullname);
+        return fullname;
+    }
+
+    private string GetFunctionName(uint index)
+    {
+        var func = ReadEntry<Metadata.Function>(
+            _header.function_table_offset,
+            _header.global_variable_table_offset,
+            index
+        );
+        GetName(func.name_table_index, func.name_table_length, out string fullname);
+        return fullname;
+    }
+
+    private string GetGlobalName(uint index)
+    {
+        var global = ReadEntry<Metadata.Global>(
+            _header.global_variable_table_offset,
+            _header.functype_table_offset,
+            index
+        );
+        GetName(global.name_table_index, global.name_table_length, out string fullname);
+        return fullname;
+    }
+
+    private TypeDecl GetTypeDecl(uint index)
+    {
+        if (_typeDecls.TryGetValue(index, out TypeDecl existing))
+            return existing;
+
+        var type = ReadEntry<Metadata.Type>(
+            _header.type_table_offset,
+            _header.field_table_offset,
+            index
+        );
+        var name = GetName(type.name_table_index, type.name_table_length, out string fullname);
+        var parent = GetNamespace(fullname);
+        StructDecl result;
+
+        if (type.is_foreign)
+        {
+            result = new OpaqueStructDecl(
                 _compiler,
                 parent,
-                fullname,
-                funcType,
-                null,
-                func.privacy,
-                true,
+                name,
+                type.privacy,
+                type.is_union,
                 new Dictionary<string, IAttribute>()
             )
             {
                 IsExternal = true
             };
-            overloadList.Add(result);
         }
+        else
+        {
+            result = new StructDecl(
+                _compiler,
+                parent,
+                name,
+                type.privacy,
+                type.is_union,
+                new Dictionary<string, IAttribute>(),
+                _compiler.Context.CreateNamedStruct(fullname)
+            )
+            {
+                IsExternal = true
+            };
+            result.AddBuiltins();
+        }
+
+        // registered before its fields and methods, which may refer back to it
+        _typeDecls.Add(index, result);
+        parent.AddType(name, result, _libName);
 
-        foreach (var global in _globals)
+        if (result is not OpaqueStructDecl) //TODO: do other type decls need to be handled?
         {
-            var name = GetName(
-                global.name_table_index,
-                global.name_table_length,
-                out string fullname
-            );
-            var nmspace = GetNamespace(fullname);
-            var type = GetType(global.typeref_table_index, global.typeref_table_length);
-            IGlobal result = global.is_constant
-                ? new GlobalConstant(
-                    _compiler,
-                    nmspace,
-                    name,
-                    new VarType(_compiler, type),
-                    _compiler.Module.AddGlobal(type.LLVMType, fullname),
-                    new Dictionary<string, IAttribute>(),
-                    global.privacy
-                )
-                {
-                    IsExternal = true
-                }
-                : new GlobalVariable(
-                    _compiler,
-                    nmspace,
-                    name,
-                    new VarType(_compiler, type),
-                    _compiler.Module.AddGlobal(type.LLVMType, fullname),
-                    new Dictionary<string, IAttribute>(),
-                    global.privacy
-                )
-                {
-                    IsExternal = true
-                };
-            nmspace.GlobalVariables.Add(name, result);
+            var fields = GetFields(result, type.field_table_index, type.field_table_length);
+            result.LLVMType.StructSetBody(fields.AsLLVMTypes(), false);
+        }
+
+        foreach (uint method in Find(_header.function_index_offset, fullname, GetFunctionName))
+        {
+            AddFunction(method, result);
         }
+
+        return result;
     }
 
-    private bool TryGetTypeDeclByString(string fullname, out TypeDecl typeDecl)
+    private void AddFunction(uint index, TypeDecl? typeDecl)
     {
-        var match = Regex.Match(fullname, "#(.*)\\.");
+        if (!_functions.Add(index))
+            return;
+
+        var func = ReadEntry<Metadata.Function>(
+            _header.function_table_offset,
+            _header.global_variable_table_offset,
+            index
+        );
+        var name = TrimSigFromName(
+            GetName(func.name_table_index, func.name_table_length, out string fullname)
+        );
+        var overloadList = new OverloadList(name);
+        IContainer parent;
+
+        if (typeDecl != null)
+        {
+            if (func.is_method)
+            {
+                typeDecl.Methods.TryAdd(name, overloadList);
+                overloadList = typeDecl.Methods[name];
+            }
+            else
+            {
+                typeDecl.StaticMethods.TryAdd(name, overloadList);
+                overloadList = typeDecl.StaticMethods[name];
+            }
 
-        if (!match.Success)
+            parent = typeDecl;
+        }
+        else
         {
-            typeDecl = null;
-            return false;
+            var parentNmspace = GetNamespace(fullname);
+            parentNmspace.Functions.TryAdd(name, overloadList);
+            overloadList = parentNmspace.Functions[name];
+            parent = parentNmspace;
         }
 
+        var funcType = GetType(func.typeref_table_index, func.typeref_table_length)
+            is FuncType fnType
+            ? fnType
+            : throw new Exception(
+                "Internal error: function type in metadata is not a valid function type."
+            );
+        Function result = new DefinedFunction(
+            _compiler,
+            parent,
+            fullname,
+            funcType,
+            null,
+            func.privacy,
+            true,
+            new Dictionary<string, IAttribute>()
+        )
+        {
+            IsExternal = true
+        };
+        overloadList.Add(result);
+    }
+
+    private void AddGlobal(uint index)
+    {
+        if (!_globals.Add(index))
+            return;
+
+        var global = ReadEntry<Metadata.Global>(
+            _header.global_variable_table_offset,
+            _header.functype_table_offset,
+            index
+        );
+        var name = GetName(global.name_table_index, global.name_table_length, out string fullname);
         var nmspace = GetNamespace(fullname);
-        typeDecl = nmspace.Types[match.Groups[1].Value];
-        return true;
+        var type = GetType(global.typeref_table_index, global.typeref_table_length);
+        IGlobal result = global.is_constant
+            ? new GlobalConstant(
+                _compiler,
+                nmspace,
+                name,
+                _compiler.TypeTable.GetVar(type),
+                _compiler.Module.AddGlobal(type.LLVMType, fullname),
+                new Dictionary<string, IAttribute>(),
+                global.privacy
+            )
+            {
+                IsExternal = true
+            }
+            : new GlobalVariable(
+                _compiler,
+                nmspace,
+                name,
+                _compiler.TypeTable.GetVar(type),
+                _compiler.Module.AddGlobal(type.LLVMType, fullname),
+                new Dictionary<string, IAttribute>(),
+                global.privacy
+            )
+            {
+                IsExternal = true
+            };
+        nmspace.AddGlobal(name, result, _libName);
     }
 
     private string TrimSigFromName(string name)
@@ -257,14 +496,12 @@ public unsafe class MetadataDeserializer
 
     private string GetName(uint index, uint length, out string fullname)
     {
-        var builder = new StringBuilder();
+        if (_header.name_table_offset + (ulong)index + length > _header.size)
+            throw new Exception("Failed to read a name in metadata, it may be corrupt.");
 
-        for (uint i = 0; i < length; i++)
-        {
-            builder.Append((char)_names[index + i]);
-        }
-
-        fullname = builder.ToString();
+        fullname = Encoding.Latin1.GetString(
+            _image.Slice(_header.name_table_offset + index, length)
+        );
         var match = Regex.Match(fullname, "((?<=\\.).*$|(?<=#)[^\\.]+$)");
 
         if (!match.Success)
@@ -281,7 +518,11 @@ public unsafe class MetadataDeserializer
 
         for (uint i = 0; i < length; i++)
         {
-            var field = _fields[index + i];
+            var field = ReadEntry<Metadata.Field>(
+                _header.field_table_offset,
+                _header.function_table_offset,
+                index + i
+            );
             var name = GetName(
                 field.name_table_index,
                 field.name_table_length,
@@ -296,91 +537,34 @@ public unsafe class MetadataDeserializer
 
     private Type GetType(uint index, uint length)
     {
+        if (_header.typeref_table_offset + (ulong)index + length > _header.namespace_table_offset)
+            throw new Exception("Failed to parse types within metadata, it may be corrupt.");
+
+        var typeRefs = _image.Slice(_header.typeref_table_offset + index, length);
         var ptrOrRef = new List<bool>();
         Type result = null;
 
-        for (uint i = 0; i < length; i++)
+        for (int i = 0; i < typeRefs.Length; i++)
         {
-            switch ((Metadata.TypeTag)_typeRefs[index + i])
+            switch ((Metadata.TypeTag)typeRefs[i])
             {
                 case Metadata.TypeTag.Type:
                 {
-                    var bytes = new MemoryStream(
-                        _typeRefs,
-                        (int)(index + i + 1),
-                        sizeof(uint),
-                        false
-                    );
-                    uint typeIndex;
-
-                    bytes.ReadExactly(new Span<byte>((byte*)&typeIndex, sizeof(uint)));
+                    uint typeIndex = MemoryMarshal.Read<uint>(typeRefs.Slice(i + 1));
                     i += sizeof(uint);
-
-                    var type = _types[typeIndex];
-                    var name = GetName(
-                        type.name_table_index,
-                        type.name_table_length,
-                        out string fullname
-                    );
-                    var nmspace = GetNamespace(fullname);
-                    StructDecl newStructDecl;
-
-                    if (type.is_foreign)
-                    {
-                        newStructDecl = new OpaqueStructDecl(
-                            _compiler,
-                            nmspace,
-                            name,
-                            type.privacy,
-                            type.is_union,
-                            new Dictionary<string, IAttribute>()
-                        );
-                    }
-                    else
-                    {
-                        newStructDecl = new StructDecl(
-                            _compiler,
-                            nmspace,
-                            name,
-                            type.privacy,
-                            type.is_union,
-                            new Dictionary<string, IAttribute>(),
-                            (
-                                decl =>
-                                    LLVMTypeRef.CreateStruct(
-                                        GetFields(
-                                                decl as StructDecl,
-                                                type.field_table_index,
-                                                type.field_table_length
-                                            )
-                                            .AsLLVMTypes(),
-                                        false
-                                    )
-                            )
-                        )
-                        {
-                            OriginModuleVersion = _moduleVersion
-                        };
-                    }
-
-                    nmspace.Types.TryAdd(name, newStructDecl);
-                    result = newStructDecl;
+                    result = GetTypeDecl(typeIndex);
                     break;
                 }
                 case Metadata.TypeTag.FuncType:
                 {
-                    var bytes = new MemoryStream(
-                        _typeRefs,
-                        (int)(index + i + 1),
-                        sizeof(uint),
-                        false
-                    );
-                    uint typeIndex;
-
-                    bytes.ReadExactly(new Span<byte>((byte*)&typeIndex, sizeof(uint)));
+                    uint typeIndex = MemoryMarshal.Read<uint>(typeRefs.Slice(i + 1));
                     i += sizeof(uint);
 
-                    var type = _funcTypes[typeIndex];
+                    var type = ReadEntry<Metadata.FuncType>(
+                        _header.functype_table_offset,
+                        _header.param_table_offset,
+                        typeIndex
+                    );
                     var retType = GetType(
                         type.return_typeref_table_index,
                         type.return_typeref_table_length
@@ -390,7 +574,11 @@ public unsafe class MetadataDeserializer
                         type.paramtype_table_length
                     );
 
-                    result = new FuncType(_compiler, retType, paramTypes, type.is_variadic);
+                    result = _compiler.TypeTable.GetFunction(
+                        retType,
+                        paramTypes,
+                        type.is_variadic
+                    );
                     break;
                 }
                 case Metadata.TypeTag.Pointer:
@@ -447,7 +635,9 @@ public unsafe class MetadataDeserializer
 
         foreach (var b in ptrOrRef)
         {
-            result = b ? new RefType(_compiler, result) : result = new PtrType(_compiler, result);
+            result = b
+                ? _compiler.TypeTable.GetReference(result)
+                : _compiler.TypeTable.GetPointer(result);
         }
 
         return result;
@@ -459,7 +649,11 @@ public unsafe class MetadataDeserializer
 
         for (uint i = 0; i < length; i++)
         {
-            var paramType = _paramTypes[index + i];
+            var paramType = ReadEntry<Metadata.ParamType>(
+                _header.paramtype_table_offset,
+                _header.typeref_table_offset,
+                index + i
+            );
             types[i] = GetType(paramType.typeref_table_index, paramType.typeref_table_length);
         }
 
@@ -494,21 +688,15 @@ public unsafe class MetadataDeserializer
         return _compiler.ResolveNamespace(nmspace);
     }
 
-    private Span<byte> VarSpan<T>(T* var, int count = 1)
+    // Reads an entry of the table between two offsets in the header.
+    private T ReadEntry<T>(uint tableOffset, uint tableEnd, uint index)
+        where T : unmanaged
     {
-        return new Span<byte>((byte*)var, sizeof(T) * count);
-    }
+        ulong offset = tableOffset + (ulong)index * (uint)sizeof(T);
 
-    private void In<T>(T* var, int count = 1)
-    {
-        _stream.ReadExactly(VarSpan(var, count));
-    }
-
-    private void InArr<T>(ref T[] var, uint offset)
-    {
-        var = new T[(offset - (uint)_stream.Position) / (uint)sizeof(T)];
+        if (offset + (uint)sizeof(T) > tableEnd)
+            throw new Exception("Failed to read a table in metadata, it may be corrupt.");
 
-        fixed (T* ptr = var)
-            In(ptr, var.Length);
+        return _image.Read<T>((uint)offset);
     }
 }
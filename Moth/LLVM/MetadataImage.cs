@@ -0,0 +1,88 @@
+using System.IO.MemoryMappedFiles;
+using System.Runtime.CompilerServices;
+using System.Runtime.InteropServices;
+
+namespace Moth.LLVM;
+
+// The uncompressed metadata of a library, which is read in place rather than copied into managed
+// tables. It is either a mapping of the sidecar file written next to the library, or the embedded
+// metadata decompressed into memory that the GC does not move.
+public sealed unsafe class MetadataImage : IDisposable
+{
+    private readonly MemoryMappedFile? _file;
+    private readonly MemoryMappedViewAccessor? _view;
+    // kept so that the pinned array lives as long as the image
+    private readonly byte[]? _bytes;
+    private readonly byte* _pointer;
+
+    public uint Length { get; }
+
+    private MetadataImage(MemoryMappedFile file, MemoryMappedViewAccessor view, uint length)
+    {
+        _file = file;
+        _view = view;
+        _view.SafeMemoryMappedViewHandle.AcquirePointer(ref _pointer);
+        _pointer += _view.PointerOffset;
+        Length = length;
+    }
+
+    private MetadataImage(byte[] bytes)
+    {
+        _bytes = bytes;
+        _pointer = (byte*)Unsafe.AsPointer(ref MemoryMarshal.GetArrayDataReference(bytes));
+        Length = (uint)bytes.Length;
+    }
+
+    public static MetadataImage Map(string path)
+    {
+        long length = new FileInfo(path).Length;
+
+        if (length == 0 || length > uint.MaxValue)
+            throw new Exception($"Metadata file \"{path}\" has an invalid size.");
+
+        var file = MemoryMappedFile.CreateFromFile(
+            path,
+            FileMode.Open,
+            null,
+            0,
+            MemoryMappedFileAccess.Read
+        );
+
+        return new MetadataImage(
+            file,
+            file.CreateViewAccessor(0, length, MemoryMappedFileAccess.Read),
+            (uint)length
+        );
+    }
+
+    // The array has to be pinned, since the image is read through a pointer to it.
+    public static MetadataImage FromPinned(byte[] bytes) => new MetadataImage(bytes);
+
+    public T Read<T>(uint offset)
+        where T : unmanaged
+    {
+        if ((ulong)offset + (uint)sizeof(T) > Length)
+            throw new Exception("Metadata ends early, it may be corrupt.");
+
+        return Unsafe.ReadUnaligned<T>(_pointer + offset);
+    }
+
+    public ReadOnlySpan<byte> Slice(uint offset, uint length)
+    {
+        if ((ulong)offset + length > Length)
+            throw new Exception("Metadata ends early, it may be corrupt.");
+
+        return new ReadOnlySpan<byte>(_pointer + offset, (int)length);
+    }
+
+    public void Dispose()
+    {
+        if (_view != null)
+        {
+            _view.SafeMemoryMappedViewHandle.ReleasePointer();
+            _view.Dispose();
+        }
+
+        _file?.Dispose();
+    }
+}
@@ -1,4 +1,5 @@
 using System.IO.Compression;
+using System.Numerics;
 using System.Reflection.Metadata;
 using System.Runtime.InteropServices;
 using LLVMSharp;
@@ -17,7 +18,12 @@ public unsafe class MetadataSerializer : IDisposable
     private List<Metadata.Parameter> _params = new List<Metadata.Parameter>();
     private List<Metadata.ParamType> _paramTypes = new List<Metadata.ParamType>();
     private List<byte> _typeRefs = new List<byte>();
+    private List<Metadata.Namespace> _namespaces = new List<Metadata.Namespace>();
     private List<string> _names = new List<string>();
+    private List<string> _typeKeys = new List<string>();
+    private List<string> _functionKeys = new List<string>();
+    private List<string> _globalKeys = new List<string>();
+    private HashSet<string> _namespaceNames = new HashSet<string>();
     private Dictionary<Type, uint> _typeIndexes = new Dictionary<Type, uint>();
     private Dictionary<FuncType, uint> _functypeIndexes = new Dictionary<FuncType, uint>();
     private uint _typeTablePosition;
@@ -46,6 +52,7 @@ public unsafe class MetadataSerializer : IDisposable
         var version = Meta.Version;
         var moduleVersion = _compiler.ModuleVersion;
         var header = new Metadata.Header();
+        header.format = Metadata.Header.CurrentFormat;
         _compiler.Types.ForEach(AddType);
         _compiler.Functions.ForEach(AddFunction);
         _compiler.Globals.ForEach(AddGlobal);
@@ -59,6 +66,10 @@ public unsafe class MetadataSerializer : IDisposable
         OutListWithPos(&header.param_table_offset, _params);
         OutListWithPos(&header.paramtype_table_offset, _paramTypes);
         OutListWithPos(&header.typeref_table_offset, _typeRefs);
+        OutListWithPos(&header.namespace_table_offset, _namespaces);
+        OutIndexWithPos(&header.type_index_offset, _typeKeys);
+        OutIndexWithPos(&header.function_index_offset, _functionKeys);
+        OutIndexWithPos(&header.global_index_offset, _globalKeys);
 
         header.name_table_offset = (uint)_stream.Position;
 
@@ -68,6 +79,8 @@ public unsafe class MetadataSerializer : IDisposable
         }
 
         header.size = (uint)_stream.Position;
+        header.table_compressed_size = header.name_table_offset - header.type_table_offset;
+        header.name_compressed_size = header.size - header.name_table_offset;
 
         _stream.Seek(0, SeekOrigin.Begin);
         Out(&version);
@@ -86,6 +99,7 @@ public unsafe class MetadataSerializer : IDisposable
         newType.name_table_index = _nameTablePosition;
         newType.name_table_length = (uint)typeDecl.FullName.Length;
         AddName(typeDecl.FullName);
+        AddKey(_typeKeys, typeDecl.FullName);
 
         if (typeDecl is StructDecl structDecl && structDecl is not OpaqueStructDecl)
         {
@@ -155,6 +169,7 @@ public unsafe class MetadataSerializer : IDisposable
         newFunc.name_table_length = (uint)func.FullName.Length;
 
         AddName(func.FullName);
+        AddKey(_functionKeys, func.FullName);
         func.Params.ToList().ForEach(AddParam);
         _functions.Add(newFunc);
         _functionTablePosition++;
@@ -173,6 +188,7 @@ public unsafe class MetadataSerializer : IDisposable
         newGlobal.name_table_length = (uint)global.FullName.Length;
 
         AddName(global.FullName);
+        AddKey(_globalKeys, global.FullName);
         _globals.Add(newGlobal);
         _globalTablePosition++;
     }
@@ -201,6 +217,24 @@ public unsafe class MetadataSerializer : IDisposable
         _nameTablePosition += (uint)name.Length;
     }
 
+    // Indexes a symbol by name, and records its namespace so that it exists as soon as the library
+    // is loaded.
+    private void AddKey(List<string> keys, string fullName)
+    {
+        string nmspace = Metadata.NameIndex.NamespaceOf(fullName);
+
+        if (_namespaceNames.Add(nmspace))
+        {
+            var newNamespace = new Metadata.Namespace();
+            newNamespace.name_table_index = _nameTablePosition;
+            newNamespace.name_table_length = (uint)nmspace.Length;
+            AddName(nmspace);
+            _namespaces.Add(newNamespace);
+        }
+
+        keys.Add(Metadata.NameIndex.KeyOf(fullName));
+    }
+
     public (uint, uint) AddTypeRef(Type type)
     {
         var result = new List<byte>();
@@ -321,4 +355,42 @@ public unsafe class MetadataSerializer : IDisposable
         fixed (T* ptr = CollectionsMarshal.AsSpan(items))
             Out(ptr, items.Count);
     }
+
+    private void OutIndexWithPos(uint* var, List<string> keys)
+    {
+        (*var) = (uint)_stream.Position;
+
+        uint bucketCount = BitOperations.RoundUpToPowerOf2((uint)Math.Max(keys.Count, 1));
+        var buckets = new List<Metadata.IndexEntry>[bucketCount];
+        var starts = new List<uint>();
+        var entries = new List<Metadata.IndexEntry>();
+
+        for (uint i = 0; i < keys.Count; i++)
+        {
+            var entry = new Metadata.IndexEntry();
+            entry.hash = Metadata.NameIndex.Hash(keys[(int)i]);
+            entry.table_index = i;
+
+            uint bucket = entry.hash & (bucketCount - 1);
+            buckets[bucket] ??= new List<Metadata.IndexEntry>();
+            buckets[bucket].Add(entry);
+        }
+
+        foreach (var bucket in buckets)
+        {
+            starts.Add((uint)entries.Count);
+
+            if (bucket != null)
+                entries.AddRange(bucket);
+        }
+
+        starts.Add((uint)entries.Count);
+        Out(&bucketCount);
+
+        fixed (uint* ptr = CollectionsMarshal.AsSpan(starts))
+            Out(ptr, starts.Count);
+
+        fixed (Metadata.IndexEntry* ptr = CollectionsMarshal.AsSpan(entries))
+            Out(ptr, entries.Count);
+    }
 }
@@ -8,6 +8,10 @@ public class OverloadList
 
     private List<Function> _functions = new List<Function>();
 
+    // The outcome of earlier lookups, by argument types.
+    private readonly Dictionary<TypeSignature, (LookupResult, Function?)> _resolutions =
+        new Dictionary<TypeSignature, (LookupResult, Function?)>();
+
     public OverloadList(string name)
     {
         Name = name;
@@ -16,20 +20,64 @@ public class OverloadList
     public void Add(Function func)
     {
         _functions.Add(func);
+        _resolutions.Clear();
     }
 
     public Function Get(IReadOnlyList<Data.Type> paramTypes)
+    {
+        return Find(paramTypes, out Function? func) switch
+        {
+            LookupResult.Found => func,
+            LookupResult.Ambiguous
+                => throw new Exception($"Cannot infer overload for call to \"{Name}\"."),
+            _ => throw new Exception($"No candidate definition for call to \"{Name}\"."),
+        };
+    }
+
+    public bool TryGet(IReadOnlyList<Data.Type> paramTypes, out Function func)
+    {
+        return Find(paramTypes, out func) == LookupResult.Found;
+    }
+
+    private LookupResult Find(IReadOnlyList<Data.Type> paramTypes, out Function? func)
+    {
+        // abstract integers convert differently depending on their value
+        for (int i = 0; i < paramTypes.Count; i++)
+        {
+            if (paramTypes[i] is AbstractInt)
+            {
+                return Resolve(paramTypes, out func);
+            }
+        }
+
+        if (_resolutions.TryGetValue(new TypeSignature(paramTypes), out var resolution))
+        {
+            (LookupResult cached, func) = resolution;
+            return cached;
+        }
+
+        LookupResult result = Resolve(paramTypes, out func);
+        _resolutions.Add(new TypeSignature(paramTypes.ToArray()), (result, func));
+        return result;
+    }
+
+    private LookupResult Resolve(IReadOnlyList<Data.Type> paramTypes, out Function? func)
     {
         Function? sufficient = null;
         bool hasMultipleCandidates = false;
 
-        foreach (var func in _functions)
+        foreach (var candidate in _functions)
         {
-            MatchResult result = CompareParams(func.ParameterTypes, paramTypes, func.IsVariadic);
+            MatchResult result = CompareParams(
+                candidate.ParameterTypes,
+                paramTypes,
+                candidate.IsVariadic
+            );
 
             if (result == MatchResult.Exact)
             {
-                return func;
+                func = candidate;
+                return LookupResult.Found;
             }
             else if (result == MatchResult.Sufficient)
             {
@@ -38,41 +86,24 @@ public class OverloadList
                     hasMultipleCandidates = true;
                 }
 
-                sufficient = func;
+                sufficient = candidate;
             }
         }
 
         if (sufficient == null)
         {
-            throw new Exception($"No candidate definition for call to \"{Name}\".");
+            func = null;
+            return LookupResult.Missing;
         }
 
         if (hasMultipleCandidates)
-        {
-            throw new Exception($"Cannot infer overload for call to \"{Name}\".");
-        }
-
-        return sufficient;
-    }
-
-    public bool TryGet(IReadOnlyList<Data.Type> paramTypes, out Function func)
-    {
-        try
-        {
-            func = Get(paramTypes);
-
-            if (func == null)
-            {
-                throw new Exception();
-            }
-
-            return true;
-        }
-        catch
         {
             func = null;
-            return false;
+            return LookupResult.Ambiguous;
         }
+
+        func = sufficient;
+        return LookupResult.Found;
     }
 
     private MatchResult CompareParams(
@@ -151,4 +182,11 @@ public class OverloadList
         Sufficient,
         Insufficient
     }
+
+    enum LookupResult
+    {
+        Found,
+        Ambiguous,
+        Missing
+    }
 }
@@ -0,0 +1,21 @@
+using Moth.LLVM.Data;
+
+namespace Moth.LLVM;
+
+// Remembers what a name resolved to from a namespace and its set of imports, so that repeated
+// references skip walking the namespace chain and every import. Only successful lookups are kept,
+// so the cache has to be cleared whenever a new declaration could shadow one of them.
+public sealed class ResolutionCache<T>
+    where T : class
+{
+    private readonly Dictionary<(Namespace, Namespace[], string), T> _entries =
+        new Dictionary<(Namespace, Namespace[], string), T>();
+
+    public bool TryGet(Namespace nmspace, Namespace[] imports, string name, out T value) =>
+        _entries.TryGetValue((nmspace, imports, name), out value);
+
+    public void Add(Namespace nmspace, Namespace[] imports, string name, T value) =>
+        _entries[(nmspace, imports, name)] = value;
+
+    public void Clear() => _entries.Clear();
+}
@@ -0,0 +1,48 @@
+using System.Runtime.CompilerServices;
+
+namespace Moth.LLVM;
+
+// A list of types compared element by element by reference, for use as a dictionary key. Types
+// handed out by TypeTable are canonical, so this is both cheaper and stricter than Equals, which
+// lets a pointer match a reference in one direction.
+public readonly struct TypeSignature : IEquatable<TypeSignature>
+{
+    public IReadOnlyList<Data.Type> Types { get; }
+
+    public TypeSignature(IReadOnlyList<Data.Type> types)
+    {
+        Types = types;
+    }
+
+    public bool Equals(TypeSignature other)
+    {
+        if (Types.Count != other.Types.Count)
+        {
+            return false;
+        }
+
+        for (int i = 0; i < Types.Count; i++)
+        {
+            if (!ReferenceEquals(Types[i], other.Types[i]))
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    public override bool Equals(object? obj) => obj is TypeSignature other && Equals(other);
+
+    public override int GetHashCode()
+    {
+        var hash = new HashCode();
+
+        for (int i = 0; i < Types.Count; i++)
+        {
+            hash.Add(RuntimeHelpers.GetHashCode(Types[i]));
+        }
+
+        return hash.ToHashCode();
+    }
+}
@@ -0,0 +1,172 @@
+using System.Runtime.CompilerServices;
+using Moth.LLVM.Data;
+
+namespace Moth.LLVM;
+
+// Hands out a single instance for each structural type built by a compiler, so that the same
+// pointer, reference or function type is only allocated once and compares by reference. Abstract
+// integers all compare equal while carrying different values, so types built on them are never
+// shared. Lookups compare the component types by reference, since Equals on pointer types is
+// lenient in one direction and would otherwise hand out a pointer where a reference was asked for.
+public sealed class TypeTable
+{
+    private readonly LLVMCompiler _compiler;
+    private readonly Dictionary<Data.Type, PtrType> _pointers =
+        new Dictionary<Data.Type, PtrType>(ReferenceEqualityComparer.Instance);
+    private readonly Dictionary<Data.Type, RefType> _references =
+        new Dictionary<Data.Type, RefType>(ReferenceEqualityComparer.Instance);
+    private readonly Dictionary<Data.Type, VarType> _vars =
+        new Dictionary<Data.Type, VarType>(ReferenceEqualityComparer.Instance);
+    private readonly Dictionary<Data.Type, ArrStructDecl> _arrays =
+        new Dictionary<Data.Type, ArrStructDecl>(ReferenceEqualityComparer.Instance);
+    private readonly Dictionary<FuncKey, FuncType> _funcs = new Dictionary<FuncKey, FuncType>();
+    private readonly Dictionary<FuncKey, LocalFuncType> _localFuncs =
+        new Dictionary<FuncKey, LocalFuncType>();
+    private readonly Dictionary<Data.Type, Dictionary<Data.Type, bool>> _conversions =
+        new Dictionary<Data.Type, Dictionary<Data.Type, bool>>(ReferenceEqualityComparer.Instance);
+
+    public TypeTable(LLVMCompiler compiler)
+    {
+        _compiler = compiler;
+    }
+
+    public PtrType GetPointer(Data.Type baseType)
+    {
+        if (baseType is AbstractInt)
+            return new PtrType(_compiler, baseType);
+
+        if (!_pointers.TryGetValue(baseType, out PtrType type))
+        {
+            type = new PtrType(_compiler, baseType);
+            _pointers.Add(baseType, type);
+        }
+
+        return type;
+    }
+
+    public RefType GetReference(Data.Type baseType)
+    {
+        if (baseType is AbstractInt)
+            return new RefType(_compiler, baseType);
+
+        if (!_references.TryGetValue(baseType, out RefType type))
+        {
+            type = new RefType(_compiler, baseType);
+            _references.Add(baseType, type);
+        }
+
+        return type;
+    }
+
+    public VarType GetVar(Data.Type baseType)
+    {
+        if (baseType is AbstractInt)
+            return new VarType(_compiler, baseType);
+
+        if (!_vars.TryGetValue(baseType, out VarType type))
+        {
+            type = new VarType(_compiler, baseType);
+            _vars.Add(baseType, type);
+        }
+
+        return type;
+    }
+
+    public ArrStructDecl GetArray(Data.Type elementType)
+    {
+        if (elementType is AbstractInt)
+            return new ArrStructDecl(_compiler, elementType);
+
+        if (!_arrays.TryGetValue(elementType, out ArrStructDecl type))
+        {
+            type = new ArrStructDecl(_compiler, elementType);
+            _arrays.Add(elementType, type);
+        }
+
+        return type;
+    }
+
+    public FuncType GetFunction(Data.Type retType, Data.Type[] paramTypes, bool isVariadic)
+    {
+        var key = new FuncKey(retType, paramTypes, isVariadic);
+
+        if (key.HasAbstractInt)
+            return new FuncType(_compiler, retType, paramTypes, isVariadic);
+
+        if (!_funcs.TryGetValue(key, out FuncType type))
+        {
+            type = new FuncType(_compiler, retType, paramTypes, isVariadic);
+            _funcs.Add(key, type);
+        }
+
+        return type;
+    }
+
+    public LocalFuncType GetLocalFunction(Data.Type retType, Data.Type[] paramTypes)
+    {
+        var key = new FuncKey(retType, paramTypes, false);
+
+        if (key.HasAbstractInt)
+            return new LocalFuncType(_compiler, retType, paramTypes);
+
+        if (!_localFuncs.TryGetValue(key, out LocalFuncType type))
+        {
+            type = new LocalFuncType(_compiler, retType, paramTypes);
+            _localFuncs.Add(key, type);
+        }
+
+        return type;
+    }
+
+    // Whether a value of one type implicitly converts to another. Most types build a new
+    // conversion table whenever they are asked for one, so the answer is kept per pair of types.
+    public bool CanConvert(Data.Type from, Data.Type to)
+    {
+        // the conversions of abstract integers depend on their value, and every literal has its own
+        if (from is AbstractInt || to is AbstractInt)
+            return from.Equals(to) || from.GetImplicitConversions().Contains(to);
+
+        if (!_conversions.TryGetValue(from, out Dictionary<Data.Type, bool> targets))
+        {
+            targets = new Dictionary<Data.Type, bool>(ReferenceEqualityComparer.Instance);
+            _conversions.Add(from, targets);
+        }
+
+        if (!targets.TryGetValue(to, out bool result))
+        {
+            result = from.Equals(to) || from.GetImplicitConversions().Contains(to);
+            targets.Add(to, result);
+        }
+
+        return result;
+    }
+
+    // Function types are looked up by their signature without constructing a FuncType first,
+    // since that would create an LLVM function type for every lookup.
+    private readonly struct FuncKey : IEquatable<FuncKey>
+    {
+        private readonly Data.Type _retType;
+        private readonly TypeSignature _paramTypes;
+        private readonly bool _isVariadic;
+
+        public FuncKey(Data.Type retType, Data.Type[] paramTypes, bool isVariadic)
+        {
+            _retType = retType;
+            _paramTypes = new TypeSignature(paramTypes);
+            _isVariadic = isVariadic;
+        }
+
+        public bool HasAbstractInt =>
+            _retType is AbstractInt || _paramTypes.Types.Any(t => t is AbstractInt);
+
+        public bool Equals(FuncKey other) =>
+            _isVariadic == other._isVariadic
+            && ReferenceEquals(_retType, other._retType)
+            && _paramTypes.Equals(other._paramTypes);
+
+        public override bool Equals(object? obj) => obj is FuncKey other && Equals(other);
+
+        public override int GetHashCode() =>
+            HashCode.Combine(RuntimeHelpers.GetHashCode(_retType), _paramTypes, _isVariadic);
+    }
+}
@@ -9,6 +9,7 @@ public class Logger : TextWriter
     private static string BackupLogFile { get; }
     private static FileStream Stream { get; }
     private static StreamWriter Writer { get; }
+    private static object WriteLock { get; } = new object();
 
     public string Name { get; set; }
     public override Encoding Encoding { get; }
@@ -102,8 +103,11 @@ public class Logger : TextWriter
 
     public void WriteUnsigned(string message, Style style)
     {
-        AnsiConsole.Write(new Text(message, style));
-        Write(message);
+        lock (WriteLock)
+        {
+            AnsiConsole.Write(new Text(message, style));
+            Write(message);
+        }
     }
 
     public void WriteUnsigned(string message)
@@ -117,5 +121,11 @@ public class Logger : TextWriter
 
     public override void Write(char value) => WriteUnsigned(value);
 
-    public override void Write(string? value) => Writer.Write(value ?? String.Empty);
+    public override void Write(string? value)
+    {
+        lock (WriteLock)
+        {
+            Writer.Write(value ?? String.Empty);
+        }
+    }
 }
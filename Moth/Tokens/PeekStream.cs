@@ -1,8 +1,16 @@
-﻿namespace Moth.Tokens;
+﻿using System.Buffers;
+
+namespace Moth.Tokens;
 
 public struct PeekStream
 {
+    private static readonly SearchValues<char> Whitespace = SearchValues.Create(" \t\r\n");
+    private static readonly SearchValues<char> AsciiIdentifierChars = SearchValues.Create(
+        "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ_abcdefghijklmnopqrstuvwxyz"
+    );
+
     public int Position;
+    public readonly SourceFile Source;
     private readonly string _text;
     public int Length
     {
@@ -13,8 +21,12 @@ public struct PeekStream
         : this(string.Empty) => Position = 0;
 
     public PeekStream(string text)
+        : this(new SourceFile(text)) { }
+
+    public PeekStream(SourceFile source)
     {
-        _text = text;
+        Source = source;
+        _text = source.Text;
         Position = 0;
     }
 
@@ -57,6 +69,62 @@ public struct PeekStream
     public ReadOnlyMemory<char> Peek(int count) =>
         Position + count <= Length ? _text.AsMemory(Position, count) : default;
 
+    public ReadOnlyMemory<char> Slice(int start, int length) => _text.AsMemory(start, length);
+
+    // The scanners below are vectorized instead of walking the text one char at a time.
+
+    public ReadOnlyMemory<char> PeekIdentifier()
+    {
+        ReadOnlySpan<char> span = _text.AsSpan(Position);
+        int length = 0;
+
+        while (true)
+        {
+            int next = span[length..].IndexOfAnyExcept(AsciiIdentifierChars);
+
+            if (next == -1)
+            {
+                return _text.AsMemory(Position);
+            }
+
+            length += next;
+
+            // non-ASCII letters and digits are rare, step over them and keep searching
+            if (!char.IsLetterOrDigit(span[length]))
+            {
+                return _text.AsMemory(Position, length);
+            }
+
+            length++;
+        }
+    }
+
+    public int LengthOfWhitespace()
+    {
+        int length = _text.AsSpan(Position).IndexOfAnyExcept(Whitespace);
+        return length == -1 ? Length - Position : length;
+    }
+
+    // These return an absolute position, or the end of the text if there is no match.
+
+    public int IndexOf(int start, char value)
+    {
+        int index = _text.AsSpan(start).IndexOf(value);
+        return index == -1 ? Length : start + index;
+    }
+
+    public int IndexOf(int start, ReadOnlySpan<char> value)
+    {
+        int index = _text.AsSpan(start).IndexOf(value);
+        return index == -1 ? Length : start + index;
+    }
+
+    public int IndexOfAny(int start, char value0, char value1)
+    {
+        int index = _text.AsSpan(start).IndexOfAny(value0, value1);
+        return index == -1 ? Length : start + index;
+    }
+
     public ReadOnlyMemory<char> Peek(Func<char, bool> condition)
     {
         ReadOnlySpan<char> span = _text.AsSpan(Position);
@@ -75,39 +143,11 @@ public struct PeekStream
 
     public int CurrentLine
     {
-        get
-        {
-            int count = 1;
-            foreach (char ch in _text.AsSpan(0, Position))
-            {
-                if (ch == '\n')
-                {
-                    count++;
-                }
-            }
-
-            return count;
-        }
+        get { return Source.GetLocation(Position).Line; }
     }
 
     public int CurrentColumn
     {
-        get
-        {
-            int column = 1;
-            foreach (char ch in _text.AsSpan(0, Position))
-            {
-                if (ch == '\n')
-                {
-                    column = 1;
-                }
-                else
-                {
-                    column++;
-                }
-            }
-
-            return column;
-        }
+        get { return Source.GetLocation(Position).Column; }
     }
 }
@@ -0,0 +1,65 @@
+namespace Moth.Tokens;
+
+// Maps char positions in a file to lines and columns. The line table is built on the first
+// lookup, after which every lookup is a binary search.
+public sealed class SourceFile
+{
+    public string Path { get; }
+    public string Text { get; }
+
+    private int[]? _lineStarts;
+
+    public SourceFile(string text, string path = "")
+    {
+        Text = text;
+        Path = path;
+    }
+
+    public int LineCount
+    {
+        get { return LineStarts.Length; }
+    }
+
+    private int[] LineStarts
+    {
+        get { return _lineStarts ??= BuildLineStarts(Text); }
+    }
+
+    // Both line and column are 1-based.
+    public (int Line, int Column) GetLocation(int position)
+    {
+        int[] lineStarts = LineStarts;
+        int line = lineStarts.AsSpan().BinarySearch(position);
+
+        // an inexact match returns the complement of the next line's index
+        if (line < 0)
+            line = ~line - 1;
+
+        return (line + 1, position - lineStarts[line] + 1);
+    }
+
+    public (int Line, int Column) GetLocation(SourceSpan span) => GetLocation(span.Begin);
+
+    public ReadOnlySpan<char> GetText(SourceSpan span) => Text.AsSpan(span.Begin, span.Length);
+
+    public override string ToString() => Path;
+
+    private static int[] BuildLineStarts(string text)
+    {
+        var lineStarts = new List<int> { 0 };
+        int position = 0;
+
+        while (true)
+        {
+            int next = text.AsSpan(position).IndexOf('\n');
+
+            if (next == -1)
+                break;
+
+            position += next + 1;
+            lineStarts.Add(position);
+        }
+
+        return lineStarts.ToArray();
+    }
+}
@@ -0,0 +1,39 @@
+namespace Moth.Tokens;
+
+// A range of chars in a source file, resolved to lines and columns through SourceFile.
+public readonly struct SourceSpan
+{
+    public readonly int Begin;
+    public readonly int Length;
+
+    public SourceSpan(int begin, int length)
+    {
+        Begin = begin;
+        Length = length;
+    }
+
+    public int End
+    {
+        get { return Begin + Length; }
+    }
+
+    public bool IsEmpty
+    {
+        get { return Length == 0; }
+    }
+
+    public static SourceSpan FromBounds(int begin, int end) => new SourceSpan(begin, end - begin);
+
+    public SourceSpan Union(SourceSpan other)
+    {
+        if (IsEmpty)
+            return other;
+
+        if (other.IsEmpty)
+            return this;
+
+        return FromBounds(Math.Min(Begin, other.Begin), Math.Max(End, other.End));
+    }
+
+    public override string ToString() => $"{Begin}..{End}";
+}
@@ -0,0 +1,97 @@
+namespace Moth.Tokens;
+
+// Interns identifiers so that each distinct name is allocated once per table.
+// Symbol 0 is reserved to mean "no symbol".
+public sealed class SymbolTable
+{
+    private struct Entry
+    {
+        public string Name;
+        public int HashCode;
+        public int Next;
+    }
+
+    private int[] _buckets = new int[256];
+    private Entry[] _entries = new Entry[256];
+    private int _count = 1;
+
+    public int Count
+    {
+        get { return _count - 1; }
+    }
+
+    public string this[int symbol]
+    {
+        get
+        {
+            if (symbol <= 0 || symbol >= _count)
+            {
+                throw new ArgumentOutOfRangeException(nameof(symbol));
+            }
+
+            return _entries[symbol].Name;
+        }
+    }
+
+    public int Intern(string name) => Intern(name.AsSpan(), name);
+
+    public int Intern(ReadOnlySpan<char> name) => Intern(name, null);
+
+    public bool TryGetSymbol(ReadOnlySpan<char> name, out int symbol)
+    {
+        int hashCode = string.GetHashCode(name);
+        symbol = _buckets[hashCode & (_buckets.Length - 1)];
+
+        while (symbol != 0)
+        {
+            ref Entry entry = ref _entries[symbol];
+
+            if (entry.HashCode == hashCode && name.SequenceEqual(entry.Name))
+            {
+                return true;
+            }
+
+            symbol = entry.Next;
+        }
+
+        return false;
+    }
+
+    private int Intern(ReadOnlySpan<char> name, string? original)
+    {
+        if (TryGetSymbol(name, out int symbol))
+        {
+            return symbol;
+        }
+
+        if (_count == _entries.Length)
+        {
+            Grow();
+        }
+
+        int hashCode = string.GetHashCode(name);
+        ref int bucket = ref _buckets[hashCode & (_buckets.Length - 1)];
+        symbol = _count++;
+        _entries[symbol] = new Entry
+        {
+            Name = original ?? name.ToString(),
+            HashCode = hashCode,
+            Next = bucket,
+        };
+        bucket = symbol;
+        return symbol;
+    }
+
+    private void Grow()
+    {
+        System.Array.Resize(ref _entries, _entries.Length * 2);
+        _buckets = new int[_buckets.Length * 2];
+
+        for (int i = 1; i < _count; i++)
+        {
+            ref int bucket = ref _buckets[_entries[i].HashCode & (_buckets.Length - 1)];
+            _entries[i].Next = bucket;
+            bucket = i;
+        }
+    }
+}
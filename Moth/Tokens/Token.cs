@@ -7,6 +7,9 @@ public readonly struct Token
     public required TokenType Type { get; init; }
     public ReadOnlyMemory<char> Text { get; init; }
 
+    // The interned name of a Name token, see SymbolTable.
+    public int Symbol { get; init; }
+
     public int Begin
     {
         get
@@ -25,6 +28,15 @@ public readonly struct Token
         }
     }
 
+    public SourceSpan Span
+    {
+        get
+        {
+            MemoryMarshal.TryGetString(Text, out _, out int start, out int length);
+            return new SourceSpan(start, length);
+        }
+    }
+
     public override string ToString() =>
         Text.IsEmpty ? $"Token<{Type}>" : $"Token<{Type}>(\"{Text}\")";
 }
@@ -5,10 +5,16 @@ namespace Moth.Tokens;
 
 public static class Tokenizer
 {
-    public static List<Token> Tokenize(string text)
+    public static List<Token> Tokenize(string text) => Tokenize(text, new SymbolTable());
+
+    public static List<Token> Tokenize(string text, SymbolTable symbols) =>
+        Tokenize(new SourceFile(text), symbols);
+
+    // Every token's text is a slice of the source, escapes are left in place until Unescape is called.
+    public static List<Token> Tokenize(SourceFile source, SymbolTable symbols)
     {
         var tokens = new List<Token>(78);
-        var stream = new PeekStream(text);
+        var stream = new PeekStream(source);
 
         while (stream.Current is { } ch)
         {
@@ -18,27 +24,20 @@ public static class Tokenizer
                 or '\r'
                 or '\t'
                 or ' ':
+                    stream.Position += stream.LengthOfWhitespace() - 1;
                     break;
 
                 // Capture comments
                 case '/' when stream.Next is '/':
                 {
-                    var builder = new StringBuilder();
-                    stream.Position++;
-
-                    while (stream.MoveNext(out ch))
-                    {
-                        if (ch == '\n')
-                            break;
-
-                        builder.Append(ch);
-                    }
+                    int start = stream.Position + 2;
+                    stream.Position = stream.IndexOf(start, '\n');
 
                     tokens.Add(
                         new Token()
                         {
                             Type = TokenType.Comment,
-                            Text = builder.ToString().AsMemory(),
+                            Text = stream.Slice(start, stream.Position - start),
                         }
                     );
                     break;
@@ -46,22 +45,14 @@ public static class Tokenizer
 
                 case '/' when stream.Next is '>':
                 {
-                    var builder = new StringBuilder();
-                    stream.Position++;
-
-                    while (stream.MoveNext(out ch))
-                    {
-                        if (ch == '<' && stream.Next == '/')
-                            break;
-
-                        builder.Append(ch);
-                    }
+                    int start = stream.Position + 2;
+                    stream.Position = stream.IndexOf(start, "</");
 
                     tokens.Add(
                         new Token()
                         {
                             Type = TokenType.BlockComment,
-                            Text = builder.ToString().AsMemory()
+                            Text = stream.Slice(start, stream.Position - start)
                         }
                     );
                     stream.Position++;
@@ -72,7 +63,7 @@ public static class Tokenizer
                 {
                     stream.Position++;
                     tokens.Add(
-                        new Token() { Type = TokenType.ScientificNotation, Text = "e+".AsMemory(), }
+                        new Token() { Type = TokenType.ScientificNotation, Text = stream.Peek(2), }
                     );
                     break;
                 }
@@ -94,16 +85,18 @@ public static class Tokenizer
                     }
                     else
                     {
+                        int start = stream.Position;
+                        ProcessCharacter(ref stream);
+                        stream.Position++;
+
                         tokens.Add(
                             new Token()
                             {
                                 Type = TokenType.LiteralChar,
-                                Text = $"{ProcessCharacter(ref stream)}".AsMemory(),
+                                Text = stream.Slice(start, stream.Position - start),
                             }
                         );
 
-                        stream.Position++;
-
                         if (stream.Current == '\'')
                         {
                             break;
@@ -128,12 +121,11 @@ public static class Tokenizer
                 and <= 'Z':
                 case '_':
                 {
-                    ReadOnlyMemory<char> keyword = stream.Peek(c =>
-                        char.IsLetterOrDigit(c) || c == '_'
-                    );
+                    ReadOnlyMemory<char> keyword = stream.PeekIdentifier();
 
-                    if (keyword.Span.ToString() == "op")
+                    if (keyword.Span.SequenceEqual("op"))
                     {
+                        int start = stream.Position;
                         stream.Position += keyword.Length - 1;
 
                         if (stream.Next != '{')
@@ -179,49 +171,59 @@ public static class Tokenizer
 
                         stream.Position++;
 
-                        tokens.Add(new Token { Text = name.AsMemory(), Type = TokenType.Name, });
+                        tokens.Add(
+                            new Token
+                            {
+                                Text = stream.Slice(start, stream.Position + 1 - start),
+                                Type = TokenType.Name,
+                                Symbol = symbols.Intern(name),
+                            }
+                        );
 
                         break;
                     }
                     else
                     {
+                        var type = keyword.Span switch
+                        {
+                            Reserved.If => TokenType.If,
+                            Reserved.Null => TokenType.Null,
+                            Reserved.Var => TokenType.Local,
+                            Reserved.Self => TokenType.This,
+                            Reserved.Extend => TokenType.Extend,
+                            Reserved.Namespace => TokenType.Namespace,
+                            Reserved.Then => TokenType.Then,
+                            Reserved.Constant => TokenType.Constant,
+                            Reserved.While => TokenType.While,
+                            Reserved.True => TokenType.True,
+                            Reserved.Else => TokenType.Else,
+                            Reserved.False => TokenType.False,
+                            Reserved.Enum => TokenType.Enum,
+                            Reserved.For => TokenType.For,
+                            Reserved.In => TokenType.In,
+                            Reserved.Or => TokenType.Or,
+                            Reserved.And => TokenType.And,
+                            Reserved.Root => TokenType.Root,
+                            Reserved.Global => TokenType.Global,
+                            Reserved.Function => TokenType.Function,
+                            Reserved.Type => TokenType.Type,
+                            Reserved.Union => TokenType.Union,
+                            Reserved.Implement => TokenType.Implement,
+                            Reserved.Trait => TokenType.Trait,
+                            Reserved.With => TokenType.Import,
+                            Reserved.Public => TokenType.Public,
+                            Reserved.Static => TokenType.Static,
+                            Reserved.Return => TokenType.Return,
+                            Reserved.Foreign => TokenType.Foreign,
+                            _ => TokenType.Name,
+                        };
+
                         tokens.Add(
                             new Token
                             {
                                 Text = keyword,
-                                Type = keyword.Span switch
-                                {
-                                    Reserved.If => TokenType.If,
-                                    Reserved.Null => TokenType.Null,
-                                    Reserved.Var => TokenType.Local,
-                                    Reserved.Self => TokenType.This,
-                                    Reserved.Extend => TokenType.Extend,
-                                    Reserved.Namespace => TokenType.Namespace,
-                                    Reserved.Then => TokenType.Then,
-                                    Reserved.Constant => TokenType.Constant,
-                                    Reserved.While => TokenType.While,
-                                    Reserved.True => TokenType.True,
-                                    Reserved.Else => TokenType.Else,
-                                    Reserved.False => TokenType.False,
-                                    Reserved.Enum => TokenType.Enum,
-                                    Reserved.For => TokenType.For,
-                                    Reserved.In => TokenType.In,
-                                    Reserved.Or => TokenType.Or,
-                                    Reserved.And => TokenType.And,
-                                    Reserved.Root => TokenType.Root,
-                                    Reserved.Global => TokenType.Global,
-                                    Reserved.Function => TokenType.Function,
-                                    Reserved.Type => TokenType.Type,
-                                    Reserved.Union => TokenType.Union,
-                                    Reserved.Implement => TokenType.Implement,
-                                    Reserved.Trait => TokenType.Trait,
-                                    Reserved.With => TokenType.Import,
-                                    Reserved.Public => TokenType.Public,
-                                    Reserved.Static => TokenType.Static,
-                                    Reserved.Return => TokenType.Return,
-                                    Reserved.Foreign => TokenType.Foreign,
-                                    _ => TokenType.Name,
-                                },
+                                Type = type,
+                                Symbol = type == TokenType.Name ? symbols.Intern(keyword.Span) : 0,
                             }
                         );
 
@@ -234,24 +236,30 @@ public static class Tokenizer
                 case '"':
                 {
                     stream.Position++;
-                    var builder = new StringBuilder();
+                    int start = stream.Position;
 
+                    // jump straight to the closing quote, stopping only to validate escapes
                     while (stream.Current != null)
                     {
-                        if (stream.Current == '"')
+                        stream.Position = stream.IndexOfAny(stream.Position, '"', '\\');
+
+                        if (stream.Current is null or '"')
                         {
                             break;
                         }
                         else
                         {
-                            builder.Append(ProcessCharacter(ref stream));
+                            ProcessCharacter(ref stream);
                             stream.Position++;
                         }
                     }
 
-                    string @string = builder.ToString();
                     tokens.Add(
-                        new Token { Text = @string.AsMemory(), Type = TokenType.LiteralString }
+                        new Token
+                        {
+                            Text = stream.Slice(start, stream.Position - start),
+                            Type = TokenType.LiteralString
+                        }
                     );
 
                     break;
@@ -267,7 +275,7 @@ public static class Tokenizer
                     tokens.Add(
                         new Token()
                         {
-                            Text = $"{character}".AsMemory(),
+                            Text = stream.Peek(1),
                             Type = character == '?' ? TokenType.TemplateTypeRef : TokenType.TypeRef,
                         }
                     );
@@ -370,23 +378,18 @@ public static class Tokenizer
                 case >= '0'
                 and <= '9':
                 {
-                    var builder = new StringBuilder();
+                    int start = stream.Position;
 
                     while (
-                        char.IsDigit((char)stream.Current)
-                        || (char)stream.Current == '.'
-                        || (char)stream.Current == '_'
+                        stream.Current is { } digit
+                        && (char.IsDigit(digit) || digit == '.' || digit == '_')
                     )
                     {
-                        if ((char)stream.Current != '_')
-                        {
-                            builder.Append((char)stream.Current);
-                        }
-
                         stream.Position++;
                     }
 
-                    ReadOnlyMemory<char> number = builder.ToString().AsMemory();
+                    // underscores stay in the token text, see ParseNumber
+                    ReadOnlyMemory<char> number = stream.Slice(start, stream.Position - start);
                     int dots = 0;
                     ReadOnlySpan<char> numberSpan = number.Span;
                     for (int i = 0; i < numberSpan.Length; i++)
@@ -398,12 +401,14 @@ public static class Tokenizer
 
                         if (dots >= 2)
                         {
+                            var errorStream = stream;
+                            errorStream.Position = start + i;
                             throw new TokenizerException
                             {
                                 Character = numberSpan[i],
-                                Position = stream.Position + i + 1,
-                                Column = stream.CurrentColumn + i + 1,
-                                Line = stream.CurrentLine,
+                                Position = errorStream.Position,
+                                Column = errorStream.CurrentColumn,
+                                Line = errorStream.CurrentLine,
                             };
                         }
                     }
@@ -443,31 +448,63 @@ public static class Tokenizer
         if (stream.Current == '\\')
         {
             stream.Position++;
-            return stream.Current switch
-            {
-                '0' => '\0',
-                'n' => '\n',
-                'r' => '\r',
-                't' => '\t',
-                'b' => '\b',
-                '\\' => '\\',
-                '"' => '"',
-                '\'' => '\'',
-                _
-                    => throw new TokenizerException()
-                    {
-                        Character = (char)stream.Next,
-                        Line = stream.CurrentLine,
-                        Column = stream.CurrentColumn,
-                        Position = stream.Position,
-                    },
-            };
+            return EscapeToChar(stream.Current)
+                ?? throw new TokenizerException()
+                {
+                    Character = (char)stream.Next,
+                    Line = stream.CurrentLine,
+                    Column = stream.CurrentColumn,
+                    Position = stream.Position,
+                };
         }
         else
         {
             return stream.Current;
         }
     }
+
+    // Resolves the escapes of a string or char literal token, which the tokenizer has already validated.
+    public static string Unescape(ReadOnlySpan<char> text)
+    {
+        int escape = text.IndexOf('\\');
+
+        if (escape == -1)
+        {
+            return text.ToString();
+        }
+
+        var builder = new StringBuilder(text.Length);
+
+        while (escape != -1)
+        {
+            builder.Append(text[..escape]);
+            builder.Append(
+                EscapeToChar(text[escape + 1])
+                    ?? throw new Exception($"Invalid escape sequence \"\\{text[escape + 1]}\".")
+            );
+            text = text[(escape + 2)..];
+            escape = text.IndexOf('\\');
+        }
+
+        builder.Append(text);
+        return builder.ToString();
+    }
+
+    private static char? EscapeToChar(char? ch)
+    {
+        return ch switch
+        {
+            '0' => '\0',
+            'n' => '\n',
+            'r' => '\r',
+            't' => '\t',
+            'b' => '\b',
+            '\\' => '\\',
+            '"' => '"',
+            '\'' => '\'',
+            _ => null,
+        };
+    }
 }
 
 public sealed class TokenizerException : Exception
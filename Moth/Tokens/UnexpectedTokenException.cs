@@ -1,6 +1,4 @@
-﻿using System.Runtime.InteropServices;
-
-namespace Moth.Tokens;
+﻿namespace Moth.Tokens;
 
 public sealed class UnexpectedTokenException : Exception
 {
@@ -24,27 +22,13 @@ public sealed class UnexpectedTokenException : Exception
         }
     }
 
-    public UnexpectedTokenException(Token token, TokenType? expected = null)
+    // The location is looked up in the line table of the file being parsed, when there is one.
+    public UnexpectedTokenException(Token token, SourceFile? source, TokenType? expected = null)
     {
         Token = token;
         Expected = expected;
-        if (MemoryMarshal.TryGetString(token.Text, out string? text, out int start, out _))
-        {
-            Line = 1;
-            Column = 1;
-            for (int i = 0; i < start; i++)
-            {
-                char ch = text[i];
-                if (ch == '\n')
-                {
-                    Line++;
-                    Column = 1;
-                }
-                else
-                {
-                    Column++;
-                }
-            }
-        }
+
+        if (source != null)
+            (Line, Column) = source.GetLocation(token.Begin);
     }
 }
@@ -32,12 +32,38 @@ public static class Utils
     {
         if (old.Type != @new.Type)
             return false;
-        if (old.Text.ToString() != @new.Text.ToString())
+
+        // number literals are written back from their value, which drops digit separators
+        if (old.Type == TokenType.LiteralInt || old.Type == TokenType.LiteralFloat)
+            return CompareDigits(old.Text.Span, @new.Text.Span);
+
+        if (!old.Text.Span.SequenceEqual(@new.Text.Span))
             return false;
         else
             return true;
     }
 
+    private static bool CompareDigits(ReadOnlySpan<char> old, ReadOnlySpan<char> @new)
+    {
+        int i = 0;
+        int j = 0;
+
+        while (true)
+        {
+            while (i < old.Length && old[i] == '_')
+                i++;
+
+            while (j < @new.Length && @new[j] == '_')
+                j++;
+
+            if (i == old.Length || j == @new.Length)
+                return i == old.Length && j == @new.Length;
+
+            if (old[i++] != @new[j++])
+                return false;
+        }
+    }
+
     public static List<T> Combine<T>(params IEnumerable<T>[] listList)
     {
         var result = new List<T>();
@@ -62,6 +88,20 @@ public static class Utils
         };
     }
 
+    public static OptimizationLevel StringToOptLevel(string str)
+    {
+        return str switch
+        {
+            "0" => OptimizationLevel.O0,
+            "1" => OptimizationLevel.O1,
+            "2" => OptimizationLevel.O2,
+            "3" => OptimizationLevel.O3,
+            "s" => OptimizationLevel.Os,
+            "z" => OptimizationLevel.Oz,
+            _ => throw new NotImplementedException($"Unsupported optimization level: \"{str}\"")
+        };
+    }
+
     public static void TypeAutoExport(LLVMCompiler compiler, Type type, bool child = false)
     {
         if (type is StructDecl structDecl)
@@ -197,65 +237,6 @@ public static class Utils
             _ => throw new Exception($"Cannot verify that the current OS is \"{os}\".")
         };
     }
-
-    public static byte[] Unescape(string original)
-    {
-        if (original.Length == 0)
-        {
-            return new byte[0];
-        }
-
-        uint index = 0;
-        var bytes = new List<byte>();
-
-        while (index < original.Length)
-        {
-            var ch = original[(int)index];
-
-            if (ch == '\\')
-            {
-                index++;
-                var hex1 = original[(int)index];
-
-                if (hex1 == '\\')
-                {
-                    bytes.Add((byte)hex1);
-                    index++;
-                }
-                else
-                {
-                    index++;
-                    var hex2 = original[(int)index];
-
-                    var byte1 = hex1 switch
-                    {
-                        >= '0' and <= '9' => (byte)hex1 - (byte)'0',
-                        >= 'a' and <= 'f' => (byte)hex1 - (byte)'a' + 10,
-                        >= 'A' and <= 'F' => (byte)hex1 - (byte)'A' + 10,
-                        _ => throw new ArgumentOutOfRangeException(nameof(hex1)),
-                    };
-
-                    var byte2 = hex2 switch
-                    {
-                        >= '0' and <= '9' => (byte)hex2 - (byte)'0',
-                        >= 'a' and <= 'f' => (byte)hex2 - (byte)'a' + 10,
-                        >= 'A' and <= 'F' => (byte)hex2 - (byte)'A' + 10,
-                        _ => throw new ArgumentOutOfRangeException(nameof(hex2)),
-                    };
-
-                    bytes.Add((byte)((byte1 << 4) | byte2));
-                    index++;
-                }
-            }
-            else
-            {
-                bytes.Add((byte)ch);
-                index++;
-            }
-        }
-
-        return bytes.ToArray();
-    }
 }
 
 public static class ListExtensions
@@ -358,20 +339,6 @@ public static class ArrayExtensions
         return result.ToArray();
     }
 
-    public static LLVMValueRef[] AsLLVMValues(this byte[] bytes)
-    {
-        var result = new LLVMValueRef[bytes.Length];
-        uint index = 0;
-
-        foreach (var @byte in bytes)
-        {
-            result[index] = LLVMValueRef.CreateConstInt(LLVMTypeRef.Int8, @byte);
-            index++;
-        }
-
-        return result;
-    }
-
     public static Value[] ImplicitConvertAll(
         this Value[] values,
         LLVMCompiler compiler,
@@ -432,14 +399,14 @@ public static class ArrayExtensions
 
     public static int GetHashes(this Type[] types)
     {
-        int hash = 3;
+        var hash = new HashCode();
 
         foreach (Type type in types)
         {
-            hash *= 31 + type.GetHashCode();
+            hash.Add(type);
         }
 
-        return hash;
+        return hash.ToHashCode();
     }
 
     public static ulong[] ToULong(this byte[] bytes)
@@ -488,6 +455,8 @@ public static class ArrayExtensions
 
         foreach (var import in imports)
         {
+            import.Materialize(name);
+
             if (
                 import.Functions.TryGetValue(name, out OverloadList overloads)
                 && overloads.TryGet(paramTypes, out func)
@@ -520,6 +489,8 @@ public static class ArrayExtensions
 
         foreach (var import in imports)
         {
+            import.Materialize(name);
+
             if (import.Types.TryGetValue(name, out typeDecl))
             {
                 if (typeDecl.Privacy == PrivacyType.Priv)